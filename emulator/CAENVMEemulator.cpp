@@ -0,0 +1,539 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Software implementation of the CAEN VME library, on top of SimulatedCrate.
+// It allows to run (and profile) the VmeUsbBridge code path without hardware.
+
+#include "CAENVMElib.h"
+#include "CAENVMEemulator.h"
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace {
+
+  struct PulserConf {
+    unsigned char period = 0;
+    unsigned char width = 0;
+    CVTimeUnits unit = cvUnit25ns;
+    unsigned char pulseNo = 0;
+    CVIOSources start = cvManualSW;
+    CVIOSources reset = cvManualSW;
+  };
+
+  struct ScalerConf {
+    short limit = 1023;
+    short autoReset = 0;
+    CVIOSources hit = cvInputSrc0;
+    CVIOSources gate = cvManualSW;
+    CVIOSources reset = cvManualSW;
+  };
+
+  struct IOConf {
+    CVIOPolarity polarity = cvDirect;
+    CVLEDPolarity led = cvActiveHigh;
+    CVIOSources source = cvManualSW;
+  };
+
+  // state of one opened bridge
+  struct Bridge {
+    CVBoardTypes type;
+    SimulatedCrate* crate;
+    std::mutex mutex; // protects the configuration below
+    PulserConf pulsers[2];
+    ScalerConf scaler;
+    uint32_t scalerCount = 0;
+    bool scalerGate = false;
+    IOConf outputs[5];
+    IOConf inputs[2];
+    uint16_t outputRegister = 0;
+    CVArbiterTypes arbiter = cvPriorized;
+    CVRequesterTypes requester = cvFair;
+    CVReleaseTypes release = cvRWD;
+    CVBusReqLevels busReqLevel = cvBR3;
+    CVVMETimeouts timeout = cvTimeout50us;
+    short fifoMode = 0;
+    CVDisplay display{};
+  };
+
+  typedef std::tuple<int,short,short> Location;
+
+  std::mutex registryMutex;
+  std::map<Location,std::unique_ptr<SimulatedCrate> > crates;
+  std::map<int32_t,std::unique_ptr<Bridge> > bridges;
+  std::map<int32_t,Location> locations;
+  int32_t nextHandle = 0;
+
+  SimulatedLatency latencyFor(CVBoardTypes type) {
+    const char* env = std::getenv("CAENVME_EMULATOR_LATENCY");
+    if(env) {
+      std::string model(env);
+      if(model=="none") return SimulatedLatency::none();
+      if(model=="V1718") return SimulatedLatency::V1718();
+      if(model=="V2718") return SimulatedLatency::V2718();
+    }
+    return type==cvV1718 ? SimulatedLatency::V1718() : SimulatedLatency::V2718();
+  }
+
+  // to be called with the registry locked
+  SimulatedCrate* crateAt(const Location& location) {
+    auto& crate = crates[location];
+    if(!crate) {
+      crate.reset(new SimulatedCrate(latencyFor(CVBoardTypes(std::get<0>(location)))));
+      crate->populate();
+    }
+    return crate.get();
+  }
+
+  Bridge* bridge(int32_t handle) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = bridges.find(handle);
+    return it==bridges.end() ? nullptr : it->second.get();
+  }
+
+  // keep track of the last cycle, as shown on the front panel display
+  CVErrorCodes display(Bridge* b, uint32_t address, uint32_t data, CVAddressModifier AM, bool write, CVErrorCodes status) {
+    std::lock_guard<std::mutex> lock(b->mutex);
+    b->display.cvAddress = address;
+    b->display.cvData = data;
+    b->display.cvAM = AM;
+    b->display.cvWRITE = write;
+    b->display.cvDTACK = (status==cvSuccess);
+    b->display.cvBERR = (status==cvBusError);
+    return status;
+  }
+
+  uint32_t value(const void* data, CVDataWidth DW) {
+    uint32_t v = 0;
+    memcpy(&v,data,std::min(DW&0x0F,4));
+    return v;
+  }
+
+}
+
+#define GET_BRIDGE(handle) Bridge* b = bridge(handle); if(!b) return cvInvalidParam;
+
+SimulatedCrate* CAENVMEemu_Crate(CVBoardTypes BdType, short Link, short BdNum) {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  return crateAt(std::make_tuple(int(BdType),Link,BdNum));
+}
+
+extern "C" {
+
+const char* CAENVME_DecodeError(CVErrorCodes Code) {
+  switch(Code) {
+    case cvSuccess: return "Operation completed successfully";
+    case cvBusError: return "VME bus error during the cycle";
+    case cvCommError: return "Communication error";
+    case cvGenericError: return "Unspecified error";
+    case cvInvalidParam: return "Invalid parameter";
+    case cvTimeoutError: return "Timeout error";
+    case cvAlreadyOpenError: return "Device already open";
+    case cvMaxBoardCountError: return "Maximum number of boards reached";
+    case cvNotSupported: return "Not supported";
+  }
+  return "Unknown error";
+}
+
+CVErrorCodes CAENVME_SWRelease(char *SwRel) {
+  strcpy(SwRel,"emulator");
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_BoardFWRelease(int32_t Handle, char *FWRel) {
+  GET_BRIDGE(Handle);
+  strcpy(FWRel,"emulator");
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_DriverRelease(int32_t Handle, char *Rel) {
+  GET_BRIDGE(Handle);
+  strcpy(Rel,"emulator");
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_Init(CVBoardTypes BdType, short Link, short BdNum, int32_t *Handle) {
+  if(BdType<cvV1718 || BdType>cvA3818) return cvInvalidParam;
+  std::lock_guard<std::mutex> lock(registryMutex);
+  Location location = std::make_tuple(int(BdType),Link,BdNum);
+  for(auto& [handle, l] : locations) {
+    if(l==location) return cvAlreadyOpenError;
+  }
+  std::unique_ptr<Bridge> b(new Bridge);
+  b->type = BdType;
+  b->crate = crateAt(location);
+  *Handle = nextHandle++;
+  bridges[*Handle] = std::move(b);
+  locations[*Handle] = location;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_End(int32_t Handle) {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  if(!bridges.erase(Handle)) return cvInvalidParam;
+  locations.erase(Handle);
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_DeviceReset(int32_t Handle) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  for(auto& p : b->pulsers) p = PulserConf();
+  b->scaler = ScalerConf();
+  b->scalerCount = 0;
+  b->outputRegister = 0;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_ReadCycle(int32_t Handle, uint32_t Address, void *Data, CVAddressModifier AM, CVDataWidth DW) {
+  GET_BRIDGE(Handle);
+  CVErrorCodes status = b->crate->read(Address,Data,AM,DW);
+  return display(b,Address,status ? 0 : value(Data,DW),AM,false,status);
+}
+
+CVErrorCodes CAENVME_RMWCycle(int32_t Handle, uint32_t Address, void *Data, CVAddressModifier AM, CVDataWidth DW) {
+  GET_BRIDGE(Handle);
+  uint32_t written = value(Data,DW);
+  return display(b,Address,written,AM,true,b->crate->readWrite(Address,Data,AM,DW));
+}
+
+CVErrorCodes CAENVME_WriteCycle(int32_t Handle, uint32_t Address, void *Data, CVAddressModifier AM, CVDataWidth DW) {
+  GET_BRIDGE(Handle);
+  return display(b,Address,value(Data,DW),AM,true,b->crate->write(Address,Data,AM,DW));
+}
+
+CVErrorCodes CAENVME_MultiRead(int32_t Handle, uint32_t *Addrs, uint32_t *Buffer, int NCycles, CVAddressModifier *AMs, CVDataWidth *DWs, CVErrorCodes *ECs) {
+  GET_BRIDGE(Handle);
+  if(NCycles<=0) return cvInvalidParam;
+  CVErrorCodes status = b->crate->multiRead(Addrs,Buffer,NCycles,AMs,DWs,ECs);
+  return display(b,Addrs[NCycles-1],Buffer[NCycles-1],AMs[NCycles-1],false,status);
+}
+
+CVErrorCodes CAENVME_MultiWrite(int32_t Handle, uint32_t *Addrs, uint32_t *Buffer, int NCycles, CVAddressModifier *AMs, CVDataWidth *DWs, CVErrorCodes *ECs) {
+  GET_BRIDGE(Handle);
+  if(NCycles<=0) return cvInvalidParam;
+  CVErrorCodes status = b->crate->multiWrite(Addrs,Buffer,NCycles,AMs,DWs,ECs);
+  return display(b,Addrs[NCycles-1],Buffer[NCycles-1],AMs[NCycles-1],true,status);
+}
+
+CVErrorCodes CAENVME_ADOCycle(int32_t Handle, uint32_t Address, CVAddressModifier AM) {
+  GET_BRIDGE(Handle);
+  return display(b,Address,0,AM,false,b->crate->addressOnly(Address,AM));
+}
+
+CVErrorCodes CAENVME_ADOHCycle(int32_t Handle, uint32_t Address, CVAddressModifier AM) {
+  GET_BRIDGE(Handle);
+  return display(b,Address,0,AM,false,b->crate->addressOnly(Address,AM));
+}
+
+// The FIFO variants do not increment the address. All the simulated FIFOs (V1190
+// output buffer) are read the same way whatever the address, so they are identical.
+
+CVErrorCodes CAENVME_BLTReadCycle(int32_t Handle, uint32_t Address, void *Buffer, int Size, CVAddressModifier AM, CVDataWidth DW, int *count) {
+  GET_BRIDGE(Handle);
+  return display(b,Address,0,AM,false,b->crate->blockRead(Address,(unsigned char*)Buffer,Size,AM,DW,count));
+}
+
+CVErrorCodes CAENVME_FIFOBLTReadCycle(int32_t Handle, uint32_t Address, void *Buffer, int Size, CVAddressModifier AM, CVDataWidth DW, int *count) {
+  return CAENVME_BLTReadCycle(Handle,Address,Buffer,Size,AM,DW,count);
+}
+
+CVErrorCodes CAENVME_MBLTReadCycle(int32_t Handle, uint32_t Address, void *Buffer, int Size, CVAddressModifier AM, int *count) {
+  GET_BRIDGE(Handle);
+  return display(b,Address,0,AM,false,b->crate->blockRead(Address,(unsigned char*)Buffer,Size,AM,cvD64,count));
+}
+
+CVErrorCodes CAENVME_FIFOMBLTReadCycle(int32_t Handle, uint32_t Address, void *Buffer, int Size, CVAddressModifier AM, int *count) {
+  return CAENVME_MBLTReadCycle(Handle,Address,Buffer,Size,AM,count);
+}
+
+CVErrorCodes CAENVME_BLTWriteCycle(int32_t Handle, uint32_t Address, void *Buffer, int size, CVAddressModifier AM, CVDataWidth DW, int *count) {
+  GET_BRIDGE(Handle);
+  return display(b,Address,0,AM,true,b->crate->blockWrite(Address,(const unsigned char*)Buffer,size,AM,DW,count));
+}
+
+CVErrorCodes CAENVME_FIFOBLTWriteCycle(int32_t Handle, uint32_t Address, void *Buffer, int size, CVAddressModifier AM, CVDataWidth DW, int *count) {
+  return CAENVME_BLTWriteCycle(Handle,Address,Buffer,size,AM,DW,count);
+}
+
+CVErrorCodes CAENVME_MBLTWriteCycle(int32_t Handle, uint32_t Address, void *Buffer, int size, CVAddressModifier AM, int *count) {
+  GET_BRIDGE(Handle);
+  return display(b,Address,0,AM,true,b->crate->blockWrite(Address,(const unsigned char*)Buffer,size,AM,cvD64,count));
+}
+
+CVErrorCodes CAENVME_FIFOMBLTWriteCycle(int32_t Handle, uint32_t Address, void *Buffer, int size, CVAddressModifier AM, int *count) {
+  return CAENVME_MBLTWriteCycle(Handle,Address,Buffer,size,AM,count);
+}
+
+CVErrorCodes CAENVME_IACKCycle(int32_t Handle, CVIRQLevels Level, void *Vector, CVDataWidth DW) {
+  GET_BRIDGE(Handle);
+  return b->crate->IACK(Level,Vector,DW);
+}
+
+CVErrorCodes CAENVME_IRQCheck(int32_t Handle, CAEN_BYTE *Mask) {
+  GET_BRIDGE(Handle);
+  return b->crate->IRQCheck(Mask);
+}
+
+CVErrorCodes CAENVME_IRQEnable(int32_t Handle, uint32_t Mask) {
+  GET_BRIDGE(Handle);
+  return b->crate->IRQEnable(Mask);
+}
+
+CVErrorCodes CAENVME_IRQDisable(int32_t Handle, uint32_t Mask) {
+  GET_BRIDGE(Handle);
+  return b->crate->IRQDisable(Mask);
+}
+
+CVErrorCodes CAENVME_IRQWait(int32_t Handle, uint32_t Mask, uint32_t Timeout) {
+  GET_BRIDGE(Handle);
+  return b->crate->IRQWait(Mask,Timeout);
+}
+
+CVErrorCodes CAENVME_SetPulserConf(int32_t Handle, CVPulserSelect PulSel, unsigned char Period, unsigned char Width, CVTimeUnits Unit, unsigned char PulseNo, CVIOSources Start, CVIOSources Reset) {
+  GET_BRIDGE(Handle);
+  if(PulSel!=cvPulserA && PulSel!=cvPulserB) return cvInvalidParam;
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->pulsers[PulSel] = {Period, Width, Unit, PulseNo, Start, Reset};
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetPulserConf(int32_t Handle, CVPulserSelect PulSel, unsigned char *Period, unsigned char *Width, CVTimeUnits *Unit, unsigned char *PulseNo, CVIOSources *Start, CVIOSources *Reset) {
+  GET_BRIDGE(Handle);
+  if(PulSel!=cvPulserA && PulSel!=cvPulserB) return cvInvalidParam;
+  std::lock_guard<std::mutex> lock(b->mutex);
+  const PulserConf& p = b->pulsers[PulSel];
+  *Period = p.period; *Width = p.width; *Unit = p.unit; *PulseNo = p.pulseNo; *Start = p.start; *Reset = p.reset;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_StartPulser(int32_t Handle, CVPulserSelect PulSel) {
+  GET_BRIDGE(Handle);
+  return (PulSel==cvPulserA || PulSel==cvPulserB) ? cvSuccess : cvInvalidParam;
+}
+
+CVErrorCodes CAENVME_StopPulser(int32_t Handle, CVPulserSelect PulSel) {
+  GET_BRIDGE(Handle);
+  return (PulSel==cvPulserA || PulSel==cvPulserB) ? cvSuccess : cvInvalidParam;
+}
+
+CVErrorCodes CAENVME_SetScalerConf(int32_t Handle, short Limit, short AutoReset, CVIOSources Hit, CVIOSources Gate, CVIOSources Reset) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->scaler = {Limit, AutoReset, Hit, Gate, Reset};
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetScalerConf(int32_t Handle, short *Limit, short *AutoReset, CVIOSources *Hit, CVIOSources *Gate, CVIOSources *Reset) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *Limit = b->scaler.limit; *AutoReset = b->scaler.autoReset; *Hit = b->scaler.hit; *Gate = b->scaler.gate; *Reset = b->scaler.reset;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_ResetScalerCount(int32_t Handle) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->scalerCount = 0;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_EnableScalerGate(int32_t Handle) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->scalerGate = true;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_DisableScalerGate(int32_t Handle) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->scalerGate = false;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetOutputConf(int32_t Handle, CVOutputSelect OutSel, CVIOPolarity OutPol, CVLEDPolarity LEDPol, CVIOSources Source) {
+  GET_BRIDGE(Handle);
+  if(OutSel<cvOutput0 || OutSel>cvOutput4) return cvInvalidParam;
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->outputs[OutSel] = {OutPol, LEDPol, Source};
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetOutputConf(int32_t Handle, CVOutputSelect OutSel, CVIOPolarity *OutPol, CVLEDPolarity *LEDPol, CVIOSources *Source) {
+  GET_BRIDGE(Handle);
+  if(OutSel<cvOutput0 || OutSel>cvOutput4) return cvInvalidParam;
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *OutPol = b->outputs[OutSel].polarity; *LEDPol = b->outputs[OutSel].led; *Source = b->outputs[OutSel].source;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetInputConf(int32_t Handle, CVInputSelect InSel, CVIOPolarity InPol, CVLEDPolarity LEDPol) {
+  GET_BRIDGE(Handle);
+  if(InSel!=cvInput0 && InSel!=cvInput1) return cvInvalidParam;
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->inputs[InSel] = {InPol, LEDPol, cvManualSW};
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetInputConf(int32_t Handle, CVInputSelect InSel, CVIOPolarity *InPol, CVLEDPolarity *LEDPol) {
+  GET_BRIDGE(Handle);
+  if(InSel!=cvInput0 && InSel!=cvInput1) return cvInvalidParam;
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *InPol = b->inputs[InSel].polarity; *LEDPol = b->inputs[InSel].led;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_ReadRegister(int32_t Handle, CVRegisters Reg, unsigned int *Data) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  switch(Reg) {
+    case cvStatusReg: *Data = cvSYSCTRL | cvUSBTYPE | (b->display.cvBERR ? cvBERR : cvDTACK); break;
+    case cvOutRegSet: *Data = b->outputRegister; break;
+    case cvScaler1: *Data = b->scalerCount; break;
+    default: *Data = 0; break;
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_WriteRegister(int32_t Handle, CVRegisters Reg, unsigned int Data) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  switch(Reg) {
+    case cvOutRegSet: b->outputRegister |= Data; break;
+    case cvOutRegClear: b->outputRegister &= ~Data; break;
+    default: break;
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetOutputRegister(int32_t Handle, unsigned short Mask) {
+  return CAENVME_WriteRegister(Handle,cvOutRegSet,Mask);
+}
+
+CVErrorCodes CAENVME_ClearOutputRegister(int32_t Handle, unsigned short Mask) {
+  return CAENVME_WriteRegister(Handle,cvOutRegClear,Mask);
+}
+
+CVErrorCodes CAENVME_PulseOutputRegister(int32_t Handle, unsigned short Mask) {
+  // the pulse is instantaneous: the register is left unchanged
+  GET_BRIDGE(Handle);
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_ReadDisplay(int32_t Handle, CVDisplay *Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *Value = b->display;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetArbiterType(int32_t Handle, CVArbiterTypes Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->arbiter = Value;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetRequesterType(int32_t Handle, CVRequesterTypes Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->requester = Value;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetReleaseType(int32_t Handle, CVReleaseTypes Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->release = Value;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetBusReqLevel(int32_t Handle, CVBusReqLevels Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->busReqLevel = Value;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetTimeout(int32_t Handle, CVVMETimeouts Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->timeout = Value;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SetFIFOMode(int32_t Handle, short Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  b->fifoMode = Value;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetArbiterType(int32_t Handle, CVArbiterTypes *Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *Value = b->arbiter;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetRequesterType(int32_t Handle, CVRequesterTypes *Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *Value = b->requester;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetReleaseType(int32_t Handle, CVReleaseTypes *Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *Value = b->release;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetBusReqLevel(int32_t Handle, CVBusReqLevels *Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *Value = b->busReqLevel;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetTimeout(int32_t Handle, CVVMETimeouts *Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *Value = b->timeout;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_GetFIFOMode(int32_t Handle, short *Value) {
+  GET_BRIDGE(Handle);
+  std::lock_guard<std::mutex> lock(b->mutex);
+  *Value = b->fifoMode;
+  return cvSuccess;
+}
+
+CVErrorCodes CAENVME_SystemReset(int32_t Handle) {
+  GET_BRIDGE(Handle);
+  b->crate->systemReset();
+  return cvSuccess;
+}
+
+}
@@ -0,0 +1,35 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __CAENVMEEMULATOR_H
+#define __CAENVMEEMULATOR_H
+
+// Extra entry points of the CAEN library emulator, to act on the simulated hardware.
+//
+// Each bridge location (board type, link, board number) drives its own SimulatedCrate,
+// populated with the default boards. The latency model depends on the bridge type
+// (V1718 for USB, V2718 for the optical bridges) and can be overridden with the
+// CAENVME_EMULATOR_LATENCY environment variable (none, V1718 or V2718).
+
+#include "CAENVMEtypes.h"
+#include "SimulatedCrate.h"
+
+// the crate behind a bridge. It is created on first use and lives until the program ends.
+SimulatedCrate* CAENVMEemu_Crate(CVBoardTypes BdType, short Link=0, short BdNum=0);
+
+#endif // __CAENVMEEMULATOR_H
@@ -0,0 +1,112 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Stand-in for the CAENVMElib.h header of the CAEN VME library.
+// The entry points have the CAEN signatures and are implemented by CAENVMEemulator.cpp.
+
+#ifndef __CAENVMELIB_H
+#define __CAENVMELIB_H
+
+#include <stdint.h>
+#include "CAENVMEtypes.h"
+#include "CAENVMEoslib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Library and board information
+const char* CAENVME_DecodeError(CVErrorCodes Code);
+CAENVME_API CAENVME_SWRelease(char *SwRel);
+CAENVME_API CAENVME_BoardFWRelease(int32_t Handle, char *FWRel);
+CAENVME_API CAENVME_DriverRelease(int32_t Handle, char *Rel);
+
+// Connection
+CAENVME_API CAENVME_Init(CVBoardTypes BdType, short Link, short BdNum, int32_t *Handle);
+CAENVME_API CAENVME_End(int32_t Handle);
+CAENVME_API CAENVME_DeviceReset(int32_t Handle);
+
+// Single cycles
+CAENVME_API CAENVME_ReadCycle(int32_t Handle, uint32_t Address, void *Data, CVAddressModifier AM, CVDataWidth DW);
+CAENVME_API CAENVME_RMWCycle(int32_t Handle, uint32_t Address, void *Data, CVAddressModifier AM, CVDataWidth DW);
+CAENVME_API CAENVME_WriteCycle(int32_t Handle, uint32_t Address, void *Data, CVAddressModifier AM, CVDataWidth DW);
+CAENVME_API CAENVME_MultiRead(int32_t Handle, uint32_t *Addrs, uint32_t *Buffer, int NCycles, CVAddressModifier *AMs, CVDataWidth *DWs, CVErrorCodes *ECs);
+CAENVME_API CAENVME_MultiWrite(int32_t Handle, uint32_t *Addrs, uint32_t *Buffer, int NCycles, CVAddressModifier *AMs, CVDataWidth *DWs, CVErrorCodes *ECs);
+CAENVME_API CAENVME_ADOCycle(int32_t Handle, uint32_t Address, CVAddressModifier AM);
+CAENVME_API CAENVME_ADOHCycle(int32_t Handle, uint32_t Address, CVAddressModifier AM);
+
+// Block transfers
+CAENVME_API CAENVME_BLTReadCycle(int32_t Handle, uint32_t Address, void *Buffer, int Size, CVAddressModifier AM, CVDataWidth DW, int *count);
+CAENVME_API CAENVME_FIFOBLTReadCycle(int32_t Handle, uint32_t Address, void *Buffer, int Size, CVAddressModifier AM, CVDataWidth DW, int *count);
+CAENVME_API CAENVME_MBLTReadCycle(int32_t Handle, uint32_t Address, void *Buffer, int Size, CVAddressModifier AM, int *count);
+CAENVME_API CAENVME_FIFOMBLTReadCycle(int32_t Handle, uint32_t Address, void *Buffer, int Size, CVAddressModifier AM, int *count);
+CAENVME_API CAENVME_BLTWriteCycle(int32_t Handle, uint32_t Address, void *Buffer, int size, CVAddressModifier AM, CVDataWidth DW, int *count);
+CAENVME_API CAENVME_FIFOBLTWriteCycle(int32_t Handle, uint32_t Address, void *Buffer, int size, CVAddressModifier AM, CVDataWidth DW, int *count);
+CAENVME_API CAENVME_MBLTWriteCycle(int32_t Handle, uint32_t Address, void *Buffer, int size, CVAddressModifier AM, int *count);
+CAENVME_API CAENVME_FIFOMBLTWriteCycle(int32_t Handle, uint32_t Address, void *Buffer, int size, CVAddressModifier AM, int *count);
+
+// Interrupts
+CAENVME_API CAENVME_IACKCycle(int32_t Handle, CVIRQLevels Level, void *Vector, CVDataWidth DW);
+CAENVME_API CAENVME_IRQCheck(int32_t Handle, CAEN_BYTE *Mask);
+CAENVME_API CAENVME_IRQEnable(int32_t Handle, uint32_t Mask);
+CAENVME_API CAENVME_IRQDisable(int32_t Handle, uint32_t Mask);
+CAENVME_API CAENVME_IRQWait(int32_t Handle, uint32_t Mask, uint32_t Timeout);
+
+// Pulsers and scaler of the bridge
+CAENVME_API CAENVME_SetPulserConf(int32_t Handle, CVPulserSelect PulSel, unsigned char Period, unsigned char Width, CVTimeUnits Unit, unsigned char PulseNo, CVIOSources Start, CVIOSources Reset);
+CAENVME_API CAENVME_GetPulserConf(int32_t Handle, CVPulserSelect PulSel, unsigned char *Period, unsigned char *Width, CVTimeUnits *Unit, unsigned char *PulseNo, CVIOSources *Start, CVIOSources *Reset);
+CAENVME_API CAENVME_StartPulser(int32_t Handle, CVPulserSelect PulSel);
+CAENVME_API CAENVME_StopPulser(int32_t Handle, CVPulserSelect PulSel);
+CAENVME_API CAENVME_SetScalerConf(int32_t Handle, short Limit, short AutoReset, CVIOSources Hit, CVIOSources Gate, CVIOSources Reset);
+CAENVME_API CAENVME_GetScalerConf(int32_t Handle, short *Limit, short *AutoReset, CVIOSources *Hit, CVIOSources *Gate, CVIOSources *Reset);
+CAENVME_API CAENVME_ResetScalerCount(int32_t Handle);
+CAENVME_API CAENVME_EnableScalerGate(int32_t Handle);
+CAENVME_API CAENVME_DisableScalerGate(int32_t Handle);
+
+// Input and output lines and registers of the bridge
+CAENVME_API CAENVME_SetOutputConf(int32_t Handle, CVOutputSelect OutSel, CVIOPolarity OutPol, CVLEDPolarity LEDPol, CVIOSources Source);
+CAENVME_API CAENVME_GetOutputConf(int32_t Handle, CVOutputSelect OutSel, CVIOPolarity *OutPol, CVLEDPolarity *LEDPol, CVIOSources *Source);
+CAENVME_API CAENVME_SetInputConf(int32_t Handle, CVInputSelect InSel, CVIOPolarity InPol, CVLEDPolarity LEDPol);
+CAENVME_API CAENVME_GetInputConf(int32_t Handle, CVInputSelect InSel, CVIOPolarity *InPol, CVLEDPolarity *LEDPol);
+CAENVME_API CAENVME_ReadRegister(int32_t Handle, CVRegisters Reg, unsigned int *Data);
+CAENVME_API CAENVME_WriteRegister(int32_t Handle, CVRegisters Reg, unsigned int Data);
+CAENVME_API CAENVME_SetOutputRegister(int32_t Handle, unsigned short Mask);
+CAENVME_API CAENVME_ClearOutputRegister(int32_t Handle, unsigned short Mask);
+CAENVME_API CAENVME_PulseOutputRegister(int32_t Handle, unsigned short Mask);
+CAENVME_API CAENVME_ReadDisplay(int32_t Handle, CVDisplay *Value);
+
+// Bus behaviour
+CAENVME_API CAENVME_SetArbiterType(int32_t Handle, CVArbiterTypes Value);
+CAENVME_API CAENVME_SetRequesterType(int32_t Handle, CVRequesterTypes Value);
+CAENVME_API CAENVME_SetReleaseType(int32_t Handle, CVReleaseTypes Value);
+CAENVME_API CAENVME_SetBusReqLevel(int32_t Handle, CVBusReqLevels Value);
+CAENVME_API CAENVME_SetTimeout(int32_t Handle, CVVMETimeouts Value);
+CAENVME_API CAENVME_SetFIFOMode(int32_t Handle, short Value);
+CAENVME_API CAENVME_GetArbiterType(int32_t Handle, CVArbiterTypes *Value);
+CAENVME_API CAENVME_GetRequesterType(int32_t Handle, CVRequesterTypes *Value);
+CAENVME_API CAENVME_GetReleaseType(int32_t Handle, CVReleaseTypes *Value);
+CAENVME_API CAENVME_GetBusReqLevel(int32_t Handle, CVBusReqLevels *Value);
+CAENVME_API CAENVME_GetTimeout(int32_t Handle, CVVMETimeouts *Value);
+CAENVME_API CAENVME_GetFIFOMode(int32_t Handle, short *Value);
+CAENVME_API CAENVME_SystemReset(int32_t Handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CAENVMELIB_H
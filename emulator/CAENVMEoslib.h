@@ -0,0 +1,32 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Stand-in for the CAENVMEoslib.h header of the CAEN VME library (Linux flavour).
+
+#ifndef __CAENVMEOSLIB_H
+#define __CAENVMEOSLIB_H
+
+#include <stdint.h>
+
+#define CAENVME_API CVErrorCodes
+
+typedef unsigned char CAEN_BYTE;
+typedef uint32_t CAEN_DWORD;
+typedef int CAEN_BOOL;
+
+#endif
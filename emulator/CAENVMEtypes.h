@@ -0,0 +1,286 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Stand-in for the CAENVMEtypes.h header of the CAEN VME library.
+// The enumerations and their values follow the ones of the CAEN distribution.
+
+#ifndef __CAENVMETYPES_H
+#define __CAENVMETYPES_H
+
+// Bridge types
+typedef enum CVBoardTypes {
+  cvV1718 = 0,   /* CAEN V1718 USB-VME bridge */
+  cvV2718 = 1,   /* V2718 VME-PCI bridge (optical link) */
+  cvA2818 = 2,   /* PCI board with optical link */
+  cvA2719 = 3,   /* Optical link piggy-back */
+  cvA3818 = 4,   /* PCIe board with optical link */
+} CVBoardTypes;
+
+// Data width
+typedef enum CVDataWidth {
+  cvD8  = 0x01,  /*  8 bit */
+  cvD16 = 0x02,  /* 16 bit */
+  cvD32 = 0x04,  /* 32 bit */
+  cvD64 = 0x08,  /* 64 bit */
+  cvD16_swapped = 0x12, /* 16 bit swapped */
+  cvD32_swapped = 0x14, /* 32 bit swapped */
+  cvD64_swapped = 0x18  /* 64 bit swapped */
+} CVDataWidth;
+
+// Address modifiers
+typedef enum CVAddressModifier {
+  cvA16_S      = 0x2D, /* A16 supervisory access */
+  cvA16_U      = 0x29, /* A16 non-privileged */
+  cvA16_LCK    = 0x2C, /* A16 lock command */
+
+  cvA24_S_BLT  = 0x3F, /* A24 supervisory block transfer */
+  cvA24_S_PGM  = 0x3E, /* A24 supervisory program access */
+  cvA24_S_DATA = 0x3D, /* A24 supervisory data access */
+  cvA24_S_MBLT = 0x3C, /* A24 supervisory 64-bit block trnsfer */
+  cvA24_U_BLT  = 0x3B, /* A24 non-privileged block transfer */
+  cvA24_U_PGM  = 0x3A, /* A24 non-privileged program access */
+  cvA24_U_DATA = 0x39, /* A24 non-privileged data access */
+  cvA24_U_MBLT = 0x38, /* A24 non-privileged 64-bit block trnsfer */
+  cvA24_LCK    = 0x32, /* A24 lock command */
+
+  cvA32_S_BLT  = 0x0F, /* A32 supervisory block transfer */
+  cvA32_S_PGM  = 0x0E, /* A32 supervisory program access */
+  cvA32_S_DATA = 0x0D, /* A32 supervisory data access */
+  cvA32_S_MBLT = 0x0C, /* A32 supervisory 64-bit block trnsfer */
+  cvA32_U_BLT  = 0x0B, /* A32 non-privileged block transfer */
+  cvA32_U_PGM  = 0x0A, /* A32 non-privileged program access */
+  cvA32_U_DATA = 0x09, /* A32 non-privileged data access */
+  cvA32_U_MBLT = 0x08, /* A32 non-privileged 64-bit block trnsfer */
+  cvA32_LCK    = 0x05, /* A32 lock command */
+
+  cvCR_CSR     = 0x2F, /* CR/CSR space */
+
+  cvA40_BLT    = 0x37, /* A40 block transfer (MD32) */
+  cvA40_LCK    = 0x35, /* A40 lock command */
+  cvA40        = 0x34, /* A40 access */
+
+  cvA64        = 0x01, /* A64 single trnsfer access */
+  cvA64_BLT    = 0x03, /* A64 block transfer */
+  cvA64_MBLT   = 0x00, /* A64 64-bit block transfer */
+  cvA64_LCK    = 0x04, /* A64 lock command */
+
+  cvA3U_2eVME  = 0x21, /* 2eVME for 3U bus modules */
+  cvA6U_2eVME  = 0x20  /* 2eVME for 6U bus modules */
+} CVAddressModifier;
+
+// Error codes
+typedef enum CVErrorCodes {
+  cvSuccess            =  0, /* Operation completed successfully */
+  cvBusError           = -1, /* VME bus error during the cycle */
+  cvCommError          = -2, /* Communication error */
+  cvGenericError       = -3, /* Unspecified error */
+  cvInvalidParam       = -4, /* Invalid parameter */
+  cvTimeoutError       = -5, /* Timeout error */
+  cvAlreadyOpenError   = -6, /* Device already open */
+  cvMaxBoardCountError = -7, /* Maximum number of boards reached */
+  cvNotSupported       = -8, /* Not supported */
+} CVErrorCodes;
+
+// Pulser selection
+typedef enum CVPulserSelect {
+  cvPulserA = 0,
+  cvPulserB = 1
+} CVPulserSelect;
+
+// Output selection
+typedef enum CVOutputSelect {
+  cvOutput0 = 0,
+  cvOutput1 = 1,
+  cvOutput2 = 2,
+  cvOutput3 = 3,
+  cvOutput4 = 4
+} CVOutputSelect;
+
+// Input selection
+typedef enum CVInputSelect {
+  cvInput0 = 0,
+  cvInput1 = 1
+} CVInputSelect;
+
+// Signal sources
+typedef enum CVIOSources {
+  cvManualSW    = 0, /* Manual (button) or software controlled */
+  cvInputSrc0   = 1, /* Input line 0 */
+  cvInputSrc1   = 2, /* Input line 1 */
+  cvCoincidence = 3, /* Inputs coincidence */
+  cvVMESignals  = 4, /* Signals from VME bus */
+  cvMiscSignals = 6  /* Various internal signals */
+} CVIOSources;
+
+// Time base units for the pulsers
+typedef enum CVTimeUnits {
+  cvUnit25ns   = 0,
+  cvUnit1600ns = 1,
+  cvUnit410us  = 2,
+  cvUnit104ms  = 3
+} CVTimeUnits;
+
+// Polarity for LED emitting
+typedef enum CVLEDPolarity {
+  cvActiveHigh = 0,
+  cvActiveLow  = 1
+} CVLEDPolarity;
+
+// Input and Output signal polarity
+typedef enum CVIOPolarity {
+  cvDirect   = 0,
+  cvInverted = 1
+} CVIOPolarity;
+
+// Accessible registers of the bridge
+typedef enum CVRegisters {
+  cvStatusReg      = 0x00,
+  cvVMEControlReg  = 0x01,
+  cvFwRelReg       = 0x02,
+  cvFwDldReg       = 0x03,
+  cvFlenaReg       = 0x04,
+  cvVMEIRQEnaReg   = 0x06,
+  cvInputReg       = 0x08,
+  cvOutRegSet      = 0x0A,
+  cvInMuxRegSet    = 0x0B,
+  cvOutMuxRegSet   = 0x0C,
+  cvLedPolRegSet   = 0x0D,
+  cvOutRegClear    = 0x10,
+  cvInMuxRegClear  = 0x11,
+  cvOutMuxRegClear = 0x12,
+  cvLedPolRegClear = 0x13,
+  cvPulserA0       = 0x16,
+  cvPulserA1       = 0x17,
+  cvPulserB0       = 0x19,
+  cvPulserB1       = 0x1A,
+  cvScaler0        = 0x1C,
+  cvScaler1        = 0x1D,
+  cvDispADL        = 0x20,
+  cvDispADH        = 0x21,
+  cvDispDTL        = 0x22,
+  cvDispDTH        = 0x23,
+  cvDispC1         = 0x24,
+  cvDispC2         = 0x25,
+  cvLMADL          = 0x28,
+  cvLMADH          = 0x29,
+  cvLMC            = 0x2C
+} CVRegisters;
+
+// Bits of the status register
+typedef enum CVStatusRegisterBits {
+  cvSYSRES  = 0x0001, /* System reset */
+  cvSYSCTRL = 0x0002, /* System controller */
+  cvDTACK   = 0x0010, /* Last cycle terminated with DTACK */
+  cvBERR    = 0x0020, /* Last cycle terminated with BERR */
+  cvDIP0    = 0x0100, /* Dip Switch position 0 state */
+  cvDIP1    = 0x0200, /* Dip Switch position 1 state */
+  cvDIP2    = 0x0400, /* Dip Switch position 2 state */
+  cvDIP3    = 0x0800, /* Dip Switch position 3 state */
+  cvDIP4    = 0x1000, /* Dip Switch position 4 state */
+  cvUSBTYPE = 0x8000  /* USB Type (0 = 1.1; 1 = 2.0) */
+} CVStatusRegisterBits;
+
+// Bits of the input register
+typedef enum CVInputRegisterBits {
+  cvIn0Bit        = 0x0001, /* Input line 0 signal level */
+  cvIn1Bit        = 0x0002, /* Input line 1 signal level */
+  cvCoincBit      = 0x0004, /* Coincidence of input signal level */
+  cvPulsAOutBit   = 0x0008, /* Pulser A output signal level */
+  cvPulsBOutBit   = 0x0010, /* Pulser B output signal level */
+  cvScalEndCntBit = 0x0020, /* Scaler end counter signal level */
+  cvLocMonBit     = 0x0040, /* Location monitor signal level */
+} CVInputRegisterBits;
+
+// Bits of the output register
+typedef enum CVOutputRegisterBits {
+  cvPulsAStartBit = 0x0001, /* Pulser A start signal level */
+  cvPulsAResetBit = 0x0002, /* Pulser A reset signal level */
+  cvPulsBStartBit = 0x0004, /* Pulser B start signal level */
+  cvPulsBResetBit = 0x0008, /* Pulser B reset signal level */
+  cvScalGateBit   = 0x0010, /* Scaler gate signal level */
+  cvScalResetBit  = 0x0020, /* Scaler reset counter signal level */
+  cvOut0Bit       = 0x0040, /* Output line 0 signal level */
+  cvOut1Bit       = 0x0080, /* Output line 1 signal level */
+  cvOut2Bit       = 0x0100, /* Output line 2 signal level */
+  cvOut3Bit       = 0x0200, /* Output line 3 signal level */
+  cvOut4Bit       = 0x0400, /* Output line 4 signal level */
+} CVOutputRegisterBits;
+
+// Types of VME Arbiter
+typedef enum CVArbiterTypes {
+  cvPriorized  = 0, /* Priority Arbiter */
+  cvRoundRobin = 1  /* Round-Robin Arbiter */
+} CVArbiterTypes;
+
+// Types of VME Bus Requester
+typedef enum CVRequesterTypes {
+  cvFair   = 0, /* Fair bus requester */
+  cvDemand = 1  /* On demand bus requester */
+} CVRequesterTypes;
+
+// Types of VME Bus release
+typedef enum CVReleaseTypes {
+  cvRWD = 0, /* Release When Done */
+  cvROR = 1  /* Release On Request */
+} CVReleaseTypes;
+
+// VME bus request levels
+typedef enum CVBusReqLevels {
+  cvBR0 = 0,
+  cvBR1 = 1,
+  cvBR2 = 2,
+  cvBR3 = 3
+} CVBusReqLevels;
+
+// VME Interrupt levels (bit masks)
+typedef enum CVIRQLevels {
+  cvIRQ1 = 0x01,
+  cvIRQ2 = 0x02,
+  cvIRQ3 = 0x04,
+  cvIRQ4 = 0x08,
+  cvIRQ5 = 0x10,
+  cvIRQ6 = 0x20,
+  cvIRQ7 = 0x40
+} CVIRQLevels;
+
+// VME bus timeouts
+typedef enum CVVMETimeouts {
+  cvTimeout50us  = 0,
+  cvTimeout400us = 1
+} CVVMETimeouts;
+
+// Data type to store the front panel display last access data
+typedef struct CVDisplay {
+  long  cvAddress; /* VME Address */
+  long  cvData;    /* VME Data */
+  long  cvAM;      /* Address modifier */
+  long  cvIRQ;     /* IRQ levels */
+  short cvDS0;     /* Data Strobe 0 signal */
+  short cvDS1;     /* Data Strobe 1 signal */
+  short cvAS;      /* Address Strobe signal */
+  short cvIACK;    /* Interrupt Acknowledge signal */
+  short cvWRITE;   /* Write signal */
+  short cvLWORD;   /* Long Word signal */
+  short cvDTACK;   /* Data Acknowledge signal */
+  short cvBERR;    /* Bus Error signal */
+  short cvSYSRES;  /* System Reset signal */
+  short cvBR;      /* Bus Request signal */
+  short cvBG;      /* Bus Grant signal */
+} CVDisplay;
+
+#endif // __CAENVMETYPES_H
@@ -0,0 +1,96 @@
+#include "VmeUsbBridge.h"
+#include "VmeBlockPipeline.h"
+#include "TDC.h"
+#include "V1190Decoder.h"
+#include "CAENVMEemulator.h"
+#include <chrono>
+
+using namespace std;
+
+// Block transfer throughput versus the chunk size of the VmeUsbBridge, on top of the CAEN library emulator,
+// then sequential versus pipelined readout and decoding of the V1190 output buffer.
+// The latency model can be chosen with CAENVME_EMULATOR_LATENCY (none, V1718 or V2718).
+
+template<typename F> double timeit(F f) {
+  auto start = chrono::steady_clock::now();
+  f();
+  chrono::duration<double> elapsed = chrono::steady_clock::now()-start;
+  return elapsed.count();
+}
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeUsbBridge myCont(cvV2718);
+    SimulatedCrate* crate = CAENVMEemu_Crate(cvV2718);
+    SimulatedV1190* tdc = crate->board<SimulatedV1190>(0xAA0000);
+    Tdc myTdc(&myCont,0xAA0000);
+    // the output buffer is a FIFO: all chunks at the same address
+    myCont.setFIFOMode(true);
+    // throughput versus chunk size, reading 4 MB (fillers, once the output buffer is empty)
+    myTdc.enableBERR(false);
+    const int size = 4<<20;
+    ReadoutBuffer buffer(size);
+    for(int chunk=1024; chunk<=size; chunk*=4) {
+      myCont.setMaxBlockSize(chunk);
+      double elapsed = timeit([&](){ buffer.clear(); myCont.mode(cvA32_U_BLT,cvD32)->blockReadData<uint32_t>(0xAA0000, buffer, size/4); });
+      LOG_INFO("chunks of " + to_string(chunk/1024) + " kB: " + to_string(size/elapsed/1e6) + " MB/s");
+    }
+    // readout of a full output buffer, chunk by chunk, and decoding
+    myTdc.enableBERR(true);
+    tdc->setOccupancy(100.);
+    const int chunk = 32768;
+    const int nloops = 20;
+    size_t events = 0;
+    // the events crossing a chunk boundary are completed by the next chunk
+    V1190Decoder decoder;
+    std::vector<V1190Event> output;
+    V1190EventSink sink(output);
+    auto decode = [&](const ReadoutBuffer& data) {
+      output.clear();
+      events += decoder.decode(data.data<uint32_t>(), data.count<uint32_t>(), sink);
+    };
+    auto fill = [&]() { while(tdc->bufferedWords()<30000) tdc->trigger(); };
+    double sequential = 0;
+    ReadoutBuffer chunkBuffer(chunk);
+    for(int i=0;i<nloops;i++) {
+      fill();
+      sequential += timeit([&](){
+        while(true) {
+          chunkBuffer.clear();
+          bool done = false;
+          try {
+            done = myCont.mode(cvA32_U_BLT,cvD32)->blockReadData<uint32_t>(0xAA0000, chunkBuffer, chunk/4)<chunk/4;
+          } catch(CAENVMEexception& e) {
+            done = true;
+          }
+          decode(chunkBuffer);
+          if(done) break;
+        }
+      });
+    }
+    LOG_INFO("sequential: " + to_string(events) + " events, " + to_string(sequential/nloops*1e3) + " ms per buffer");
+    events = 0;
+    double pipelined = 0;
+    double waiting = 0;
+    VmeBlockPipeline pipeline(&myCont, chunk);
+    for(int i=0;i<nloops;i++) {
+      fill();
+      pipelined += timeit([&](){ pipeline.read(0xAA0000, 32768*4, cvA32_U_BLT, cvD32, true, decode); });
+      waiting += pipeline.waitTime();
+    }
+    LOG_INFO("pipelined: " + to_string(events) + " events, " + to_string(pipelined/nloops*1e3) + " ms per buffer, " +
+             to_string(waiting/nloops*1e3) + " ms waiting for the bus");
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
+    if (st) {
+      std::cerr << *st << '\n'; /*<-*/ return 0; /*->*/
+    } /*<-*/ return 3; /*->*/
+  }
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include "TDC.h"
+#include "V1190Decoder.h"
+#include "EventBatch.h"
+#include "V1190Kernels.h"
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+// Throughput of the V1190 output buffer decoding, offline, on synthetic data: 4 TDCs with headers and trailers,
+// extended trigger time, and a few error words.
+
+// best of several rounds, in s per call
+template<typename F> double timeit(F f, int rounds=5) {
+  double best = 0;
+  for(int r=0;r<rounds;r++){
+    auto start = chrono::steady_clock::now();
+    f();
+    chrono::duration<double> elapsed = chrono::steady_clock::now()-start;
+    if(r==0 || elapsed.count()<best) best = elapsed.count();
+  }
+  return best;
+}
+
+// sink keeping only counters: cost of the decoder itself
+struct CountingSink {
+  size_t hits = 0, tdcs = 0, errors = 0;
+  inline void globalHeader(uint32_t) {}
+  inline void extendedTriggerTime(uint32_t) {}
+  inline void tdcHeader(uint32_t) { ++tdcs; }
+  inline void hit(uint32_t, bool) { ++hits; }
+  inline void tdcError(uint32_t) { ++errors; }
+  inline void tdcTrailer(uint32_t) {}
+  inline void globalTrailer(uint32_t) {}
+};
+
+// EventBatch without its bulk hit method: one word at a time through the decoder switch
+struct PerWordSink {
+  EventBatch& batch;
+  inline void globalHeader(uint32_t word) { batch.globalHeader(word); }
+  inline void extendedTriggerTime(uint32_t word) { batch.extendedTriggerTime(word); }
+  inline void tdcHeader(uint32_t word) { batch.tdcHeader(word); }
+  inline void hit(uint32_t word, bool tdc) { batch.hit(word, tdc); }
+  inline void tdcError(uint32_t word) { batch.tdcError(word); }
+  inline void tdcTrailer(uint32_t word) { batch.tdcTrailer(word); }
+  inline void globalTrailer(uint32_t word) { batch.globalTrailer(word); }
+};
+
+std::vector<uint32_t> generate(int nevents, int hitsPerTdc) {
+  std::vector<uint32_t> data;
+  std::mt19937 random(1);
+  for(int e=0;e<nevents;e++) {
+    size_t start = data.size();
+    data.push_back(0x8<<27 | (e&0x3FFFFF)<<5 | 0x3);
+    for(uint32_t tdc=0;tdc<4;tdc++) {
+      size_t tdcStart = data.size();
+      data.push_back(0x1<<27 | tdc<<24 | (e&0xFFF)<<12 | (e*7&0xFFF));
+      for(int h=0;h<hitsPerTdc;h++) data.push_back((random()&0x1)<<26 | (tdc*32+random()%32)<<19 | (random()&0x7FFFF));
+      if(e%50==0) data.push_back(0x4<<27 | tdc<<24 | 0x1);
+      data.push_back(0x3<<27 | tdc<<24 | (e&0xFFF)<<12 | (data.size()-tdcStart+1));
+    }
+    data.push_back(0x11<<27 | (e*1000&0x7FFFFFF));
+    data.push_back(0x10<<27 | (data.size()-start+1)<<5 | 0x3);
+  }
+  return data;
+}
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  const int nevents = 20000;
+  std::vector<uint32_t> data = generate(nevents, 8);
+  LOG_INFO(to_string(data.size()) + " words, " + to_string(nevents) + " events");
+
+  // whole buffer at once, into a new vector
+  std::vector<V1190Event> reference;
+  double oneshot = timeit([&](){ reference.clear(); Tdc::decode(data.data(), data.size(), reference); });
+  LOG_INFO("Tdc::decode: " + to_string(data.size()/oneshot/1e6) + " Mwords/s");
+
+  // chunks of an odd size, most events span two chunks
+  const size_t chunk = 1021;
+  V1190Decoder decoder;
+  std::vector<V1190Event> output;
+  V1190EventSink sink(output);
+  double chunked = timeit([&](){
+    output.clear();
+    for(size_t i=0;i<data.size();i+=chunk) decoder.decode(data.data()+i, std::min(chunk, data.size()-i), sink);
+  });
+  LOG_INFO("V1190Decoder into V1190Event, chunks of " + to_string(chunk) + " words: " + to_string(data.size()/chunked/1e6) + " Mwords/s");
+  if(output.size()!=reference.size() || !std::equal(output.begin(), output.end(), reference.begin())) {
+    LOG_ERROR("chunked decoding differs from the one-shot decoding");
+    return 1;
+  }
+
+  // flat arrays, chunked as well
+  EventBatch batch;
+  double flat = timeit([&](){
+    batch.clear();
+    for(size_t i=0;i<data.size();i+=chunk) decoder.decode(data.data()+i, std::min(chunk, data.size()-i), batch);
+  });
+  LOG_INFO("V1190Decoder into EventBatch, chunks of " + to_string(chunk) + " words: " + to_string(data.size()/flat/1e6) + " Mwords/s");
+  for(size_t i=0;i<batch.size();i++) {
+    if(batch.size()!=reference.size() || !(batch.event(i)==reference[i])) {
+      LOG_ERROR("EventBatch differs from the one-shot decoding at event " + to_string(i));
+      return 1;
+    }
+  }
+
+  // analysis: histogram of the leading edge channels, over the events or over the flat arrays
+  std::vector<uint64_t> histogram(128);
+  double nested = timeit([&](){
+    std::fill(histogram.begin(), histogram.end(), 0);
+    for(const auto& event: reference)
+      for(const auto& tdc: event.getTDCEvents())
+        for(const auto& hit: tdc.getHits()) if(hit.getType()==0) ++histogram[hit.getChannel()];
+  });
+  uint64_t check = histogram[5];
+  double scan = timeit([&](){
+    std::fill(histogram.begin(), histogram.end(), 0);
+    const uint8_t* channels = batch.channels();
+    const uint8_t* edges = batch.edges();
+    for(size_t j=0;j<batch.hits();j++) histogram[channels[j]] += edges[j]==0;
+  });
+  LOG_INFO("channel histogram: " + to_string(nested*1e3) + " ms over V1190Event, " + to_string(scan*1e3) + " ms over EventBatch"
+           + (check==histogram[5] ? "" : " (MISMATCH)"));
+
+  // high occupancy: per word switch versus the SIMD kernels
+  data = generate(nevents/4, 64);
+  const char* names[] = {"scalar", "SSE4.2", "AVX2"};
+  LOG_INFO("high occupancy: " + to_string(data.size()) + " words, best instruction set " + names[V1190Kernels::active()]);
+  EventBatch perWord;
+  PerWordSink perWordSink{perWord};
+  double switched = timeit([&](){ perWord.clear(); decoder.decode(data.data(), data.size(), perWordSink); });
+  LOG_INFO("  EventBatch, per word switch: " + to_string(data.size()/switched/1e6) + " Mwords/s");
+  std::vector<uint8_t> types(data.size()), reference8(data.size());
+  std::vector<uint32_t> boundaries(data.size());
+  double switchedScan = timeit([&](){ for(size_t i=0;i<data.size();i++) reference8[i] = data[i]>>27; });
+  size_t nboundaries = 0;
+  double switchedBoundaries = timeit([&](){
+    nboundaries = 0;
+    for(size_t i=0;i<data.size();i++) {
+      switch(data[i]>>27) {
+        case 0x8: case 0x10: boundaries[nboundaries++] = i; break;
+      }
+    }
+  });
+  LOG_INFO("  classification, per word: " + to_string(data.size()/switchedScan/1e6) + " Mwords/s, boundaries: "
+           + to_string(data.size()/switchedBoundaries/1e6) + " Mwords/s");
+  for(int set=V1190Kernels::cvScalar; set<=V1190Kernels::cvAVX2; set++) {
+    if(!V1190Kernels::select(V1190Kernels::CVInstructionSet(set))) continue;
+    double bulk = timeit([&](){ batch.clear(); decoder.decode(data.data(), data.size(), batch); });
+    double classified = timeit([&](){ V1190Kernels::classify(data.data(), data.size(), types.data()); });
+    size_t found = 0;
+    double bounded = timeit([&](){ found = V1190Kernels::findBoundaries(data.data(), data.size(), boundaries.data(), boundaries.size()); });
+    bool same = batch.size()==perWord.size() && batch.hits()==perWord.hits() && types==reference8 && found==nboundaries &&
+      std::equal(batch.channels(), batch.channels()+batch.hits(), perWord.channels()) &&
+      std::equal(batch.measurements(), batch.measurements()+batch.hits(), perWord.measurements()) &&
+      std::equal(batch.edges(), batch.edges()+batch.hits(), perWord.edges());
+    LOG_INFO(std::string("  ") + names[set] + ": EventBatch " + to_string(data.size()/bulk/1e6) + " Mwords/s, classification "
+             + to_string(data.size()/classified/1e6) + " Mwords/s, boundaries " + to_string(data.size()/bounded/1e6) + " Mwords/s"
+             + (same ? "" : " (MISMATCH)"));
+    if(!same) return 1;
+  }
+
+  // decoder alone
+  CountingSink counter;
+  double counting = timeit([&](){ counter = CountingSink(); decoder.decode(data.data(), data.size(), counter); });
+  LOG_INFO("V1190Decoder into counters: " + to_string(data.size()/counting/1e6) + " Mwords/s (" + to_string(counter.hits) + " hits)");
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include "VmeSimulator.h"
+#include "VmeStaticController.h"
+#include "TDC.h"
+#include <chrono>
+
+using namespace std;
+
+// Measures the CPU overhead of the controller code path for each cycle, on a simulated crate without latency.
+// The cost of the simulated crate itself is measured first, and subtracted.
+
+// best of several rounds, in ns per call
+template<typename F> double timeit(F f, int n, int rounds=5) {
+  double best = 0;
+  for(int r=0;r<rounds;r++){
+    auto start = chrono::steady_clock::now();
+    for(int i=0;i<n;i++) f();
+    chrono::duration<double,std::nano> elapsed = chrono::steady_clock::now()-start;
+    if(r==0 || elapsed.count()/n<best) best = elapsed.count()/n;
+  }
+  return best;
+}
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator myCont;
+    SimulatedV1190* tdc = myCont.crate().board<SimulatedV1190>(0xAA0000);
+    Tdc myTdc(&myCont,0xAA0000);
+    typedef Tdc::Registers::Status Status;
+    const uint32_t base = 0xAA0000;
+    const int n = 200000;
+    volatile uint16_t sink = 0;
+    // single cycles
+    double crate = timeit([&](){ uint16_t data; myCont.crate().read(Status::address(base),&data,Status::AM,Status::DW); sink = data; }, n);
+    double temporary = timeit([&](){ sink = myCont.mode(Status::AM,Status::DW)->readData<uint16_t>(Status::address(base)); }, n);
+    double virtualRegister = timeit([&](){ sink = myCont.read<Status>(base); }, n);
+    VmeStaticController<VmeSimulator> direct(&myCont);
+    double staticRegister = timeit([&](){ sink = direct.read<Status>(base); }, n);
+    LOG_INFO("simulated crate: " + to_string(crate) + " ns per cycle");
+    LOG_INFO("mode()->readData: " + to_string(temporary) + " ns per cycle, overhead " + to_string(temporary-crate) + " ns");
+    LOG_INFO("read<Register>: " + to_string(virtualRegister) + " ns per cycle, overhead " + to_string(virtualRegister-crate) + " ns");
+    LOG_INFO("VmeStaticController::read<Register>: " + to_string(staticRegister) + " ns per cycle, overhead " + to_string(staticRegister-crate) + " ns");
+    // D32 readout of single events, through the FIFO
+    myTdc.enableFIFO(true);
+    const int nevents = 5000;
+    double generic = timeit([&](){ tdc->trigger(); myTdc.getEvent(true); }, nevents);
+    double statically = timeit([&](){ tdc->trigger(); myTdc.getEvent<VmeSimulator>(true); }, nevents);
+    LOG_INFO("Tdc::getEvent: " + to_string(generic/1000.) + " us per event, Tdc::getEvent<VmeSimulator>: " + to_string(statically/1000.) + " us per event");
+    // block transfer ended by a bus error (nothing at this address), reported by an exception or by a status
+    ReadoutBuffer buffer(1024);
+    const int nberr = 20000;
+    double thrown = timeit([&](){
+      buffer.clear();
+      try { myCont.mode(cvA24_U_BLT,cvD32)->blockReadData<uint32_t>(0x700000, buffer, 16); } catch(CAENVMEexception&) {}
+    }, nberr);
+    double returned = timeit([&](){ buffer.clear(); myCont.mode(cvA24_U_BLT,cvD32)->tryBlockReadData<uint32_t>(0x700000, buffer, 16); }, nberr);
+    LOG_INFO("BERR-terminated block read: " + to_string(thrown) + " ns with an exception, " + to_string(returned) + " ns with tryBlockReadData");
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    return 3;
+  }
+  return 0;
+}
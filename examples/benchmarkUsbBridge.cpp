@@ -0,0 +1,47 @@
+#include "VmeUsbBridge.h"
+#include "TDC.h"
+#include "CAENVMEemulator.h"
+#include <chrono>
+
+using namespace std;
+
+// Profiles the VmeUsbBridge code path on top of the CAEN library emulator.
+// The latency model can be chosen with CAENVME_EMULATOR_LATENCY (none, V1718 or V2718).
+
+template<typename F> double timeit(F f, int n) {
+  auto start = chrono::steady_clock::now();
+  for(int i=0;i<n;i++) f();
+  chrono::duration<double,std::micro> elapsed = chrono::steady_clock::now()-start;
+  return elapsed.count()/n;
+}
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeUsbBridge myCont;
+    SimulatedCrate* crate = CAENVMEemu_Crate(cvV1718);
+    SimulatedV1190* tdc = crate->board<SimulatedV1190>(0xAA0000);
+    Tdc myTdc(&myCont,0xAA0000);
+    myTdc.enableFIFO(true);
+    int n = crate->getLatency().singleCycle ? 1000 : 100000;
+    // single cycles
+    double read = timeit([&](){ myCont.mode(cvA32_U_DATA,cvD16)->readData<uint16_t>(0xAA1002); }, n);
+    double write = timeit([&](){ myCont.mode(cvA32_U_DATA,cvD16)->writeData<uint16_t>(0xAA1022,64); }, n);
+    LOG_INFO("single read: " + to_string(read) + " us, single write: " + to_string(write) + " us");
+    // readout of 10 events at a time, through the FIFO and BLT
+    size_t events = 0;
+    double readout = timeit([&](){ for(int i=0;i<10;i++) tdc->trigger(); events += myTdc.getEvents(true).size(); }, n/100);
+    LOG_INFO("readout of 10 events: " + to_string(readout) + " us (" + to_string(events) + " events read)");
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
+    if (st) {
+      std::cerr << *st << '\n'; /*<-*/ return 0; /*->*/
+    } /*<-*/ return 3; /*->*/
+  }
+  return 0;
+}
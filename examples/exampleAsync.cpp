@@ -0,0 +1,64 @@
+#include "VmeSimulator.h"
+#include "VmeAsyncQueue.h"
+#include "Scaler.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// Several threads monitor the scaler counters. With blocking calls, each cycle pays the full bridge latency.
+// With the asynchronous queue, the requests of all threads are merged into multi-cycle transactions.
+const int nthreads = 4;
+const int nreads = 2000;
+
+double blocking(VmeSimulator& cont) {
+  auto start = chrono::steady_clock::now();
+  vector<thread> threads;
+  for(int t=0;t<nthreads;++t) threads.emplace_back([&cont]() {
+    for(int i=0;i<nreads;++i) cont.mode(cvA24_U_DATA,cvD32)->readData<uint32_t>(0x0B0080+4*(i%16));
+  });
+  for(auto& t : threads) t.join();
+  return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+double asynchronous(VmeSimulator& cont) {
+  VmeAsyncQueue queue(&cont);
+  auto start = chrono::steady_clock::now();
+  vector<thread> threads;
+  for(int t=0;t<nthreads;++t) threads.emplace_back([&queue]() {
+    // keep a few requests in flight
+    vector<future<uint32_t> > inflight;
+    for(int i=0;i<nreads;++i) {
+      inflight.push_back(queue.read(0x0B0080+4*(i%16),cvA24_U_DATA,cvD32));
+      if(inflight.size()==16) {
+        for(auto& f : inflight) f.get();
+        inflight.clear();
+      }
+    }
+    for(auto& f : inflight) f.get();
+  });
+  for(auto& t : threads) t.join();
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+  LOG_INFO(to_string(queue.requests()) + " requests in " + to_string(queue.transactions()) + " transactions.");
+  return elapsed;
+}
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator myCont(SimulatedLatency::V1718());
+    Scaler myScaler(&myCont);
+    double sync = blocking(myCont);
+    double async = asynchronous(myCont);
+    LOG_INFO("blocking: " + to_string(nthreads*nreads/sync) + " reads/s, asynchronous: " + to_string(nthreads*nreads/async) + " reads/s");
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    return 3;
+  }
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include "VmeSimulator.h"
+#include "TTCvi.h"
+#include "TDC.h"
+#include "TdcChain.h"
+#include <chrono>
+
+using namespace std;
+
+// Reads the two V1190 of the simulated crate, board by board and then with one chained block transfer.
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator myCont(SimulatedLatency::V2718());
+    TtcVi myTTCvi(&myCont);
+    myTTCvi.setTriggerChannel(TtcVi::cvVME);
+    Tdc tdc1(&myCont,0x120000);
+    Tdc tdc2(&myCont,0xAA0000);
+    // no geographical addressing in the simulated crate: each board gets its own GEO address
+    tdc1.setGeoAddress(1);
+    tdc2.setGeoAddress(2);
+    const int ntriggers = 10;
+    const int nloops = 200;
+    // board by board
+    size_t nevents = 0;
+    auto start = chrono::steady_clock::now();
+    for(int i=0;i<nloops;i++) {
+      for(int j=0;j<ntriggers;j++) myTTCvi.trigger();
+      nevents += tdc1.getEvents(false).size();
+      nevents += tdc2.getEvents(false).size();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now()-start;
+    LOG_INFO("board by board: " + to_string(nevents) + " events in " + to_string(elapsed.count()) + " s, " +
+             to_string(elapsed.count()/nloops*1e6) + " us per readout");
+    // chained
+    TdcChain chain(&myCont);
+    chain.add(&tdc1);
+    chain.add(&tdc2);
+    nevents = 0;
+    start = chrono::steady_clock::now();
+    for(int i=0;i<nloops;i++) {
+      for(int j=0;j<ntriggers;j++) myTTCvi.trigger();
+      auto events = chain.getEvents();
+      for(size_t b=0;b<chain.boards();b++) {
+        nevents += events[b].size();
+        if(events[b].size()!=ntriggers) LOG_WARN("board " + to_string(b) + ": " + to_string(events[b].size()) + " events");
+      }
+    }
+    elapsed = chrono::steady_clock::now()-start;
+    LOG_INFO("chained: " + to_string(nevents) + " events in " + to_string(elapsed.count()) + " s, " +
+             to_string(elapsed.count()/nloops*1e6) + " us per readout");
+    // one event of each board
+    myTTCvi.trigger();
+    auto events = chain.getEvents();
+    for(size_t b=0;b<chain.boards();b++) {
+      for(auto e : events[b]) LOG_DATA_INFO(e.toString());
+    }
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
+    if (st) {
+      std::cerr << *st << '\n'; /*<-*/ return 0; /*->*/
+    } /*<-*/ return 3; /*->*/
+  }
+  return 0;
+}
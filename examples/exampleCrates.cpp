@@ -0,0 +1,48 @@
+#include "VmeSimulator.h"
+#include "VmeCrateManager.h"
+#include "TDC.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+// Reads a TDC in each of several crates, each with its own controller, in parallel.
+// With hardware, each VmeSimulator would be a VmeUsbBridge(cvV2718, link, 0) on its own optical link.
+void readout(int ncrates) {
+  vector<unique_ptr<VmeSimulator> > controllers;
+  vector<unique_ptr<Tdc> > tdcs;
+  VmeCrateManager manager;
+  for(int i=0;i<ncrates;++i) {
+    controllers.emplace_back(new VmeSimulator(SimulatedLatency::V2718()));
+    tdcs.emplace_back(new Tdc(controllers.back().get(),0xAA0000));
+    tdcs.back()->enableFIFO(true);
+    Tdc* tdc = tdcs.back().get();
+    SimulatedV1190* board = controllers.back()->crate().board<SimulatedV1190>(0xAA0000);
+    manager.add("crate" + to_string(i), controllers.back().get(), [tdc,board]() {
+      // the triggers would come from the experiment
+      for(int i=0;i<10;i++) board->trigger();
+      return tdc->getEvents(true).size();
+    });
+  }
+  manager.start();
+  this_thread::sleep_for(chrono::seconds(1));
+  manager.stop();
+  LOG_INFO(to_string(ncrates) + " crates: " + to_string(manager.events()) + " events/s");
+}
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    for(int ncrates : {1, 2, 4}) readout(ncrates);
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    return 3;
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include "VmeSimulator.h"
+#include "TdcReadoutEngine.h"
+#include "V1190Decoder.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+// Readout of a simulated V1190 (V2718 latency model) kept busy by a trigger thread, with the events decoded and
+// formatted as text: first one after the other in the main thread, then with the transfers in a TdcReadoutEngine.
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator myCont;
+    myCont.crate().setLatency(SimulatedLatency::V2718());
+    Tdc myTdc(&myCont,0xAA0000);
+    myTdc.enableFIFO(true);
+    SimulatedV1190* tdc = myCont.crate().board<SimulatedV1190>(0xAA0000);
+    tdc->setOccupancy(20.);
+    // trigger source: keeps the output buffer filled
+    atomic<bool> stop(false);
+    thread triggers([&](){
+      while(!stop) {
+        if(tdc->bufferedWords()<16384) tdc->trigger();
+        else this_thread::yield();
+      }
+    });
+    const size_t nevents = 20000;
+    size_t characters = 0;
+    auto process = [&](const V1190Event& event) { characters += event.toString().size(); };
+
+    // sequential
+    size_t nread = 0;
+    auto start = chrono::steady_clock::now();
+    while(nread<nevents) {
+      for(const auto& event : myTdc.getEvents(true)) {
+        process(event);
+        ++nread;
+      }
+    }
+    chrono::duration<double> sequential = chrono::steady_clock::now()-start;
+    LOG_INFO("sequential: " + to_string(nread) + " events in " + to_string(sequential.count()) + " s, " + to_string(nread/sequential.count()) + " events/s");
+
+    // readout engine
+    TdcReadoutEngine engine(&myTdc, 4);
+    V1190Decoder decoder;
+    std::vector<V1190Event> events;
+    V1190EventSink sink(events);
+    nread = 0;
+    start = chrono::steady_clock::now();
+    engine.start();
+    while(nread<nevents) {
+      const TdcReadoutEngine::Block* block = engine.next();
+      events.clear();
+      decoder.decode(block->data.data<uint32_t>(), block->data.count<uint32_t>(), sink);
+      engine.release(block);
+      for(const auto& event : events) process(event);
+      nread += events.size();
+    }
+    engine.stop();
+    chrono::duration<double> pipelined = chrono::steady_clock::now()-start;
+    LOG_INFO("engine: " + to_string(nread) + " events in " + to_string(pipelined.count()) + " s, " + to_string(nread/pipelined.count()) + " events/s, "
+             + to_string(engine.blocks()) + " blocks, " + to_string(engine.busTime()) + " s on the bus, " + to_string(engine.stallTime()) + " s stalled");
+    // the blocks read before stop() are still delivered
+    for(const TdcReadoutEngine::Block* block = engine.next(); block; block = engine.next()) engine.release(block);
+    stop = true;
+    triggers.join();
+    LOG_INFO(to_string(characters) + " characters formatted");
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
+    if (st) {
+      std::cerr << *st << '\n'; /*<-*/ return 0; /*->*/
+    } /*<-*/ return 3; /*->*/
+  }
+  return 0;
+}
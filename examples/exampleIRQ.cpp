@@ -0,0 +1,51 @@
+#include "VmeSimulator.h"
+#include "VmeIRQDispatcher.h"
+#include "TDC.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// Interrupt-driven readout of the V1190: the TDC raises an interrupt when its output buffer
+// reaches the almost-full level, and the dispatcher calls the readout. No cycle is done between triggers.
+const int ntriggers = 200;
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator myCont(SimulatedLatency::V1718());
+    Tdc myTdc(&myCont,0xAA0000);
+    myTdc.enableFIFO(true);
+    myTdc.setAlmostFullLevel(1);
+    myTdc.setInterrupt(3,0xDD);
+    SimulatedV1190* board = myCont.crate().board<SimulatedV1190>(0xAA0000);
+
+    atomic<size_t> nevents(0);
+    VmeIRQDispatcher dispatcher(&myCont);
+    dispatcher.registerHandler(3, 0xDD, [&](uint8_t, uint16_t) {
+      nevents += myTdc.getEvents(true).size();
+    });
+    dispatcher.start();
+    uint64_t cycles = myCont.crate().cycles();
+    // triggers, 1 ms apart
+    for(int i=0;i<ntriggers;++i) {
+      board->trigger();
+      this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    while(nevents<ntriggers) this_thread::sleep_for(chrono::milliseconds(1));
+    dispatcher.stop();
+    cycles = myCont.crate().cycles()-cycles;
+    LOG_INFO(to_string(nevents) + " events read on " + to_string(dispatcher.interrupts()) + " interrupts, with " +
+             to_string(cycles) + " single cycles (" + to_string(double(cycles)/nevents) + " per event).");
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    return 3;
+  }
+  return 0;
+}
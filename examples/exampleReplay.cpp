@@ -0,0 +1,51 @@
+#include "VmeSimulator.h"
+#include "VmeRecording.h"
+#include "TDC.h"
+#include <chrono>
+
+using namespace std;
+
+// Readout session of a TDC: configuration, then blocks of 10 events read with BLT.
+size_t session(VmeController* controller, SimulatedV1190* tdc) {
+  Tdc myTdc(controller,0xAA0000);
+  myTdc.enableFIFO(true);
+  size_t nevents = 0;
+  for(int i=0;i<200;i++) {
+    if(tdc) for(int j=0;j<10;j++) tdc->trigger();
+    nevents += myTdc.getEvents(true).size();
+  }
+  return nevents;
+}
+
+// Records a readout session on a simulated crate with the latency of a V1718, then replays it
+// as fast as possible and with the original timing.
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    auto time = [](std::function<size_t()> run, const string& what) {
+      auto start = chrono::steady_clock::now();
+      size_t nevents = run();
+      double elapsed = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+      LOG_INFO(what + ": " + to_string(nevents) + " events in " + to_string(elapsed) + " s, " + to_string(nevents/elapsed) + " events/s");
+    };
+    {
+      VmeSimulator bus(SimulatedLatency::V1718());
+      VmeRecorder recorder(&bus, "session.vmerec");
+      SimulatedV1190* tdc = bus.crate().board<SimulatedV1190>(0xAA0000);
+      time([&]() { return session(&recorder, tdc); }, "recorded session");
+    }
+    VmeReplayer replayer("session.vmerec");
+    time([&]() { return session(&replayer, nullptr); }, "fast replay");
+    replayer.rewind();
+    replayer.setOriginalTiming(true);
+    time([&]() { return session(&replayer, nullptr); }, "replay with the original timing");
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    return 3;
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include "VmeSimulator.h"
+#include "RunFile.h"
+#include "V1190Decoder.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+// Raw data of a simulated V1190 saved to a run file, compared to the text output of the data logger,
+// then read back and decoded offline.
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator myCont;
+    Tdc myTdc(&myCont,0xAA0000);
+    myTdc.enableFIFO(true);
+    SimulatedV1190* tdc = myCont.crate().board<SimulatedV1190>(0xAA0000);
+    tdc->setOccupancy(20.);
+    // blocks of 100 events, read beforehand: only the output is timed
+    std::vector<ReadoutBuffer> blocks(200);
+    size_t nevents = 0;
+    for(auto& block : blocks) {
+      for(int i=0;i<100;i++) tdc->trigger();
+      myTdc.readRaw(block);
+    }
+
+    // binary run file
+    auto start = chrono::steady_clock::now();
+    RunFileWriter writer("run.dat", myTdc, 1);
+    for(const auto& block : blocks) writer.write(block);
+    writer.close();
+    chrono::duration<double> binary = chrono::steady_clock::now()-start;
+    LOG_INFO("run file: " + to_string(writer.bytes()) + " bytes in " + to_string(binary.count()) + " s, " + to_string(writer.bytes()/binary.count()/1e6) + " MB/s");
+
+    std::vector<V1190Event> events;
+    for(const auto& block : blocks) Tdc::decode(block.data<uint32_t>(), block.count<uint32_t>(), events);
+
+    // offline: read back and decode
+    RunFileReader reader("run.dat");
+    V1190Decoder decoder;
+    EventBatch batch;
+    std::vector<uint32_t> words;
+    RunBlockHeader block;
+    size_t nblocks = 0;
+    while(reader.next(words, block)) {
+      decoder.decode(words.data(), words.size(), batch);
+      ++nblocks;
+    }
+    nevents = batch.size();
+    LOG_INFO("run " + to_string(reader.header().runNumber) + " of TDC " + to_string(reader.header().serialNumber) + ": " + to_string(nblocks)
+             + " blocks, " + to_string(nevents) + " events, " + to_string(batch.hits()) + " hits");
+    remove("run.dat");
+    if(nevents!=events.size()) {
+      LOG_ERROR("the run file holds " + to_string(nevents) + " events instead of " + to_string(events.size()));
+      return 1;
+    }
+
+    // text, through the data logger (flushed after each record). It replaces the default console output of the
+    // logger: the result goes to the standard output.
+    Logger::addDataFileLog("run.log");
+    start = chrono::steady_clock::now();
+    for(const auto& event : events) LOG_DATA_INFO(event.toString());
+    chrono::duration<double> text = chrono::steady_clock::now()-start;
+    std::cout << "data logger: " << events.size() << " events in " << text.count() << " s, against " << binary.count()
+              << " s for the run file" << std::endl;
+    remove("run.log");
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
+    if (st) {
+      std::cerr << *st << '\n'; /*<-*/ return 0; /*->*/
+    } /*<-*/ return 3; /*->*/
+  }
+  return 0;
+}
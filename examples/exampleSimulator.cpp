@@ -0,0 +1,70 @@
+#include "VmeSimulator.h"
+#include "TTCvi.h"
+#include "Discri.h"
+#include "Scaler.h"
+#include "TDC.h"
+#include <chrono>
+
+using namespace std;
+
+// read a number of events from the simulated V1190 and report the throughput
+void readout(VmeSimulator& cont, const string& label, int nevents, Tdc::CVBlockTransfer mode=Tdc::cvBLT, double occupancy=4.) {
+  Tdc myTdc(&cont,0xAA0000);
+  myTdc.enableFIFO(true);
+  myTdc.setBlockTransferMode(mode);
+  SimulatedV1190* tdc = cont.crate().board<SimulatedV1190>(0xAA0000);
+  tdc->setOccupancy(occupancy);
+  uint64_t bytes = cont.crate().bytesTransferred();
+  size_t nread = 0;
+  auto start = chrono::steady_clock::now();
+  while(nread<(size_t)nevents) {
+    for(int i=0;i<10;i++) tdc->trigger();
+    nread += myTdc.getEvents(true).size();
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now()-start;
+  bytes = cont.crate().bytesTransferred()-bytes;
+  LOG_INFO(label + ": " + to_string(nread) + " events in " + to_string(elapsed.count()) + " s, " +
+           to_string(nread/elapsed.count()) + " events/s, " + to_string(bytes/elapsed.count()/1e6) + " MB/s");
+}
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator myCont;
+    // the usual boards, at their default addresses
+    TtcVi myTTCvi(&myCont);
+    Discri myDiscri(&myCont);
+    Scaler myScaler(&myCont);
+    myDiscri.setThreshold(10);
+    myScaler.reset();
+    // triggers sent by the TTCvi reach the TDCs
+    myTTCvi.setTriggerChannel(TtcVi::cvVME);
+    Tdc myTdc(&myCont,0xAA0000);
+    myTdc.enableFIFO(true);
+    for(int i=0;i<5;i++) {
+      myTTCvi.trigger();
+      LOG_DATA_INFO(myTdc.getEvent(true).toString());
+    }
+    LOG_INFO("TTCvi event number: " + to_string(myTTCvi.getEventNumber()));
+    // throughput with the different latency models
+    readout(myCont,"no latency",100000);
+    myCont.crate().setLatency(SimulatedLatency::V2718());
+    readout(myCont,"V2718 latency",10000);
+    // large events: MBLT halves the transfer time
+    readout(myCont,"V2718 latency, 100 hits per event, BLT",10000,Tdc::cvBLT,100.);
+    readout(myCont,"V2718 latency, 100 hits per event, MBLT",10000,Tdc::cvMBLT,100.);
+    myCont.crate().setLatency(SimulatedLatency::V1718());
+    readout(myCont,"V1718 latency",1000);
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
+    if (st) {
+      std::cerr << *st << '\n'; /*<-*/ return 0; /*->*/
+    } /*<-*/ return 3; /*->*/
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include "VmeSimulator.h"
+#include "TdcStream.h"
+#include <chrono>
+
+using namespace std;
+
+// Continuous storage readout of a simulated V1190, with the V2718 latency model: one hit at a time with getHit,
+// then block transfers with a TdcStream.
+
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator myCont;
+    myCont.crate().setLatency(SimulatedLatency::V2718());
+    Tdc myTdc(&myCont,0xAA0000);
+    myTdc.setAcquisitionMode(Tdc::cvContinuous);
+    myTdc.enableBERR(true);
+    SimulatedV1190* tdc = myCont.crate().board<SimulatedV1190>(0xAA0000);
+    tdc->setOccupancy(64.);
+    // bursts of hits until the output buffer holds n words
+    auto fill = [&](size_t n) { while(tdc->bufferedWords()<n) tdc->trigger(); return tdc->bufferedWords(); };
+
+    size_t nhits = fill(2000);
+    auto start = chrono::steady_clock::now();
+    for(size_t i=0;i<nhits;i++) myTdc.getHit();
+    chrono::duration<double> elapsed = chrono::steady_clock::now()-start;
+    LOG_INFO("getHit: " + to_string(nhits) + " hits in " + to_string(elapsed.count()) + " s, " + to_string(nhits/elapsed.count()) + " hits/s");
+
+    TdcStream stream(&myTdc);
+    nhits = 0;
+    bool ordered = true;
+    uint64_t latest[4] = {0, 0, 0, 0};
+    start = chrono::steady_clock::now();
+    for(int i=0;i<20;i++) {
+      fill(30000);
+      for(const TdcStream::Hit& hit: stream) {
+        // the bursts follow each other: time order per TDC chip, across the 19 bits rollovers
+        if(hit.time<latest[hit.channel>>5]) ordered = false;
+        latest[hit.channel>>5] = hit.time;
+        ++nhits;
+      }
+    }
+    elapsed = chrono::steady_clock::now()-start;
+    LOG_INFO("TdcStream: " + to_string(nhits) + " hits in " + to_string(elapsed.count()) + " s, " + to_string(nhits/elapsed.count()) + " hits/s");
+    LOG_INFO("last timestamp: " + to_string(latest[0]) + " (" + to_string(latest[0]>>19) + " rollovers), " + (ordered ? "in time order" : "NOT in time order"));
+    if(!ordered) return 1;
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    const boost::stacktrace::stacktrace* st = boost::get_error_info<traced>(e);
+    if (st) {
+      std::cerr << *st << '\n'; /*<-*/ return 0; /*->*/
+    } /*<-*/ return 3; /*->*/
+  }
+  return 0;
+}
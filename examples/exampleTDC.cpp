@@ -15,6 +15,9 @@ int main(int argc, char* argv[]){
   try {
     VmeUsbBridge myCont;
     Tdc myTdc(&myCont,0xAA0000);
+    // wait for the micro controller with a short backoff, and give up after 1s
+    auto handshake = std::make_shared<BackoffWait>(1, 100, 2., 1000);
+    myTdc.setWaitPolicy(handshake);
     // some configuration...
     Tdc::WindowConfiguration conf;
     conf.width = 50;
@@ -62,6 +65,10 @@ int main(int argc, char* argv[]){
     for(auto e : events) {
       LOG_DATA_INFO(e.toString());
     }
+    // statistics of the micro controller handshakes
+    WaitStatistics stats = handshake->statistics();
+    LOG_INFO(to_string(stats.waits) + " handshakes, " + to_string(stats.meanPolls()) + " polls and " +
+             to_string(stats.meanTime()*1e6) + " us on average, " + to_string(stats.maxTime*1e6) + " us at most");
     // DONE
   } catch (const CAENVMEexception& e) {
     std::cerr << e.what() << '\n';
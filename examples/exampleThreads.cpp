@@ -0,0 +1,57 @@
+#include "VmeSimulator.h"
+#include "Discri.h"
+#include "Scaler.h"
+#include "TDC.h"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+// Two threads share one controller: one reads the TDC out (A32 BLT), the other
+// monitors the scaler and programs the discriminator (A24). Each cycle uses the mode of its own thread.
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  VmeSimulator myCont;
+  Tdc myTdc(&myCont,0xAA0000);
+  Discri myDiscri(&myCont);
+  Scaler myScaler(&myCont);
+  myTdc.enableFIFO(true);
+  SimulatedV1190* tdc = myCont.crate().board<SimulatedV1190>(0xAA0000);
+  atomic<bool> done(false);
+  atomic<int> errors(0);
+  size_t nevents = 0, nmonitor = 0;
+
+  thread readout([&]() {
+    try {
+      while(nevents<10000) {
+        for(int i=0;i<10;i++) tdc->trigger();
+        nevents += myTdc.getEvents(true).size();
+      }
+    } catch (const CAENVMEexception& e) {
+      LOG_ERROR(string("readout: ") + e.what());
+      ++errors;
+    }
+    done = true;
+  });
+  thread monitor([&]() {
+    try {
+      while(!done) {
+        myScaler.getCount(0);
+        myDiscri.setThreshold(nmonitor%255);
+        ++nmonitor;
+      }
+    } catch (const CAENVMEexception& e) {
+      LOG_ERROR(string("monitor: ") + e.what());
+      ++errors;
+    }
+  });
+  readout.join();
+  monitor.join();
+  LOG_INFO(to_string(nevents) + " events read while " + to_string(nmonitor) + " monitoring loops ran, " +
+           to_string(errors) + " errors.");
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,48 @@
+#include "VmeSimulator.h"
+#include "VmeTracer.h"
+#include "Discri.h"
+#include "Scaler.h"
+#include "TDC.h"
+
+using namespace std;
+
+// Traces the configuration and readout of a simulated crate, with the latency of a V2718.
+// The timeline is written to trace.json (to be opened with ui.perfetto.dev), and the latency
+// histograms of each board are printed.
+int main(int argc, char* argv[]){
+  if (argc > 1) {
+    Logger::initFromConfig(argv[1]);
+  } else {
+    Logger::init();
+  }
+  try {
+    VmeSimulator bus(SimulatedLatency::V2718());
+    VmeTracer myCont(&bus);
+    myCont.registerBoard("Tdc", 0xAA0000, 0x10000);
+    myCont.registerBoard("Discri", 0x070000, 0x10000);
+    myCont.registerBoard("Scaler", 0x0B0000, 0x10000);
+    // run start: configuration of the boards
+    Tdc myTdc(&myCont,0xAA0000);
+    Discri myDiscri(&myCont);
+    Scaler myScaler(&myCont);
+    myTdc.enableFIFO(true);
+    myTdc.enableTDCHeader(true);
+    myDiscri.setThreshold(18);
+    myScaler.reset();
+    // readout
+    SimulatedV1190* tdc = bus.crate().board<SimulatedV1190>(0xAA0000);
+    size_t nevents = 0;
+    for(int i=0;i<100;i++) {
+      for(int j=0;j<10;j++) tdc->trigger();
+      nevents += myTdc.getEvents(true).size();
+      myScaler.getCount(0);
+    }
+    myCont.writeChromeTrace("trace.json");
+    LOG_INFO(to_string(nevents) + " events read, " + to_string(myCont.recorded()) + " operations traced to trace.json");
+    for(auto& h : myCont.histograms()) LOG_INFO(h.toString());
+  } catch (const CAENVMEexception& e) {
+    std::cerr << e.what() << '\n';
+    return 3;
+  }
+  return 0;
+}
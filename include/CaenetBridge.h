@@ -25,6 +25,16 @@
 // V288 CAEN board
 class CaenetBridge:public VmeBoard{
 public:
+  // register map
+  struct Registers {
+    typedef VmeRegister<0x00, uint16_t, cvA24_S_DATA, cvReadWrite> Data;     ///< transmit buffer (write), receive buffer (read)
+    typedef VmeRegister<0x02, uint16_t, cvA24_S_DATA, cvReadOnly>  Status;
+    typedef VmeRegister<0x04, uint16_t, cvA24_S_DATA, cvWriteOnly> Transmit;
+    typedef VmeRegister<0x06, uint16_t, cvA24_S_DATA, cvWriteOnly> Reset;
+
+    typedef VmeBitField<Status, 0> Invalid;
+  };
+
   CaenetBridge(VmeController *cont, uint32_t bridgeAdd, uint8_t interrupt = 0);
   
   // Performs a reset
@@ -41,7 +41,7 @@
 typedef boost::error_info<struct tag_stacktrace, boost::stacktrace::stacktrace> traced;
 
 template <class E>
-void throw_with_trace(const E& e) {
+[[noreturn]] void throw_with_trace(const E& e) {
     throw boost::enable_error_info(e)
         << traced(boost::stacktrace::stacktrace());
 }
@@ -57,6 +57,8 @@ class CAENVMEexception: public std::exception
     {
       return CAENVME_DecodeError(errorcode_);
     }
+
+    inline CAENVME_API errorcode() const { return errorcode_; }
     
   private:
     CAENVME_API errorcode_;
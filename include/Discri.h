@@ -33,6 +33,19 @@ public:
     uint16_t moduleType_;
   };
   
+  // register map
+  struct Registers {
+    typedef VmeRegister<0x00, uint16_t, cvA32_U_DATA, cvWriteOnly, 16> Threshold;
+    typedef VmeRegister<0x40, uint16_t, cvA32_U_DATA, cvWriteOnly, 2>  OutputWidth;   ///< channels 0-7, 8-15
+    typedef VmeRegister<0x44, uint16_t, cvA32_U_DATA, cvWriteOnly, 2>  DeadTime;      ///< channels 0-7, 8-15
+    typedef VmeRegister<0x48, uint16_t, cvA32_U_DATA, cvWriteOnly>     Majority;
+    typedef VmeRegister<0x4A, uint16_t, cvA32_U_DATA, cvWriteOnly>     PatternInhibit;
+    typedef VmeRegister<0x4C, uint16_t, cvA32_U_DATA, cvWriteOnly>     TestPulse;
+    typedef VmeRegister<0xFA, uint16_t, cvA32_U_DATA, cvReadOnly>      FixedCode;
+    typedef VmeRegister<0xFC, uint16_t, cvA32_U_DATA, cvReadOnly>      ModuleType;
+    typedef VmeRegister<0xFE, uint16_t, cvA32_U_DATA, cvReadOnly>      SerialNumber;
+  };
+
   Discri(VmeController *controller,int add=0x070000);
   
   // Enable channel
@@ -45,7 +58,7 @@ public:
   void setChannelMask(uint16_t mask);
   
   // Get the global channel mask
-  inline uint16_t getChannelMask() const { return status_; }
+  inline uint16_t getChannelMask() const { return written<Registers::PatternInhibit>(); }
   
   // Sets the number of channels for a coincidence.
   // This function will send a number to the appropriate register in the Discriminator 
@@ -70,8 +83,6 @@ public:
 private:  
   void setChannel(uint8_t channel, bool newState);
   
-  int status_;
-  
   static std::vector<float> widths_;
   static std::vector<float> wcounts_;
   static std::vector<float> deadtimes_;
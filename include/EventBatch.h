@@ -0,0 +1,127 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __EVENTBATCH
+#define __EVENTBATCH
+
+#include "V1190Event.h"
+#include "V1190Kernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Batch of V1190 events stored as flat arrays (one per field) instead of a vector of V1190Event, each with its own
+// hit vectors. The hits of event i are at [hitBegin(i), hitEnd(i)) in the hit arrays, whether they were read inside
+// TDC header/trailer pairs or not; the TDC blocks of event i are at [tdcBegin(i), tdcEnd(i)) in the TDC arrays.
+// An EventBatch is also a V1190Decoder sink: an event is added when its global trailer is decoded, the event being
+// decoded is kept aside until then (also across clear()). Once the arrays are large enough, filling a batch does
+// not allocate memory.
+class EventBatch
+{
+public:
+  EventBatch();
+  
+  // number of complete events, of their hits and TDC blocks
+  inline size_t size() const { return eventCount_.size(); }
+  inline size_t hits() const { return hitOffset_[size()]; }
+  inline size_t tdcs() const { return tdcOffset_[size()]; }
+  
+  // removes the complete events, keeps the memory and the event being decoded
+  void clear();
+  // allocates memory for the given number of events, hits and TDC blocks
+  void reserve(size_t events, size_t hits, size_t tdcs=0);
+  
+  // per event arrays
+  inline const std::vector<uint32_t>& eventCounts() const { return eventCount_; }
+  inline const std::vector<uint8_t>& geos() const { return geo_; }
+  inline const std::vector<uint8_t>& statuses() const { return status_; }
+  inline const std::vector<uint32_t>& extdTriggerTimes() const { return extTriggerTime_; }
+  inline size_t hitBegin(size_t event) const { return hitOffset_[event]; }
+  inline size_t hitEnd(size_t event) const { return hitOffset_[event+1]; }
+  inline size_t tdcBegin(size_t event) const { return tdcOffset_[event]; }
+  inline size_t tdcEnd(size_t event) const { return tdcOffset_[event+1]; }
+  
+  // per hit arrays (only the first hits() entries are complete events)
+  inline const uint8_t* channels() const { return channel_.data(); }
+  inline const uint32_t* measurements() const { return measurement_.data(); }
+  inline const uint8_t* edges() const { return edge_.data(); } ///< 0: leading, 1: trailing
+  
+  // per TDC block arrays (only the first tdcs() entries are complete events)
+  inline const uint8_t* tdcIds() const { return tdcId_.data(); }
+  inline const uint16_t* tdcEventIds() const { return tdcEventId_.data(); }
+  inline const uint16_t* bunchIds() const { return bunchId_.data(); }
+  inline const uint16_t* errorFlags() const { return errorFlags_.data(); }
+  inline size_t tdcHitBegin(size_t tdc) const { return tdcHitOffset_[tdc]; }
+  
+  // event i as a V1190Event
+  V1190Event event(size_t i) const;
+  
+  // V1190Decoder sink
+  inline void globalHeader(uint32_t word) {
+    // drop what remains of an event without trailer
+    channel_.resize(hits()); measurement_.resize(hits()); edge_.resize(hits());
+    tdcId_.resize(tdcs()); tdcEventId_.resize(tdcs()); bunchId_.resize(tdcs()); errorFlags_.resize(tdcs()); tdcHitOffset_.resize(tdcs());
+    header_ = word;
+    extdTime_ = 0;
+  }
+  inline void extendedTriggerTime(uint32_t word) { extdTime_ = word&0x7FFFFFF; }
+  inline void tdcHeader(uint32_t word) {
+    tdcId_.push_back((word>>24)&0x3);
+    tdcEventId_.push_back((word>>12)&0xFFF);
+    bunchId_.push_back(word&0xFFF);
+    errorFlags_.push_back(0);
+    tdcHitOffset_.push_back(channel_.size());
+  }
+  inline void hit(uint32_t word, bool) {
+    edge_.push_back((word>>26)&0x1);
+    channel_.push_back((word>>19)&0x7F);
+    measurement_.push_back(word&0x7FFFF);
+  }
+  inline void hitRun(const uint32_t* words, size_t n, bool) {
+    size_t first = channel_.size();
+    channel_.resize(first+n); measurement_.resize(first+n); edge_.resize(first+n);
+    V1190Kernels::extractHits(words, n, channel_.data()+first, measurement_.data()+first, edge_.data()+first);
+  }
+  inline void tdcError(uint32_t word) { if(tdcs()<tdcId_.size()) errorFlags_.back() = word&0xFFFF; }
+  inline void tdcTrailer(uint32_t) {}
+  inline void globalTrailer(uint32_t word) {
+    eventCount_.push_back((header_>>5)&0x3FFFFF);
+    geo_.push_back(header_&0x1F);
+    status_.push_back((word>>24)&0x7);
+    extTriggerTime_.push_back(extdTime_);
+    hitOffset_.push_back(channel_.size());
+    tdcOffset_.push_back(tdcId_.size());
+  }
+  
+private:
+  // per event, offsets with one more entry (end of the last event)
+  std::vector<uint32_t> eventCount_, extTriggerTime_;
+  std::vector<uint8_t> geo_, status_;
+  std::vector<uint32_t> hitOffset_, tdcOffset_;
+  // per hit
+  std::vector<uint8_t> channel_, edge_;
+  std::vector<uint32_t> measurement_;
+  // per TDC block
+  std::vector<uint8_t> tdcId_;
+  std::vector<uint16_t> tdcEventId_, bunchId_, errorFlags_;
+  std::vector<uint32_t> tdcHitOffset_;
+  // event being decoded
+  uint32_t header_, extdTime_;
+};
+
+#endif // __EVENTBATCH
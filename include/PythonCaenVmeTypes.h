@@ -23,6 +23,14 @@ using namespace boost::python;
 
 void exposeCaenVmeTypes() {
 
+enum_<CVBoardTypes>("CVBoardTypes")
+  .value("cvV1718", cvV1718)
+  .value("cvV2718", cvV2718)
+  .value("cvA2818", cvA2818)
+  .value("cvA2719", cvA2719)
+  .value("cvA3818", cvA3818)
+  ;
+
 enum_<CVDataWidth>("CVDataWidth")
   .value("cvD8", cvD8)
   .value("cvD16", cvD16)
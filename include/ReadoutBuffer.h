@@ -0,0 +1,69 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __READOUTBUFFER
+#define __READOUTBUFFER
+
+#include <cstddef>
+#include <cstdint>
+
+// Reusable memory for block transfers.
+// The storage is page aligned, or backed by huge pages when requested and available.
+// It only grows: once large enough, filling it again does not allocate.
+class ReadoutBuffer{
+  public:
+    enum CVBacking { cvPages, cvHugePages };
+
+    explicit ReadoutBuffer(size_t capacity=0, CVBacking backing=cvPages);
+    ReadoutBuffer(const ReadoutBuffer& other);
+    ReadoutBuffer(ReadoutBuffer&& other) noexcept;
+    ReadoutBuffer& operator=(ReadoutBuffer other) noexcept;
+    ~ReadoutBuffer();
+
+    // make room for at least capacity bytes. The content is preserved.
+    void reserve(size_t capacity);
+
+    // sets the number of valid bytes, growing the storage if needed.
+    void resize(size_t size);
+    inline void clear() { size_ = 0; }
+
+    // raw storage, seen as an array of T
+    template<typename T> inline T* data() { return reinterpret_cast<T*>(data_); }
+    template<typename T> inline const T* data() const { return reinterpret_cast<const T*>(data_); }
+
+    // number of valid T elements
+    template<typename T> inline size_t count() const { return size_/sizeof(T); }
+
+    inline size_t size() const { return size_; }
+    inline size_t capacity() const { return capacity_; }
+    inline CVBacking backing() const { return backing_; }
+    inline bool hugePages() const { return hugePages_; }
+
+  private:
+    void allocate(size_t capacity, unsigned char*& data, size_t& allocated, bool& huge) const;
+    void release(unsigned char* data, size_t allocated, bool huge) const;
+
+    unsigned char* data_;
+    size_t size_;
+    size_t capacity_;
+    size_t allocated_;
+    CVBacking backing_;
+    bool hugePages_;
+};
+
+#endif
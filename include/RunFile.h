@@ -0,0 +1,136 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __RUNFILE
+#define __RUNFILE
+
+#include "TDC.h"
+#include "TdcReadoutEngine.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary run file of V1190 raw data: a RunFileHeader, then blocks, each a RunBlockHeader followed by the 32 bits
+// words as read from the output buffer (to be decoded again with a V1190Decoder). Native byte order (little endian).
+
+// configuration of the TDC at the start of the run
+struct RunConfiguration {
+  uint32_t baseAddress;
+  uint16_t control;             ///< control register
+  uint16_t almostFullLevel;
+  uint8_t acquisitionMode;      ///< Tdc::CVAcquisitionMode
+  uint8_t edgeDetection;        ///< Tdc::CVEdgeDetection
+  uint8_t resolution;           ///< Tdc::CVEdgeLSB
+  uint8_t deadTime;             ///< Tdc::CVDeadTime
+  uint8_t tdcHeaders;
+  uint8_t geo;
+  uint8_t blockTransfer;        ///< Tdc::CVBlockTransfer
+  uint8_t triggerTimeSubstraction;
+  int16_t maxHits;              ///< -1: no limit
+  uint16_t windowWidth;         ///< trigger window, as in Tdc::WindowConfiguration
+  uint16_t windowOffset;
+  uint16_t extraMargin;
+  uint16_t rejectMargin;
+  uint16_t internalErrorTypes;
+  uint16_t fifoSize;
+  uint16_t reserved;
+};
+
+struct RunFileHeader {
+  char magic[8];                ///< "V1190RUN"
+  uint32_t version;             ///< format version (1)
+  uint32_t headerSize;          ///< sizeof(RunFileHeader): first block
+  uint64_t startTime;           ///< ns since the epoch
+  uint32_t runNumber;
+  // Tdc::ModuleInfo
+  uint32_t manufacturer;
+  uint32_t moduleType;
+  uint16_t serialNumber;
+  uint16_t revisionMinor;
+  uint16_t revisionMajor;
+  uint8_t moduleVersion;
+  uint8_t firmwareVersion;
+  RunConfiguration configuration;
+  uint32_t reserved;
+};
+
+struct RunBlockHeader {
+  uint32_t marker;              ///< "BLK1", to resynchronize on a damaged file
+  uint32_t words;               ///< number of words following
+  uint64_t sequence;            ///< block number
+  uint64_t timestamp;           ///< end of the readout, ns since the epoch
+};
+
+static_assert(sizeof(RunConfiguration)==32 && sizeof(RunFileHeader)==80 && sizeof(RunBlockHeader)==24, "run file layout");
+
+// Writes a run file through a large buffer: the file is only written when the buffer is full (or flushed).
+// Throws a CAENVMEexception (cvGenericError) if the file cannot be opened or written.
+class RunFileWriter{
+public:
+  // the header is filled from the module info and the configuration read from tdc
+  RunFileWriter(const std::string& filename, Tdc& tdc, uint32_t runNumber=0, size_t bufferSize=0x400000);
+  RunFileWriter(const RunFileWriter&) = delete;
+  RunFileWriter& operator=(const RunFileWriter&) = delete;
+  ~RunFileWriter();
+
+  // appends a block of n words, read at timestamp (ns since the epoch, now if 0)
+  void write(const uint32_t* words, size_t n, uint64_t timestamp=0);
+  inline void write(const ReadoutBuffer& data, uint64_t timestamp=0) { write(data.data<uint32_t>(), data.count<uint32_t>(), timestamp); }
+  inline void write(const TdcReadoutEngine::Block& block) { write(block.data, block.timestamp); }
+
+  void flush();
+  void close(); ///< flush and close the file. Nothing is written after.
+
+  inline const RunFileHeader& header() const { return header_; }
+  inline uint64_t blocks() const { return blocks_; }
+  inline uint64_t bytes() const { return bytes_; } ///< written to the file or buffered, header included
+
+  static RunConfiguration snapshot(Tdc& tdc);
+
+private:
+  void append(const void* data, size_t size);
+
+  std::ofstream file_;
+  std::string filename_;
+  std::vector<char> buffer_;
+  size_t used_;
+  RunFileHeader header_;
+  uint64_t blocks_;
+  uint64_t bytes_;
+};
+
+// Reads back a run file, block by block.
+class RunFileReader{
+public:
+  explicit RunFileReader(const std::string& filename);
+
+  inline const RunFileHeader& header() const { return header_; }
+
+  // next block: its words replace the content of words. Returns false at the end of the file, throws if the block
+  // is corrupted or truncated.
+  bool next(std::vector<uint32_t>& words, RunBlockHeader& block);
+  inline bool next(std::vector<uint32_t>& words) { RunBlockHeader block; return next(words, block); }
+
+private:
+  std::ifstream file_;
+  std::string filename_;
+  uint64_t size_;
+  RunFileHeader header_;
+};
+
+#endif
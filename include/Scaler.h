@@ -31,6 +31,17 @@ public:
     uint16_t moduleType_;
   };
   
+  // register map
+  struct Registers {
+    typedef VmeRegister<0x00, uint16_t, cvA24_U_DATA, cvWriteOnly>         Reset;
+    typedef VmeRegister<0x40, uint32_t, cvA24_U_DATA, cvReadOnly, 16>      CountAndReset; ///< reading resets the counter
+    typedef VmeRegister<0x40, uint32_t, cvA24_U_DATA, cvWriteOnly, 16>     Preset;
+    typedef VmeRegister<0x80, uint32_t, cvA24_U_DATA, cvReadOnly, 16>      Count;
+    typedef VmeRegister<0xFA, uint16_t, cvA24_U_DATA, cvReadOnly>          FixedCode;
+    typedef VmeRegister<0xFC, uint16_t, cvA24_U_DATA, cvReadOnly>          ModuleType;
+    typedef VmeRegister<0xFE, uint16_t, cvA24_U_DATA, cvReadOnly>          SerialNumber;
+  };
+
   Scaler(VmeController* controller,uint32_t address=0x0B0000);///<Constructor. Sets up the address and tests communication.
   
   // Getting count value for channel [0,15]. It reads the appropriate register and returns its value.
@@ -0,0 +1,374 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __SIMULATEDCRATE
+#define __SIMULATEDCRATE
+
+// Register-level models of the supported VME boards, gathered in a crate.
+// This only depends on the CAEN types, so that it can be used both by the
+// VmeSimulator controller and by a stand-in for the CAEN library itself.
+
+#include "CAENVMEtypes.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <random>
+
+class SimulatedCrate;
+
+// Cost of the bus operations, as seen from the host (all times in ns).
+struct SimulatedLatency {
+  uint32_t singleCycle; // one single read/write cycle, including the round trip
+  uint32_t blockSetup;  // fixed cost of one block transfer
+  double   perByte;     // additional cost per byte moved in a block transfer (half of it in MBLT)
+  uint32_t irq;         // IRQ check, enable, disable and IACK operations
+
+  // no latency at all: measures the pure software overhead
+  static SimulatedLatency none() { return {0, 0, 0., 0}; }
+  // typical figures for a V1718 on USB 2.0
+  static SimulatedLatency V1718() { return {125000, 125000, 33., 125000}; }
+  // typical figures for a V2718 on an optical link
+  static SimulatedLatency V2718() { return {8000, 10000, 12.5, 8000}; }
+};
+
+// Generic model of a board. Offsets are relative to the base address.
+class SimulatedBoard{
+public:
+  SimulatedBoard(uint32_t baseAddress, uint32_t size);
+  virtual ~SimulatedBoard() {}
+
+  inline uint32_t baseAddress() const { return baseAddress_; }
+  inline uint32_t size() const { return size_; }
+  inline bool decodes(uint32_t address) const { return address>=baseAddress_ && address-baseAddress_<size_; }
+
+  // name of the board, used in messages
+  virtual std::string name() const = 0;
+
+  // single cycles
+  virtual CVErrorCodes read(uint32_t offset, uint32_t& data, CVDataWidth DW) = 0;
+  virtual CVErrorCodes write(uint32_t offset, uint32_t data, CVDataWidth DW) = 0;
+
+  // block transfers. By default, successive single cycles on increasing addresses.
+  virtual CVErrorCodes blockRead(uint32_t offset, unsigned char* buffer, int size, CVDataWidth DW, int* count);
+  virtual CVErrorCodes blockWrite(uint32_t offset, const unsigned char* buffer, int size, CVDataWidth DW, int* count);
+
+  // interrupter: active level (1-7, 0 if no request pending) and vector returned on IACK
+  virtual uint8_t irqLevel() const { return 0; }
+  virtual uint16_t iack() { return 0xFF; }
+
+  // called by the crate when a system reset is issued
+  virtual void systemReset() {}
+
+  // chained block transfers (CBLT): position of the board in the chain answering at address
+  // (0: not chained, 1: last board, 2: first board, 3: intermediate board, as in the CAEN MCST/CBLT control registers)
+  virtual uint8_t chainPosition(uint32_t address) const { return 0; }
+  // data sent while the board holds the token. Returns true when the token is passed to the next board.
+  virtual bool chainedRead(unsigned char* buffer, int size, int* count) { *count = 0; return true; }
+
+protected:
+  // to be called when the interrupt request line changes
+  void irqChanged();
+
+  // lock the crate, for actions initiated outside of a bus cycle (front panel inputs)
+  std::unique_lock<std::recursive_mutex> lockCrate() const;
+
+private:
+  uint32_t baseAddress_;
+  uint32_t size_;
+  SimulatedCrate* crate_;
+
+  friend class SimulatedCrate;
+};
+
+// CAEN V1190 A/B multihit TDC
+class SimulatedV1190: public SimulatedBoard{
+public:
+  SimulatedV1190(uint32_t baseAddress=0x00120000, bool versionB=false, uint16_t serialNumber=0x0042);
+
+  std::string name() const override { return "V1190"; }
+
+  CVErrorCodes read(uint32_t offset, uint32_t& data, CVDataWidth DW) override;
+  CVErrorCodes write(uint32_t offset, uint32_t data, CVDataWidth DW) override;
+  CVErrorCodes blockRead(uint32_t offset, unsigned char* buffer, int size, CVDataWidth DW, int* count) override;
+
+  uint8_t irqLevel() const override;
+  uint16_t iack() override { return interruptVector_; }
+
+  void systemReset() override { moduleReset(); }
+
+  uint8_t chainPosition(uint32_t address) const override;
+  bool chainedRead(unsigned char* buffer, int size, int* count) override;
+
+  // front panel trigger: generates one event (or a burst of hits, later in time than the previous one, in continuous mode)
+  void trigger();
+
+  // average number of hits per event, and RNG seed of the hit generator
+  void setOccupancy(double hitsPerEvent) { occupancy_ = hitsPerEvent; }
+  void setSeed(uint32_t seed) { rng_.seed(seed); }
+
+  // inspection
+  inline size_t bufferedWords() const { return outputBuffer_.size(); }
+  inline uint32_t triggerCount() const { return eventCounter_; }
+
+private:
+  void moduleReset();
+  void softwareClear();
+  void writeMicro(uint16_t word);
+  void pushEvent(const std::vector<uint32_t>& words);
+  std::vector<uint32_t> makeHits(uint8_t tdc);
+  uint16_t status() const;
+
+  bool versionB_;
+  uint16_t serialNumber_;
+
+  // registers
+  uint16_t control_;
+  uint8_t geo_;
+  uint8_t interruptLevel_;
+  uint8_t interruptVector_;
+  uint16_t almostFullLevel_;
+  uint16_t bltEventNumber_;
+  uint8_t mcstAddress_;
+  uint8_t mcstControl_;
+  uint16_t chainEvents_; // events sent since the board got the CBLT token
+  uint32_t eventCounter_;
+  bool triggerLost_;
+
+  // output buffer and event FIFO
+  std::deque<uint32_t> outputBuffer_;
+  std::deque<uint32_t> eventFIFO_;
+  uint32_t storedEvents_;
+
+  // micro controller: pending opcode, expected parameters and words to be read back
+  uint16_t opcode_;
+  std::vector<uint16_t> parameters_;
+  size_t expectedParameters_;
+  std::deque<uint16_t> microOutput_;
+
+  // configuration set through the micro controller
+  bool triggerMatching_;
+  std::array<uint16_t,5> window_; // width, offset, extra margin, reject margin, subtraction
+  uint16_t edgeDetection_;
+  uint16_t resolution_;
+  uint16_t deadTime_;
+  bool tdcHeaders_;
+  uint16_t maxHits_;
+  bool errorMark_;
+  bool bypass_;
+  uint16_t errorTypes_;
+  uint16_t fifoSize_;
+  std::bitset<128> enabledChannels_;
+
+  // hit generator. In continuous storage, the hits of a burst follow a running clock, which rolls over like the
+  // 19 bits measurement.
+  double occupancy_;
+  std::mt19937 rng_;
+  uint32_t clock_;
+};
+
+// CAEN V812 constant fraction discriminator. Configuration registers are write-only.
+class SimulatedV812: public SimulatedBoard{
+public:
+  SimulatedV812(uint32_t baseAddress=0x070000, uint16_t serialNumber=0x0042);
+
+  std::string name() const override { return "V812"; }
+
+  CVErrorCodes read(uint32_t offset, uint32_t& data, CVDataWidth DW) override;
+  CVErrorCodes write(uint32_t offset, uint32_t data, CVDataWidth DW) override;
+
+  // inspection
+  inline uint8_t threshold(uint8_t channel) const { return thresholds_.at(channel); }
+  inline uint16_t pattern() const { return pattern_; }
+  inline uint16_t majority() const { return majority_; }
+  inline uint32_t testPulses() const { return testPulses_; }
+
+private:
+  uint16_t serialNumber_;
+  std::array<uint8_t,16> thresholds_;
+  std::array<uint8_t,2> widths_;
+  std::array<uint8_t,2> deadTimes_;
+  uint16_t majority_;
+  uint16_t pattern_;
+  uint32_t testPulses_;
+};
+
+// Lecroy 1151N 16 channels scaler
+class Simulated1151N: public SimulatedBoard{
+public:
+  Simulated1151N(uint32_t baseAddress=0x0B0000, uint16_t serialNumber=0x0042);
+
+  std::string name() const override { return "1151N"; }
+
+  CVErrorCodes read(uint32_t offset, uint32_t& data, CVDataWidth DW) override;
+  CVErrorCodes write(uint32_t offset, uint32_t data, CVDataWidth DW) override;
+
+  // inject counts in one channel
+  void count(uint8_t channel, uint32_t n=1);
+
+private:
+  uint32_t value(uint8_t channel) const;
+
+  uint16_t serialNumber_;
+  std::array<uint32_t,16> counts_;
+  std::array<uint32_t,16> presets_;
+};
+
+// TTCvi trigger and timing controller
+class SimulatedTTCvi: public SimulatedBoard{
+public:
+  SimulatedTTCvi(uint32_t baseAddress=0x555500, uint32_t serialNumber=0x42);
+
+  std::string name() const override { return "TTCvi"; }
+
+  CVErrorCodes read(uint32_t offset, uint32_t& data, CVDataWidth DW) override;
+  CVErrorCodes write(uint32_t offset, uint32_t data, CVDataWidth DW) override;
+
+  // function called for each L1A sent, to connect the TTCvi to other boards
+  void onL1A(std::function<void()> callback) { l1aCallbacks_.push_back(callback); }
+
+  // L1A coming from the front panel inputs
+  void externalTrigger(uint8_t input);
+
+  // inspection
+  inline uint32_t asyncCommands() const { return asyncCommands_; }
+
+private:
+  void l1a();
+
+  uint32_t serialNumber_;
+  uint16_t csr1_;
+  uint16_t csr2_;
+  uint32_t eventCounter_;
+  std::array<uint16_t,4> bgo_;
+  std::array<uint16_t,4> inhibitDelay_;
+  std::array<uint16_t,4> inhibitDuration_;
+  uint32_t asyncCommands_;
+  std::vector<std::function<void()> > l1aCallbacks_;
+};
+
+// CAEN V288 CAENET controller, with the slaves attached to the CAENET line
+class SimulatedV288: public SimulatedBoard{
+public:
+  // a slave gets the frame sent by the master and returns the error code and the response data
+  typedef std::function<std::pair<uint16_t,std::vector<uint16_t> >(const std::vector<uint16_t>&)> Slave;
+
+  SimulatedV288(uint32_t baseAddress=0xF0000, uint8_t irqLevel=0);
+
+  std::string name() const override { return "V288"; }
+
+  CVErrorCodes read(uint32_t offset, uint32_t& data, CVDataWidth DW) override;
+  CVErrorCodes write(uint32_t offset, uint32_t data, CVDataWidth DW) override;
+
+  uint8_t irqLevel() const override { return irqPending_ ? irqLevel_ : 0; }
+  uint16_t iack() override;
+
+  // attach a slave at a given CAENET address
+  void attach(uint8_t address, Slave slave);
+
+  // a simple model of a CAEN N470 HV module
+  static Slave N470();
+
+private:
+  void transmit();
+
+  uint8_t irqLevel_;
+  bool irqPending_;
+  bool valid_;
+  std::vector<uint16_t> txBuffer_;
+  std::deque<uint16_t> rxBuffer_;
+  std::vector<std::pair<uint8_t,Slave> > slaves_;
+};
+
+// A VME crate filled with simulated boards.
+// Operations are serialized, like on the real bus, and the latency model is applied to each of them.
+class SimulatedCrate{
+public:
+  explicit SimulatedCrate(SimulatedLatency latency = SimulatedLatency::none());
+  ~SimulatedCrate() {}
+
+  // crate content. The crate takes ownership of the board.
+  template<class B> B* add(B* board) { add(std::unique_ptr<SimulatedBoard>(board)); return board; }
+  void add(std::unique_ptr<SimulatedBoard> board);
+
+  // fill the crate with one board of each kind, at the default addresses of the VeheMencE classes
+  void populate();
+
+  // access to boards, for direct manipulation (triggers, etc.)
+  SimulatedBoard* board(uint32_t address) const;
+  template<class B> B* board(uint32_t address) const { return dynamic_cast<B*>(board(address)); }
+
+  // latency model
+  inline void setLatency(SimulatedLatency latency) { latency_ = latency; }
+  inline SimulatedLatency getLatency() const { return latency_; }
+
+  // VME cycles. Block reads on an address decoded by no board go to the boards chained at that address (CBLT).
+  CVErrorCodes read(uint32_t address, void* data, CVAddressModifier AM, CVDataWidth DW);
+  CVErrorCodes write(uint32_t address, const void* data, CVAddressModifier AM, CVDataWidth DW);
+  CVErrorCodes readWrite(uint32_t address, void* data, CVAddressModifier AM, CVDataWidth DW);
+  CVErrorCodes blockRead(uint32_t address, unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, int* count);
+  CVErrorCodes blockWrite(uint32_t address, const unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, int* count);
+  CVErrorCodes addressOnly(uint32_t address, CVAddressModifier AM);
+
+  // lists of single cycles, sent in one go. The status of each cycle is returned in ECs.
+  CVErrorCodes multiRead(const uint32_t* addresses, uint32_t* data, int n, const CVAddressModifier* AMs, const CVDataWidth* DWs, CVErrorCodes* ECs);
+  CVErrorCodes multiWrite(const uint32_t* addresses, const uint32_t* data, int n, const CVAddressModifier* AMs, const CVDataWidth* DWs, CVErrorCodes* ECs);
+
+  // interrupts
+  CVErrorCodes IRQEnable(uint32_t mask);
+  CVErrorCodes IRQDisable(uint32_t mask);
+  CVErrorCodes IRQWait(uint32_t mask, uint32_t timeout_ms);
+  CVErrorCodes IRQCheck(unsigned char* mask);
+  CVErrorCodes IACK(CVIRQLevels level, void* vector, CVDataWidth DW);
+
+  // SYSRESET on the backplane
+  void systemReset();
+
+  // operation statistics
+  inline uint64_t cycles() const { return cycles_; }
+  inline uint64_t blockTransfers() const { return blockTransfers_; }
+  inline uint64_t bytesTransferred() const { return bytes_; }
+
+private:
+  SimulatedBoard* decode(uint32_t& address, CVAddressModifier AM) const;
+  CVErrorCodes chainedRead(uint32_t address, unsigned char* buffer, int size, CVAddressModifier AM, int* count);
+  uint8_t pendingIRQs() const;
+  void notify();
+  void spend(std::chrono::steady_clock::time_point start, double ns) const;
+
+  std::vector<std::unique_ptr<SimulatedBoard> > boards_;
+  SimulatedLatency latency_;
+  uint32_t irqMask_;
+  uint64_t cycles_;
+  uint64_t blockTransfers_;
+  uint64_t bytes_;
+  size_t chainToken_; // board of the CBLT chain holding the token
+  mutable std::recursive_mutex mutex_;
+  std::condition_variable_any irqCondition_;
+
+  friend class SimulatedBoard;
+};
+
+#endif
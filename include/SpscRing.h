@@ -0,0 +1,67 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __SPSCRING
+#define __SPSCRING
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue between one producer thread and one consumer thread.
+// push() is only called by the producer, pop() only by the consumer; neither blocks.
+template<typename T> class SpscRing{
+  public:
+    explicit SpscRing(size_t capacity):slots_(capacity+1),head_(0),tail_(0) {}
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // false if the ring is full
+    bool push(const T& value) {
+      size_t tail = tail_.load(std::memory_order_relaxed);
+      size_t next = tail+1==slots_.size() ? 0 : tail+1;
+      if(next==head_.load(std::memory_order_acquire)) return false;
+      slots_[tail] = value;
+      tail_.store(next, std::memory_order_release);
+      return true;
+    }
+    // false if the ring is empty
+    bool pop(T& value) {
+      size_t head = head_.load(std::memory_order_relaxed);
+      if(head==tail_.load(std::memory_order_acquire)) return false;
+      value = slots_[head];
+      head_.store(head+1==slots_.size() ? 0 : head+1, std::memory_order_release);
+      return true;
+    }
+
+    // approximate when called while the other thread is working
+    inline size_t size() const {
+      size_t head = head_.load(std::memory_order_acquire), tail = tail_.load(std::memory_order_acquire);
+      return tail>=head ? tail-head : tail+slots_.size()-head;
+    }
+    inline bool empty() const { return size()==0; }
+    inline size_t capacity() const { return slots_.size()-1; }
+
+  private:
+    std::vector<T> slots_;
+    // on separate cache lines: each index is written by one thread only
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+};
+
+#endif
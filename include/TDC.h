@@ -21,6 +21,7 @@
 
 #include "VmeBoard.h"
 #include "V1190Event.h"
+#include "EventBatch.h"
 #include <vector>
 #include <sstream>
 #include <bitset>
@@ -181,6 +182,20 @@ public:
     cvdt100ns = 3,
   } CVDeadTime;
   
+  // block transfers used by getEvents
+  typedef enum CVBlockTransfer {
+    cvBLT  = 0, /* D32 block transfers */
+    cvMBLT = 1, /* D64 multiplexed block transfers, events aligned to 64 bits */
+  } CVBlockTransfer;
+  
+  // position of the board in a chained block transfer (MCST/CBLT control register)
+  typedef enum CVChainPosition {
+    cvNotChained = 0,
+    cvLastBoard = 1,
+    cvFirstBoard = 2,
+    cvIntermediateBoard = 3,
+  } CVChainPosition;
+  
   // trigger window configuration
   struct WindowConfiguration {
     uint16_t width; // ns
@@ -195,14 +210,72 @@ public:
     }
   };
   
+  // register map
+  struct Registers {
+    typedef VmeRegister<0x0000, uint32_t, cvA32_U_DATA, cvReadOnly>  OutputBuffer;
+    typedef VmeRegister<0x0000, uint32_t, cvA32_U_BLT,  cvReadOnly>  OutputBufferBLT;
+    typedef VmeRegister<0x0000, uint64_t, cvA32_U_MBLT, cvReadOnly>  OutputBufferMBLT;
+    typedef VmeRegister<0x1000, uint16_t, cvA32_U_DATA, cvReadWrite> Control;
+    typedef VmeRegister<0x1002, uint16_t, cvA32_U_DATA, cvReadOnly>  Status;
+    typedef VmeRegister<0x100A, uint16_t, cvA32_U_DATA, cvReadWrite> InterruptLevel;
+    typedef VmeRegister<0x100C, uint16_t, cvA32_U_DATA, cvReadWrite> InterruptVector;
+    typedef VmeRegister<0x1010, uint16_t, cvA32_U_DATA, cvReadWrite> MCSTBaseAddress;
+    typedef VmeRegister<0x1012, uint16_t, cvA32_U_DATA, cvReadWrite> MCSTControl;
+    typedef VmeRegister<0x1014, uint16_t, cvA32_U_DATA, cvWriteOnly> ModuleReset;
+    typedef VmeRegister<0x1016, uint16_t, cvA32_U_DATA, cvWriteOnly> SoftwareClear;
+    typedef VmeRegister<0x1018, uint16_t, cvA32_U_DATA, cvWriteOnly> SoftwareEventReset;
+    typedef VmeRegister<0x101A, uint16_t, cvA32_U_DATA, cvWriteOnly> SoftwareTrigger;
+    typedef VmeRegister<0x101C, uint32_t, cvA32_U_DATA, cvReadOnly>  EventCounter;
+    typedef VmeRegister<0x101E, uint16_t, cvA32_U_DATA, cvReadWrite> GeoAddress;
+    typedef VmeRegister<0x1020, uint16_t, cvA32_U_DATA, cvReadOnly>  EventStored;
+    typedef VmeRegister<0x1022, uint16_t, cvA32_U_DATA, cvReadWrite> AlmostFullLevel;
+    typedef VmeRegister<0x1024, uint16_t, cvA32_U_DATA, cvReadWrite> BLTEventNumber;
+    typedef VmeRegister<0x1026, uint16_t, cvA32_U_DATA, cvReadOnly>  FirmwareRevision;
+    typedef VmeRegister<0x102E, uint16_t, cvA32_U_DATA, cvReadWrite> Micro;
+    typedef VmeRegister<0x1030, uint16_t, cvA32_U_DATA, cvReadOnly>  MicroHandshake;
+    typedef VmeRegister<0x1038, uint32_t, cvA32_U_DATA, cvReadOnly>  EventFIFO;
+    typedef VmeRegister<0x103C, uint16_t, cvA32_U_DATA, cvReadOnly>  EventFIFOStored;
+    typedef VmeRegister<0x103E, uint16_t, cvA32_U_DATA, cvReadOnly>  EventFIFOStatus;
+    // configuration ROM: one byte per register, most significant first
+    typedef VmeRegister<0x4024, uint16_t, cvA32_U_DATA, cvReadOnly, 3, 4> Oui;
+    typedef VmeRegister<0x4030, uint16_t, cvA32_U_DATA, cvReadOnly>       Version;
+    typedef VmeRegister<0x4034, uint16_t, cvA32_U_DATA, cvReadOnly, 3, 4> BoardId;
+    typedef VmeRegister<0x4040, uint16_t, cvA32_U_DATA, cvReadOnly, 4, 4> Revision;
+    typedef VmeRegister<0x4080, uint16_t, cvA32_U_DATA, cvReadOnly, 2, 4> SerialNumber;
+
+    typedef VmeBitField<Control, 0>             BERREnable;
+    typedef VmeBitField<Control, 4>             Align64;
+    typedef VmeBitField<Control, 5>             CompensationEnable;
+    typedef VmeBitField<Control, 8>             FIFOEnable;
+    typedef VmeBitField<Control, 9>             ExtdTriggerTimeEnable;
+    typedef VmeBitField<Status, 0>              DataReady;
+    typedef VmeBitField<Status, 1>              AlmostFull;
+    typedef VmeBitField<Status, 2>              Full;
+    typedef VmeBitField<MicroHandshake, 0>      WriteOk;
+    typedef VmeBitField<MicroHandshake, 1>      ReadOk;
+    typedef VmeBitField<EventFIFO, 16, 16>      FIFOEventCount;
+    typedef VmeBitField<EventFIFO, 0, 16>       FIFOWordCount;
+    typedef VmeBitField<EventFIFOStored, 0, 11> FIFOStoredCount;
+    typedef VmeBitField<EventFIFOStatus, 0, 2>  FIFOStatus;
+    typedef VmeBitField<MCSTBaseAddress, 0, 8>  MCSTAddress;
+    typedef VmeBitField<MCSTControl, 0, 2>      ChainPosition;
+    typedef VmeBitField<GeoAddress, 0, 5>       Geo;
+  };
+
   Tdc(VmeController* controller,uint32_t address=0x00120000);
 
+  // Policy used to wait for data in the output buffer (the board policy, used for the micro handshake, if null).
+  // An IRQAssistedWait needs the almost full interrupt to be configured.
+  inline void setDataReadyPolicy(std::shared_ptr<WaitPolicy> policy) { dataReadyPolicy_ = policy; }
+  inline std::shared_ptr<WaitPolicy> getDataReadyPolicy() const { return dataReadyPolicy_; }
+
   /////////////////////////
   //// Configuration, status, info, ...
   /////////////////////////
   
   // Get module info
   inline ModuleInfo getModuleInfo() const { return info_; }
+  inline uint32_t getBaseAddress() const { return baseAddress(); }
   
   // Reads the control register
   V1190ControlRegister getControlRegister();
@@ -214,7 +287,6 @@ public:
   void enableFIFO(bool enable);
   
   // Enables BERR
-  // note: BERR stop condition should be avoided, since this implementation would discard the last BLT read.
   void enableBERR(bool enable);
   
   // Enables Extd trigger time
@@ -222,9 +294,16 @@ public:
   
   // Enables Compensation
   void enableCompensation(bool enable);
+  
+  // Selects the block transfers of getEvents. MBLT also enables the 64 bits alignment of the events (ALIGN64).
+  // If the controller rejects the MBLT cycles (cvInvalidParam), getEvents falls back to BLT, ALIGN64 cleared.
+  void setBlockTransferMode(Tdc::CVBlockTransfer mode);
+  inline Tdc::CVBlockTransfer getBlockTransferMode() const { return blockTransfer_; }
 
   // Get the TDC status
   V1190StatusRegister getStatus();
+  // data ready bit of the status (one cycle)
+  bool isDataReady();
   
   // Program interrupt
   void setInterrupt(uint8_t level=0X0, uint16_t vector = 0xDD);
@@ -256,6 +335,19 @@ public:
   // reads the FIFO status
   uint8_t getFIFOStatus();
   
+  // set/get the GEO address, sent in the global header and trailer of the events.
+  // Only writable in crates without geographical addressing (the slot number is used otherwise).
+  void setGeoAddress(uint8_t geo);
+  uint8_t getGeoAddress();
+  
+  // set/get the number of complete events sent in one block transfer (0: no limit)
+  void setBLTEventNumber(uint8_t events);
+  uint8_t getBLTEventNumber();
+  
+  // set/get the chained block transfer configuration: bits 31-24 of the CBLT address, and position of the board in the chain
+  void setChain(uint8_t address, Tdc::CVChainPosition position);
+  std::pair<uint8_t, Tdc::CVChainPosition> getChain();
+  
   /////////////////////////
   //// Read data from the board
   /////////////////////////
@@ -265,9 +357,37 @@ public:
 
   // Gets data from TDC in trigger mode
   std::vector<V1190Event> getEvents(bool useFIFO=true);
+  // Same, appending the events to a batch of flat arrays. Returns the number of events added.
+  size_t getEvents(EventBatch& batch, bool useFIFO=true);
+  
+  // Same as getEvent/getEvents, with the cycles dispatched statically to the controller, of type C
+  // (VmeUsbBridge or VmeSimulator). Throws a CAENVMEexception if the controller is not a C.
+  template<typename C> V1190Event getEvent(bool useFIFO=true) { return readEvent(direct<C>(), useFIFO); }
+  template<typename C> std::vector<V1190Event> getEvents(bool useFIFO=true) { return readEvents(direct<C>(), useFIFO); }
+  template<typename C> size_t getEvents(EventBatch& batch, bool useFIFO=true) {
+    size_t events = batch.size();
+    waitDataReady();
+    readBuffer(direct<C>(), readout_, useFIFO);
+    decode(readout_.data<uint32_t>(), readout_.count<uint32_t>(), batch);
+    return batch.size()-events;
+  }
   
   // Gets data from TDC in countinuous mode
   TDCHit getHit();
+  
+  // Reads the output buffer into buffer (replaced) as getEvents, without waiting for data ready nor decoding.
+  // See TdcReadoutEngine for a readout in a dedicated thread.
+  void readRaw(ReadoutBuffer& buffer, bool useFIFO=true);
+  
+  // Reads up to nwords of the output buffer with one block transfer (MBLT if enabled, nwords must then be even),
+  // appended to buffer. Returns the number of words read, possibly 0 when the buffer is empty (with BERR enabled).
+  // See TdcStream for the continuous mode readout.
+  size_t readOutputBuffer(ReadoutBuffer& buffer, uint32_t nwords);
+  
+  // Decodes n words of output buffer data, and appends the complete events to output.
+  // Data split in several chunks are decoded with a V1190Decoder, which carries the partial events over.
+  static void decode(const uint32_t* data, size_t n, std::vector<V1190Event>& output);
+  static void decode(const uint32_t* data, size_t n, EventBatch& output);
 
   /////////////////////////
   //// Generic opcode methods
@@ -384,19 +504,27 @@ public:
   // The user should refer to the manual and use directly the writeOpcode and readOpcode methods.
 
 private:
-
-  //REGISTER ADRESSES (must depend on add)
-  int opcode_;
-  int statusRegister_;
-  int microHandshake_;
-  int outputBuffer_;
-  int eventFIFO_;
-  int controlRegister_;
   
   // Module info
   ModuleInfo info_;
 
+  // block transfers used by getEvents
+  CVBlockTransfer blockTransfer_;
+
+  // policy for the data ready waits (board policy if null)
+  std::shared_ptr<WaitPolicy> dataReadyPolicy_;
+
+  // persistent buffer for block readout, sized for the whole output buffer (32k words)
+  ReadoutBuffer readout_;
+
   //PRIVATE FUNCTIONS
+  // readout on a VmeController or a VmeStaticController (instantiated in TDC.cpp)
+  template<typename Bus> V1190Event readEvent(const Bus& bus, bool useFIFO);
+  template<typename Bus> std::vector<V1190Event> readEvents(const Bus& bus, bool useFIFO);
+  // block reads the output buffer into buffer (replaced), without waiting for data
+  template<typename Bus> void readBuffer(const Bus& bus, ReadoutBuffer& buffer, bool useFIFO);
+  // one block transfer, falling back from MBLT to BLT if needed. Throws on errors other than BERR.
+  template<typename Bus> VmeTransfer blockRead(const Bus& bus, ReadoutBuffer& buffer, uint32_t nwords);
   void waitWrite();
   void waitRead();
   void waitDataReady();
@@ -28,6 +28,38 @@ class TtcVi:public VmeBoard{
   
 public:  
   
+  // register map
+  struct Registers {
+    typedef VmeRegister<0x80, uint16_t, cvA32_U_DATA, cvReadWrite, 1, 2, 0x0070> CSR1; ///< L1A FIFO status and reset are volatile
+    typedef VmeRegister<0x82, uint16_t, cvA32_U_DATA, cvReadWrite>       CSR2;
+    typedef VmeRegister<0x84, uint16_t, cvA32_U_DATA, cvWriteOnly>       ModuleReset;
+    typedef VmeRegister<0x86, uint16_t, cvA32_U_DATA, cvWriteOnly>       SoftwareL1A;
+    typedef VmeRegister<0x88, uint16_t, cvA32_U_DATA, cvReadWrite>       EventCounterMSW;
+    typedef VmeRegister<0x8A, uint16_t, cvA32_U_DATA, cvReadWrite>       EventCounterLSW;
+    typedef VmeRegister<0x8B, uint16_t, cvA32_U_DATA, cvWriteOnly>       ShortAsyncCycle;
+    typedef VmeRegister<0x8C, uint16_t, cvA32_U_DATA, cvWriteOnly>       ResetCounter;
+    typedef VmeRegister<0x90, uint16_t, cvA32_U_DATA, cvReadWrite, 4, 8> BGoMode;
+    typedef VmeRegister<0x92, uint16_t, cvA32_U_DATA, cvReadWrite, 4, 8> InhibitDelay;
+    typedef VmeRegister<0x94, uint16_t, cvA32_U_DATA, cvReadWrite, 4, 8> InhibitDuration;
+    typedef VmeRegister<0x96, uint16_t, cvA32_U_DATA, cvWriteOnly, 4, 8> BGoTrigger;
+    typedef VmeRegister<0xC0, uint16_t, cvA32_U_DATA, cvWriteOnly>       LongAsyncCycleMSW;
+    typedef VmeRegister<0xC2, uint16_t, cvA32_U_DATA, cvWriteOnly>       LongAsyncCycleLSW;
+    // configuration EEPROM: one byte per register, most significant first
+    typedef VmeRegister<0x26, uint16_t, cvA32_U_DATA, cvReadOnly, 3, 4>  Manufacturer;
+    typedef VmeRegister<0x32, uint16_t, cvA32_U_DATA, cvReadOnly, 4, 4>  SerialNumber;
+    typedef VmeRegister<0x42, uint16_t, cvA32_U_DATA, cvReadOnly, 4, 4>  Revision;
+
+    typedef VmeBitField<CSR1, 0, 3>        TriggerSelect;
+    typedef VmeBitField<CSR1, 4, 2>        L1FIFOStatus;
+    typedef VmeBitField<CSR1, 6>           ResetL1FIFO;
+    typedef VmeBitField<CSR1, 8, 4>        BC0Delay;
+    typedef VmeBitField<CSR1, 12, 3>       RandomRate;
+    typedef VmeBitField<CSR1, 15>          OrbitCount;
+    typedef VmeBitField<BGoMode, 0, 4>     BGoFlags;
+    typedef VmeBitField<InhibitDelay, 0, 12>   Delay;
+    typedef VmeBitField<InhibitDuration, 0, 8> Duration;
+  };
+
   TtcVi(VmeController* controller,int address=0x555500);
 
   typedef enum CVTriggerChannel {
@@ -0,0 +1,67 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __TDCCHAIN
+#define __TDCCHAIN
+
+#include "TDC.h"
+#include <array>
+
+// Readout of several V1190 in one chained block transfer (CBLT).
+// The boards pass a token to each other, from the first to the last of the chain, each one sending its complete events.
+// The last board ends the transfer with a bus error. A single board is read with plain block transfers. The stream is then split per board, from the GEO address of the events.
+class TdcChain{
+  public:
+    // address: bits 31-24 of the CBLT address, to be shared by the boards of the chain only
+    TdcChain(const VmeController* controller, uint8_t address=0xAA);
+    ~TdcChain() {}
+
+    // adds a board at the end of the chain. Boards must be added in the order of the slots.
+    // Each board must have its own GEO address (see Tdc::setGeoAddress).
+    void add(Tdc* board);
+
+    // boards of the chain
+    inline size_t boards() const { return boards_.size(); }
+    inline Tdc* board(size_t i) const { return boards_.at(i); }
+    inline uint32_t address() const { return uint32_t(address_)<<24; }
+
+    // maximum size of one block transfer, in 32 bits words. A chain readout continues until the bus error.
+    inline void setTransferSize(int words) { transferSize_ = words; }
+    inline int getTransferSize() const { return transferSize_; }
+
+    // reads all boards and returns their events, in the order of the chain
+    std::vector<std::vector<V1190Event> > getEvents();
+
+    // reads all boards, appending the raw data to the buffer. Returns the number of 32 bits words read.
+    // The readout stops if the chain is not ended by a bus error, or after the size of the output buffers of the boards.
+    size_t readout(ReadoutBuffer& buffer) const;
+
+    // splits the data per board, from the GEO address of the global headers
+    std::vector<std::vector<V1190Event> > decode(const uint32_t* data, size_t n) const;
+
+  private:
+    static const size_t outputBufferWords = 32768; // size of the output buffer of a V1190
+    const VmeController* cont_;
+    uint8_t address_;
+    std::vector<Tdc*> boards_;
+    std::array<int8_t,32> positions_; // position in the chain of the board with a given GEO address (-1 if none)
+    int transferSize_;
+    ReadoutBuffer readout_;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __TDCREADOUTENGINE
+#define __TDCREADOUTENGINE
+
+#include "TDC.h"
+#include "SpscRing.h"
+#include "WaitPolicy.h"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Readout of a Tdc in a dedicated thread, into a fixed set of pre-allocated buffers handed over to one consumer
+// thread (decoding, writing...) through lock-free single producer/single consumer rings: the block transfers of the
+// next events overlap with the processing of the previous ones. When the consumer does not keep up, all buffers are
+// in use and the readout stalls (the board buffer fills up instead); stallTime() measures it.
+// The Tdc must not be used by other threads while the engine runs.
+class TdcReadoutEngine{
+  public:
+    // one readout of the output buffer (complete events, as Tdc::getEvents)
+    struct Block {
+      ReadoutBuffer data;
+      uint64_t sequence;  ///< number of the block since start()
+      uint64_t timestamp; ///< end of the transfer, ns since the epoch (system clock)
+    };
+
+    // buffers: number of blocks, each sized for the whole output buffer. policy: how the readout thread waits for
+    // data (BackoffWait from 10 us to 1 ms if null).
+    explicit TdcReadoutEngine(Tdc* tdc, unsigned buffers=8, bool useFIFO=true, std::shared_ptr<WaitPolicy> policy=nullptr);
+    TdcReadoutEngine(const TdcReadoutEngine&) = delete;
+    TdcReadoutEngine& operator=(const TdcReadoutEngine&) = delete;
+    ~TdcReadoutEngine();
+
+    // starts/stops the readout thread. After stop(), the blocks already read are still delivered by next().
+    // start() requires all blocks to be released.
+    void start();
+    void stop();
+    inline bool running() const { return thread_.joinable() && !finished_.load(); }
+
+    // Consumer side, from a single thread. next() waits for the next block, and returns null once the engine is
+    // stopped and all blocks are delivered. A failure of the readout thread stops it, and is rethrown by next().
+    // Each block is given back with release(), in any order.
+    const Block* next();
+    // null if no block is ready
+    const Block* tryNext();
+    void release(const Block* block);
+
+    // statistics since start(): blocks and bytes read, time spent on the bus, and waiting for a free buffer (s)
+    inline uint64_t blocks() const { return blocks_.load(); }
+    inline uint64_t bytes() const { return bytes_.load(); }
+    inline double busTime() const { return busTime_.load()*1e-9; }
+    inline double stallTime() const { return stallTime_.load()*1e-9; }
+
+  private:
+    void run();
+
+    Tdc* tdc_;
+    bool useFIFO_;
+    std::shared_ptr<WaitPolicy> policy_;
+    std::vector<std::unique_ptr<Block> > storage_;
+    SpscRing<Block*> free_;  // consumer -> readout thread
+    SpscRing<Block*> full_;  // readout thread -> consumer
+    std::atomic<bool> stop_;
+    std::atomic<bool> finished_;
+    std::exception_ptr error_;
+    std::atomic<uint64_t> blocks_, bytes_, busTime_, stallTime_;
+    std::thread thread_;
+};
+
+#endif
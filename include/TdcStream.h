@@ -0,0 +1,98 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __TDCSTREAM
+#define __TDCSTREAM
+
+#include "TDC.h"
+#include <array>
+#include <iterator>
+#include <vector>
+
+// Readout of a Tdc in continuous storage mode. The output buffer is drained with block transfers (instead of a
+// status poll and a D32 cycle per hit with getHit) into a ring of hits, which are pulled one by one, in bulk, or
+// with an iterator. The 19 bits measurements are unwrapped into 64 bits timestamps, in TDC LSB units, from the time
+// order of the hits of each TDC chip: a hit going back by more than half the range started a new rollover period.
+// BERR should be enabled (otherwise the fillers sent when the buffer is empty are read, and skipped).
+class TdcStream
+{
+public:
+  struct Hit {
+    uint64_t time;   // unwrapped measurement
+    uint8_t channel;
+    uint8_t edge;    // 0: leading, 1: trailing
+  };
+  
+  // capacity: number of hits of the ring
+  explicit TdcStream(Tdc* tdc, size_t capacity=65536);
+  
+  // Reads what the board has, up to the free space of the ring, with one block transfer. Returns the number of
+  // hits added to the ring.
+  size_t fill();
+  
+  // Next hit, reading the board if the ring is empty. Returns false if there is no data.
+  bool next(Hit& hit);
+  // Up to max hits, reading the board once if the ring is empty. Returns the number of hits.
+  size_t read(Hit* hits, size_t max);
+  
+  // hits in the ring
+  inline size_t available() const { return size_; }
+  inline size_t capacity() const { return ring_.size(); }
+  // TDC error words and fillers read since the construction
+  inline uint64_t errors() const { return errors_; }
+  inline uint64_t fillers() const { return fillers_; }
+  
+  // Restarts the unwrapping (e.g. after a reset of the board) and drops the hits of the ring
+  void reset();
+  
+  // input iterator over the hits, until the board has no more data: for(const TdcStream::Hit& hit: stream) ...
+  class iterator {
+  public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef Hit value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Hit* pointer;
+    typedef const Hit& reference;
+    explicit iterator(TdcStream* stream=nullptr):stream_(stream) { ++*this; }
+    inline reference operator*() const { return hit_; }
+    inline pointer operator->() const { return &hit_; }
+    inline iterator& operator++() { if(stream_ && !stream_->next(hit_)) stream_ = nullptr; return *this; }
+    inline bool operator==(const iterator& other) const { return stream_==other.stream_; }
+    inline bool operator!=(const iterator& other) const { return stream_!=other.stream_; }
+  private:
+    TdcStream* stream_;
+    Hit hit_;
+  };
+  inline iterator begin() { return iterator(this); }
+  inline iterator end() { return iterator(); }
+  
+private:
+  // converts the words of buffer_ into hits at the end of the ring
+  void unpack();
+  
+  Tdc* tdc_;
+  ReadoutBuffer buffer_;
+  std::vector<Hit> ring_;
+  size_t head_, size_; // first hit, number of hits
+  // unwrapping, per TDC chip: latest timestamp
+  std::array<uint64_t,4> latest_;
+  std::array<bool,4> started_;
+  uint64_t errors_, fillers_;
+};
+
+#endif // __TDCSTREAM
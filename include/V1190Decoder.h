@@ -0,0 +1,148 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __V1190DECODER
+#define __V1190DECODER
+
+#include "V1190Event.h"
+#include "V1190Kernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Incremental decoder of the V1190 output buffer data.
+// The words can be given in chunks of any size (single cycles, block transfer chunks, file records): an event may
+// span several chunks, the decoder keeps its state in between. The decoder itself holds no data and never allocates:
+// each word is handed to a Sink, which stores it where the caller wants. A Sink provides
+//   void globalHeader(uint32_t word);         // start of an event
+//   void extendedTriggerTime(uint32_t word);
+//   void tdcHeader(uint32_t word);
+//   void hit(uint32_t word, bool tdc);        // measurement, inside a TDC header/trailer pair or not
+//   void tdcError(uint32_t word);
+//   void tdcTrailer(uint32_t word);
+//   void globalTrailer(uint32_t word);        // end of the event
+// and optionally
+//   void hitRun(const uint32_t* words, size_t n, bool tdc);
+// which then receives the runs of consecutive measurements at once, found with the V1190Kernels (SIMD).
+class V1190Decoder
+{
+public:
+  V1190Decoder():inEvent_(false), inTDC_(false), words_(0), events_(0), skipped_(0) {}
+  
+  // Decodes n words. Returns the number of events completed (global trailers) in these words.
+  template<typename Sink> size_t decode(const uint32_t* data, size_t n, Sink& sink);
+  
+  // Drops the partial event, e.g. after a readout error. The next words are skipped until a global header.
+  inline void reset() { inEvent_ = false; inTDC_ = false; }
+  // True if an event has been started and not completed
+  inline bool inEvent() const { return inEvent_; }
+  
+  // Statistics since the construction: words decoded, events completed, words skipped outside of an event
+  inline uint64_t words() const { return words_; }
+  inline uint64_t events() const { return events_; }
+  inline uint64_t skipped() const { return skipped_; }
+  
+private:
+  template<typename Sink, typename = void> struct hasHitRun : std::false_type {};
+  template<typename Sink> struct hasHitRun<Sink, decltype(std::declval<Sink&>().hitRun(static_cast<const uint32_t*>(nullptr), size_t(0), false))>
+    : std::true_type {};
+  
+  bool inEvent_, inTDC_;
+  uint64_t words_, events_, skipped_;
+};
+
+template<typename Sink> size_t V1190Decoder::decode(const uint32_t* data, size_t n, Sink& sink) {
+  size_t completed = 0;
+  for(size_t i=0; i<n; ++i) {
+    uint32_t word = data[i];
+    uint32_t type = word>>27;
+    if(type==0x8) { // global header, even if the previous event had no trailer
+      sink.globalHeader(word);
+      inEvent_ = true;
+      inTDC_ = false;
+      continue;
+    }
+    if(!inEvent_) {
+      if(type!=0x18) ++skipped_;
+      continue;
+    }
+    switch(type) {
+      case 0x0: // measurement
+        if constexpr(hasHitRun<Sink>::value) {
+          size_t run = V1190Kernels::hitRun(data+i, n-i);
+          sink.hitRun(data+i, run, inTDC_);
+          i += run-1;
+        } else {
+          sink.hit(word, inTDC_);
+        }
+        break;
+      case 0x1: // TDC header
+        sink.tdcHeader(word);
+        inTDC_ = true;
+        break;
+      case 0x3: // TDC trailer
+        sink.tdcTrailer(word);
+        inTDC_ = false;
+        break;
+      case 0x4: // TDC error
+        sink.tdcError(word);
+        break;
+      case 0x11: // extended trigger time
+        sink.extendedTriggerTime(word);
+        break;
+      case 0x10: // global trailer
+        sink.globalTrailer(word);
+        inEvent_ = false;
+        ++completed;
+        break;
+      default: // filler
+        break;
+    }
+  }
+  words_ += n;
+  events_ += completed;
+  return completed;
+}
+
+// Sink building V1190Event objects, appended to a vector of the caller when complete. The event being decoded stays
+// in the sink (across chunks), and the TDC blocks are moved into their event, not copied.
+class V1190EventSink
+{
+public:
+  explicit V1190EventSink(std::vector<V1190Event>& output):output_(&output) {}
+  
+  inline void globalHeader(uint32_t word) { event_ = V1190Event(word); }
+  inline void extendedTriggerTime(uint32_t word) { event_.setExtdTriggerTime(word); }
+  inline void tdcHeader(uint32_t word) { tdc_ = TDCEvent(word); }
+  inline void hit(uint32_t word, bool tdc) { if(tdc) tdc_.addHit(TDCHit(word)); else event_.addHit(TDCHit(word)); }
+  inline void tdcError(uint32_t word) { tdc_.setErrorFlags(word); }
+  inline void tdcTrailer(uint32_t) { event_.addTDCEvent(std::move(tdc_)); }
+  inline void globalTrailer(uint32_t word) { event_.setStatus((word>>24)&0x7); output_->push_back(std::move(event_)); }
+  
+  // Changes the vector receiving the next complete events
+  inline void setOutput(std::vector<V1190Event>& output) { output_ = &output; }
+  
+private:
+  std::vector<V1190Event>* output_;
+  V1190Event event_;
+  TDCEvent tdc_;
+};
+
+#endif // __V1190DECODER
@@ -2,6 +2,7 @@
 #define __V1190EVENT_H
 
 #include <iostream>
+#include <utility>
 #include <vector>
 
 class TDCHit
@@ -88,6 +89,7 @@ public:
   
   inline void addHit(TDCHit hit) { hits_.push_back(hit); }
   inline void addTDCEvent(TDCEvent &tdc) { tdcevents_.push_back(tdc); }
+  inline void addTDCEvent(TDCEvent &&tdc) { tdcevents_.push_back(std::move(tdc)); }
   
   std::string toString() const;
   
@@ -0,0 +1,48 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __V1190KERNELS
+#define __V1190KERNELS
+
+#include <cstddef>
+#include <cstdint>
+
+// Bulk processing of V1190 output buffer words, vectorized with AVX2 or SSE4.2 when the CPU supports it (chosen at
+// run time, the scalar version otherwise). Used by the V1190Decoder for the runs of measurement words.
+class V1190Kernels
+{
+public:
+  enum CVInstructionSet {cvScalar = 0, cvSSE42 = 1, cvAVX2 = 2};
+  
+  // instruction set in use: the best supported one, unless changed by select() (e.g. to compare them)
+  static CVInstructionSet active();
+  static bool supported(CVInstructionSet set);
+  // returns false, and keeps the current one, if the set is not supported
+  static bool select(CVInstructionSet set);
+  
+  // word type (bits 31-27) of n words
+  static void classify(const uint32_t* data, size_t n, uint8_t* types);
+  // number of measurement words at the start of data
+  static size_t hitRun(const uint32_t* data, size_t n);
+  // fields of n measurement words
+  static void extractHits(const uint32_t* data, size_t n, uint8_t* channels, uint32_t* measurements, uint8_t* edges);
+  // positions of the global headers and trailers, at most max. Returns the number found.
+  static size_t findBoundaries(const uint32_t* data, size_t n, uint32_t* positions, size_t max);
+};
+
+#endif // __V1190KERNELS
@@ -0,0 +1,127 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMEASYNCQUEUE
+#define __VMEASYNCQUEUE
+
+#include "CommonDef.h"
+#include "VmeController.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <thread>
+
+// One request of the asynchronous queue, as seen by its completion callback.
+struct VmeRequest {
+  enum CVRequestType { cvRead, cvWrite, cvBlockRead, cvBlockWrite, cvIRQWait };
+
+  CVRequestType type;
+  uint32_t address;
+  uint32_t data;            ///< data to write, data read back, or IRQ mask (pending IRQs when completed)
+  CVAddressModifier AM;
+  CVDataWidth DW;
+  unsigned char* buffer;    ///< block transfers: memory owned by the caller, valid until completion
+  int size;                 ///< block transfers: size in bytes. IRQ wait: timeout in ms
+  bool multiplex;
+  int count;                ///< block transfers: bytes transferred, also on failure (BERR at the end of the data)
+  CVErrorCodes status;      ///< outcome of the request
+};
+
+// Asynchronous front end to a VmeController.
+// Requests are posted from any thread to a lock-free queue, and executed by a single I/O thread that owns the bus.
+// Consecutive single reads (or writes) are merged into one multi-cycle transaction.
+// IRQ waits do not block the queue: pending IRQs are polled between transactions.
+// Completion callbacks are called from the I/O thread, and should return quickly.
+class VmeAsyncQueue{
+  public:
+    typedef std::function<void(const VmeRequest&)> Callback;
+
+    explicit VmeAsyncQueue(const VmeController* controller);
+    VmeAsyncQueue(const VmeAsyncQueue&) = delete;
+    VmeAsyncQueue& operator=(const VmeAsyncQueue&) = delete;
+    ~VmeAsyncQueue(); ///< executes the requests still queued, then stops the I/O thread
+
+    // requests with a completion callback
+    void read(uint32_t address, CVAddressModifier AM, CVDataWidth DW, Callback callback);
+    void write(uint32_t address, uint32_t data, CVAddressModifier AM, CVDataWidth DW, Callback callback);
+    void blockRead(uint32_t address, unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, bool multiplex, Callback callback);
+    void blockWrite(uint32_t address, const unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, bool multiplex, Callback callback);
+    void IRQWait(uint32_t mask, uint32_t timeout_ms, Callback callback);
+
+    // requests with a future. Failures are reported as a CAENVMEexception when getting the result.
+    std::future<uint32_t> read(uint32_t address, CVAddressModifier AM, CVDataWidth DW);
+    std::future<void> write(uint32_t address, uint32_t data, CVAddressModifier AM, CVDataWidth DW);
+    std::future<int> blockRead(uint32_t address, unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false); ///< bytes read, up to the BERR if any
+    std::future<int> blockWrite(uint32_t address, const unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false); ///< bytes written
+    std::future<uint32_t> IRQWait(uint32_t mask, uint32_t timeout_ms); ///< pending IRQs
+
+    // statistics
+    inline uint64_t requests() const { return requests_; }
+    inline uint64_t transactions() const { return transactions_; }
+
+  private:
+    // node of the intrusive multi-producer single-consumer queue
+    struct Node {
+      std::atomic<Node*> next;
+      VmeRequest request;
+      Callback callback;
+    };
+    // pending IRQ wait
+    struct IRQWaiter {
+      Node* node;
+      std::chrono::steady_clock::time_point deadline;
+    };
+
+    void post(const VmeRequest& request, Callback callback);
+    Node* pop();
+    bool empty() const;
+    void run();
+    void execute(std::vector<Node*>& nodes);
+    void executeCycles(std::vector<Node*>& nodes, size_t first, size_t last, bool read);
+    void executeBlock(Node* node);
+    void checkIRQs(bool wait);
+    void complete(Node* node);
+
+    const VmeController* controller_;
+
+    // queue: producers push at head_, the I/O thread pops at tail_
+    std::atomic<Node*> head_;
+    Node* tail_;
+    Node* stub_;
+
+    // to put the I/O thread to sleep when there is nothing to do
+    std::atomic<bool> sleeping_;
+    std::atomic<bool> stop_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+
+    // owned by the I/O thread
+    std::vector<Node*> nodes_;
+    std::vector<VmeCycle> cycles_;
+    std::list<IRQWaiter> irqWaiters_;
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> transactions_;
+
+    std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMEBLOCKPIPELINE
+#define __VMEBLOCKPIPELINE
+
+#include "CommonDef.h"
+#include "VmeController.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Large block reads split in chunks, transferred by a worker thread ahead of their processing:
+// while the caller copies or decodes one chunk, the next ones are already on the bus.
+class VmeBlockPipeline{
+  public:
+    // processing of one chunk, called in the thread of read()
+    typedef std::function<void(const ReadoutBuffer& chunk)> Consumer;
+
+    // chunkSize in bytes. depth: number of chunks transferred ahead of the one being processed.
+    explicit VmeBlockPipeline(const VmeController* controller, int chunkSize=0x10000, unsigned depth=2);
+    VmeBlockPipeline(const VmeBlockPipeline&) = delete;
+    VmeBlockPipeline& operator=(const VmeBlockPipeline&) = delete;
+    ~VmeBlockPipeline();
+
+    // size of the chunks, in bytes (not during a read)
+    void setChunkSize(int bytes);
+    inline int getChunkSize() const { return chunkSize_; }
+
+    // Reads up to size bytes at address, and gives the chunks in order to the consumer.
+    // Chunks are read at increasing addresses, or all at the same address for a FIFO (output buffer of a board...).
+    // The read stops after the first incomplete chunk (end of data, bus error): one more chunk may have been
+    // requested in the meantime, so reading past the end must be harmless.
+    // Other failures are rethrown once the chunks read before have been processed. Returns the number of bytes read.
+    size_t read(uint32_t address, size_t size, CVAddressModifier AM, CVDataWidth DW, bool fifo, Consumer consumer, bool multiplex=false);
+
+    // time spent by the last read waiting for the bus (s). Close to zero when the transfers are hidden behind the processing.
+    inline double waitTime() const { return waitTime_; }
+
+  private:
+    struct Slot {
+      ReadoutBuffer buffer;
+      CVErrorCodes status;
+    };
+
+    void run();
+    bool transferPending() const;
+
+    const VmeController* controller_;
+    int chunkSize_;
+    std::vector<Slot> slots_;
+
+    // current read
+    uint32_t address_;
+    size_t size_;
+    CVAddressModifier AM_;
+    CVDataWidth DW_;
+    bool fifo_;
+    bool multiplex_;
+    size_t issued_;   // chunks transferred
+    size_t consumed_; // chunks processed
+    bool active_;
+    bool finished_;   // no more chunks to transfer
+    bool busy_;       // a chunk is being transferred
+    double waitTime_;
+
+    bool stop_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::thread worker_;
+};
+
+#endif
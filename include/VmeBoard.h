@@ -22,6 +22,17 @@
 #include "CommonDef.h"
 #include "CAENVMEtypes.h"
 #include "VmeController.h"
+#include "VmeStaticController.h"
+#include "WaitPolicy.h"
+#include <memory>
+#include <unordered_map>
+
+// how a board keeps the content of a register (see VmeBoard::setCachePolicy)
+typedef enum CVCachePolicy {
+  cvVolatile     = 0, /* always read on the bus (default) */
+  cvWriteThrough = 1, /* written on the bus and in the cache, read from the cache once known */
+  cvReadOnce     = 2, /* read once on the bus, then from the cache, even after a reset (identification, constants) */
+} CVCachePolicy;
 
 // a generic VME board
 class VmeBoard{
@@ -34,6 +45,24 @@ public:
   // If set to true, the mode will be enforced for all VME operations, disregarding the VmeController configuration.
   inline void enforceAMDW(bool enforce) { enforceAMDW_ = enforce; }
   inline bool isAMDWenforced() { return enforceAMDW_; }
+
+  // How the board waits for a status polled on the bus (busy polling by default).
+  // The policy can be shared between boards, and collects the statistics of their waits.
+  inline void setWaitPolicy(std::shared_ptr<WaitPolicy> policy) { waitPolicy_ = policy; }
+  inline std::shared_ptr<WaitPolicy> getWaitPolicy() const { return waitPolicy_; }
+
+  // Shadow cache of the registers (disabled by default).
+  // When enabled, the reads of registers with a caching policy cost no bus cycle once their content is known.
+  // The cache only sees the accesses made through the board: disable it if another master writes the registers.
+  inline void enableCache(bool enable) { cache_ = enable; }
+  inline bool isCacheEnabled() const { return cache_; }
+  // forget the cached content (reset of the board). The read-once registers are kept.
+  void invalidateCache() const;
+  // caching policy of a register (of all the registers of a set)
+  template<typename R> void setCachePolicy(CVCachePolicy policy) {
+    static_assert(R::readable, "write-only registers are always shadowed");
+    for(unsigned i=0;i<R::count;++i) registers_[R::address(baseAddress_,i)].policy = policy;
+  }
   
 protected:
   // access to the VME controller. If AMDW is enforced, the returned object is ready.
@@ -58,19 +87,177 @@ protected:
   template<typename T> std::vector<T> blockReadData(const long unsigned int address, int size, bool multiplex=false) const { 
     return controller()->blockReadData<T>(address, size, multiplex); 
   }
-  template<typename T> int blockWriteData(const long unsigned int address, std::vector<T> data, bool multiplex=false) const {
+  template<typename T> int blockWriteData(const long unsigned int address, const std::vector<T>& data, bool multiplex=false) const {
     return controller()->blockWriteData(address, data, multiplex); 
   }
+  template<typename T> int blockReadData(const long unsigned int address, T* buffer, int size, bool multiplex=false) const { 
+    return controller()->blockReadData(address, buffer, size, multiplex); 
+  }
+  template<typename T> int blockWriteData(const long unsigned int address, const T* buffer, int size, bool multiplex=false) const {
+    return controller()->blockWriteData(address, buffer, size, multiplex); 
+  }
+  template<typename T> int blockReadData(const long unsigned int address, ReadoutBuffer& buffer, int size, bool multiplex=false) const { 
+    return controller()->blockReadData<T>(address, buffer, size, multiplex); 
+  }
   inline void ADOCycle(const long unsigned int address) const {
     controller()->ADOCycle(address);
   }
 
+  // the controller, without temporary mode
+  inline const VmeController& bus() const { return *cont_; }
+
+  // the controller with statically dispatched cycles. C must be its actual type.
+  template<typename C> VmeStaticController<C> direct() const {
+    const C* controller = dynamic_cast<const C*>(cont_);
+    if(!controller) throw_with_trace(CAENVMEexception(cvInvalidParam));
+    return VmeStaticController<C>(controller);
+  }
+
+  // access to the registers of the board map (see VmeRegister.h), with the mode of the register.
+  // With the cache enabled, registers with volatile bits are still read on the bus (use readField).
+  template<typename R> typename R::type read(unsigned index=0) const {
+    if constexpr(R::volatileMask==0) {
+      return cachedRead<R>(index);
+    } else {
+      typename R::type data = cont_->read<R>(baseAddress_, index);
+      if(cache_) refresh(R::address(baseAddress_,index), data & ~R::volatileMask);
+      return data;
+    }
+  }
+  template<typename R> void write(typename R::type data, unsigned index=0) const {
+    cont_->write<R>(baseAddress_, data, index);
+    Shadow& shadow = registers_[R::address(baseAddress_,index)];
+    shadow.value = data & ~R::volatileMask;
+    shadow.known = true;
+  }
+  // a field (see VmeBitField), from the cache unless it has volatile bits
+  template<typename F> typename F::type readField(unsigned index=0) const {
+    typedef typename F::register_type R;
+    if constexpr((F::mask & R::volatileMask)==0) return F::get(cachedRead<R>(index));
+    else return F::get(read<R>(index));
+  }
+  // last content written in a write-only register (zero if never written)
+  template<typename R> typename R::type written(unsigned index=0) const {
+    static_assert(!R::readable, "readable register: use read");
+    auto shadow = registers_.find(R::address(baseAddress_,index));
+    return (shadow==registers_.end() || !shadow->second.known) ? 0 : typename R::type(shadow->second.value);
+  }
+  template<typename R> int blockRead(ReadoutBuffer& buffer, int size, bool multiplex=false) const {
+    return cont_->blockRead<R>(baseAddress_, buffer, size, multiplex);
+  }
+  // update of the bits of mask in a register, the other ones being kept. Returns the new content of the register.
+  // The last content written through the board is known: the update is then a single read-modify-write cycle, which
+  // returns the previous content. If the other bits were not as expected (register changed behind the board), the
+  // cycle is repeated with them. Until then, the register holds the word built from the known content: if another
+  // master changed it, it briefly has wrong values for the other bits (even with the cache disabled).
+  // Write-only registers are written from their known content (zero if never written).
+  // The volatile bits of the register are not compared, and written as zero unless they are in mask.
+  template<typename R> typename R::type update(typename R::type mask, typename R::type bits, unsigned index=0) const;
+  // set a field (see VmeBitField) to value (all ones by default), or to zero
+  template<typename F> void setField(typename F::type value=typename F::type(~0u), unsigned index=0) const {
+    update<typename F::register_type>(F::mask, F::set(0,value), index);
+  }
+  template<typename F> void clearField(unsigned index=0) const {
+    update<typename F::register_type>(F::mask, 0, index);
+  }
+  // all the registers of a set, in one transaction
+  template<typename R> std::array<typename R::type, R::count> readAll() const {
+    VmeBatch cycles(cont_,R::AM,R::DW);
+    for(unsigned i=0;i<R::count;++i) cycles.read<R>(baseAddress_, i);
+    cycles.flush();
+    std::array<typename R::type, R::count> output;
+    for(unsigned i=0;i<R::count;++i) output[i] = cycles[i];
+    return output;
+  }
+  template<typename R> void writeAll(typename R::type data) const {
+    VmeBatch cycles(cont_,R::AM,R::DW);
+    for(unsigned i=0;i<R::count;++i) cycles.write<R>(baseAddress_, data, i);
+    cycles.flush();
+    for(unsigned i=0;i<R::count;++i) {
+      Shadow& shadow = registers_[R::address(baseAddress_,i)];
+      shadow.value = data & ~R::volatileMask;
+      shadow.known = true;
+    }
+  }
+
+  // wait until ready() returns true, using the board wait policy
+  inline void waitFor(const std::function<bool()>& ready) const {
+    waitPolicy_->wait(ready);
+  }
+
+  // a list of cycles, using the board mode if enforced (the controller one otherwise).
+  inline VmeBatch batch() const {
+    return enforceAMDW_ ? VmeBatch(cont_,AM_,DW_) : VmeBatch(cont_,cont_->getAM(),cont_->getDW());
+  }
+
 private:
   VmeController* cont_;  ///< Pointer to the controller
   CVAddressModifier AM_; ///< Stored AM value
   CVDataWidth DW_;       ///< Stored DW value
   bool enforceAMDW_;     ///< Should the mode be enforced ?
   uint32_t baseAddress_; ///< The base address of the board
+  std::shared_ptr<WaitPolicy> waitPolicy_; ///< How to wait for the board
+
+  // content of a register known by the board: last written (used by update), or read with a caching policy
+  struct Shadow {
+    CVCachePolicy policy = cvVolatile;
+    bool known = false;
+    uint64_t value = 0;
+  };
+  mutable std::unordered_map<uint32_t,Shadow> registers_; ///< Shadows of the registers, by address
+  bool cache_;                                            ///< Are the reads served from the shadows ?
+
+  // read through the cache. The volatile bits are not kept.
+  template<typename R> typename R::type cachedRead(unsigned index) const {
+    if(!cache_) return cont_->read<R>(baseAddress_, index);
+    auto shadow = registers_.find(R::address(baseAddress_,index));
+    if(shadow==registers_.end() || shadow->second.policy==cvVolatile) return cont_->read<R>(baseAddress_, index);
+    if(!shadow->second.known) {
+      shadow->second.value = cont_->read<R>(baseAddress_, index) & ~R::volatileMask;
+      shadow->second.known = true;
+    }
+    return typename R::type(shadow->second.value);
+  }
+  inline void refresh(uint32_t address, uint64_t value) const {
+    auto shadow = registers_.find(address);
+    if(shadow!=registers_.end() && shadow->second.policy!=cvVolatile) {
+      shadow->second.value = value;
+      shadow->second.known = true;
+    }
+  }
 };
 
+template<typename R> typename R::type VmeBoard::update(typename R::type mask, typename R::type bits, unsigned index) const {
+  typedef typename R::type T;
+  static_assert(R::writable, "read-only register");
+  const uint32_t address = R::address(baseAddress_,index);
+  const T stable = T(~R::volatileMask);
+  bits &= mask;
+  auto shadow = registers_.find(address);
+  const bool known = shadow!=registers_.end() && shadow->second.known;
+  if constexpr(!R::readable) {
+    T word = ((known ? T(shadow->second.value) : T(0)) & stable & ~mask) | bits;
+    write<R>(word, index);
+    return word;
+  } else {
+    T expected = (known ? T(shadow->second.value) : cont_->read<R>(baseAddress_,index)) & stable;
+    T others = expected;
+    for(int attempt=0; attempt<8; ++attempt) {
+      T word = (others & ~mask) | bits;
+      T previous = cont_->readWrite<R>(baseAddress_, word, index) & stable;
+      if(((previous^expected) & ~mask)==0) {
+        Shadow& updated = registers_[address];
+        updated.value = word & stable;
+        updated.known = true;
+        return word;
+      }
+      // the register was not as expected: write again, keeping its actual bits
+      others = previous;
+      expected = word & stable;
+    }
+    LOG_ERROR("Register at " + int_to_hex(address) + " keeps changing: cannot update it");
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+}
+
 #endif
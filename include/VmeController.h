@@ -21,15 +21,44 @@
 
 #include "CommonDef.h"
 #include "CAENVMEtypes.h"
+#include "ReadoutBuffer.h"
+#include "VmeRegister.h"
+#include <array>
+#include <cassert>
+#include <atomic>
 #include <tuple>
+#include <vector>
+
+// One single cycle of a list, with its own mode.
+struct VmeCycle {
+  uint32_t address;
+  uint32_t data;            ///< data to write, or data read back
+  CVAddressModifier AM;
+  CVDataWidth DW;
+  CVErrorCodes status;      ///< outcome of the cycle, once executed
+};
+
+// Outcome of a non-throwing block transfer (try* methods): status, and number of bytes transferred, also when the
+// transfer failed (e.g. on the bus error which ends the data of a board).
+struct VmeTransfer {
+  CVErrorCodes status;
+  int bytes;
+  inline bool ok() const { return status==cvSuccess; }
+};
+
+class VmeBatch;
 
 // Main controller virtual class.
 class VmeController{
   public:
     VmeController();
+    VmeController(const VmeController& other);
+    VmeController& operator=(const VmeController& other);
     virtual ~VmeController() {}
     
-    // Address modifier and Data width
+    // Address modifier and Data width.
+    // The temporary mode set by mode() is kept per thread, and applies to the next operation of that thread only:
+    // several threads can share a controller, each cycle being sent with the mode requested by its own thread.
     virtual void setMode(const CVAddressModifier AM, const CVDataWidth DW);///<Sets default modes.
     virtual const VmeController* mode(const CVAddressModifier AM, const CVDataWidth DW) const;///<Sets temp mode
     virtual CVAddressModifier getAM() const;///<Gets default mode
@@ -37,38 +66,139 @@ class VmeController{
     virtual void setAM(CVAddressModifier AM);///<Sets default modes.
     virtual void setDW(CVDataWidth DW);///<Sets default modes.
   
-    // VME BUS operations
+    // VME BUS operations. A CAENVMEexception is thrown on failure: see the try* methods for the non-throwing ones.
     template<typename T> void writeData(long unsigned int address,T data) const {
       static_assert(!std::is_pointer<T>::value,"writeData argument is the data, not a pointer to it");
-      writeDataImpl(address,&data);
+      checkCAENVMEexception(tryWriteData(address,data));
     }
     template<typename T> T    readData (long unsigned int address) const {
       T data;
-      readDataImpl(address,&data);
+      checkCAENVMEexception(tryReadData(address,data));
       return data;
     }
     template<typename T> T    readWriteData(const long unsigned int address,T data) const {
-      readWriteDataImpl(address,&data);
+      auto [AM, DW] = useMode();
+      checkCAENVMEexception(readWriteDataImpl(address,&data,AM,DW));
       return data;
     }
     template<typename T> std::vector<T> blockReadData(const long unsigned int address, int size, bool multiplex=false) const {
-      size_t sizeoft = sizeof(T);
       std::vector<T> output(size);
-      void* buffer = output.data();
-      int count = 0;
-      blockReadDataImpl(address, (unsigned char*)buffer, size*sizeoft , &count, multiplex);
-      output.resize(count);
+      output.resize(blockReadData(address, output.data(), size, multiplex));
       return output;
     }
-    template<typename T> int blockWriteData(const long unsigned int address, std::vector<T> data, bool multiplex=false) const {
-      size_t sizeoft = sizeof(T);
-      void* buffer = data.data();
-      int count = 0;
-      blockWriteDataImpl(address,(unsigned char *)buffer, data.size()*sizeoft, &count, multiplex);
-      return count;
+    template<typename T> int blockWriteData(const long unsigned int address, const std::vector<T>& data, bool multiplex=false) const {
+      return blockWriteData(address, data.data(), data.size(), multiplex);
+    }
+
+    // block transfers from/to memory owned by the caller (no copy, no allocation).
+    // size and returned count are in number of T elements.
+    template<typename T> int blockReadData(const long unsigned int address, T* buffer, int size, bool multiplex=false) const {
+      VmeTransfer transfer = tryBlockReadData(address, buffer, size, multiplex);
+      checkCAENVMEexception(transfer.status);
+      return transfer.bytes/sizeof(T);
+    }
+    template<typename T> int blockWriteData(const long unsigned int address, const T* buffer, int size, bool multiplex=false) const {
+      VmeTransfer transfer = tryBlockWriteData(address, buffer, size, multiplex);
+      checkCAENVMEexception(transfer.status);
+      return transfer.bytes/sizeof(T);
+    }
+
+    // block read of size T elements, appended to the data already in the buffer.
+    // If the transfer fails (e.g. bus error at the end of the data), what was transferred is kept in the buffer.
+    template<typename T> int blockReadData(const long unsigned int address, ReadoutBuffer& buffer, int size, bool multiplex=false) const {
+      VmeTransfer transfer = tryBlockReadData<T>(address, buffer, size, multiplex);
+      checkCAENVMEexception(transfer.status);
+      return transfer.bytes/sizeof(T);
     }
     void ADOCycle(const long unsigned int address) const{
-      ADOCycleImpl(address);
+      checkCAENVMEexception(ADOCycleImpl(address,std::get<0>(useMode())));
+    }
+
+    // Non-throwing variants: the status is returned, for the readout loops where a failure is expected (bus error at
+    // the end of the data) and an exception, with its stack trace, would be too costly.
+    template<typename T> CVErrorCodes tryWriteData(long unsigned int address, T data) const {
+      auto [AM, DW] = useMode();
+      return writeDataImpl(address,&data,AM,DW);
+    }
+    template<typename T> CVErrorCodes tryReadData(long unsigned int address, T& data) const {
+      auto [AM, DW] = useMode();
+      return readDataImpl(address,&data,AM,DW);
+    }
+    template<typename T> VmeTransfer tryBlockReadData(const long unsigned int address, T* buffer, int size, bool multiplex=false) const {
+      int count = 0;
+      auto [AM, DW] = useMode();
+      CVErrorCodes status = blockReadDataImpl(address, reinterpret_cast<unsigned char*>(buffer), size*sizeof(T), &count, AM, DW, multiplex);
+      return VmeTransfer{status, count};
+    }
+    template<typename T> VmeTransfer tryBlockWriteData(const long unsigned int address, const T* buffer, int size, bool multiplex=false) const {
+      int count = 0;
+      auto [AM, DW] = useMode();
+      // the CAEN library does not take const buffers, but does not modify them.
+      CVErrorCodes status = blockWriteDataImpl(address, reinterpret_cast<unsigned char*>(const_cast<T*>(buffer)), size*sizeof(T), &count, AM, DW, multiplex);
+      return VmeTransfer{status, count};
+    }
+    template<typename T> VmeTransfer tryBlockReadData(const long unsigned int address, ReadoutBuffer& buffer, int size, bool multiplex=false) const {
+      size_t offset = buffer.size();
+      buffer.reserve(offset+size*sizeof(T));
+      int count = 0;
+      auto [AM, DW] = useMode();
+      CVErrorCodes status = blockReadDataImpl(address, buffer.data<unsigned char>()+offset, size*sizeof(T), &count, AM, DW, multiplex);
+      buffer.resize(offset+count);
+      return VmeTransfer{status, count};
+    }
+
+    // access to registers described at compile time (see VmeRegister.h), with the mode of the register.
+    // index selects one register of a set.
+    template<typename R> typename R::type read(uint32_t base, unsigned index=0) const {
+      typename R::type data;
+      checkCAENVMEexception(tryRead<R>(base,data,index));
+      return data;
+    }
+    template<typename R> void write(uint32_t base, typename R::type data, unsigned index=0) const {
+      checkCAENVMEexception(tryWrite<R>(base,data,index));
+    }
+    // read-modify-write cycle: writes data and returns the previous content, in a single bus transaction
+    template<typename R> typename R::type readWrite(uint32_t base, typename R::type data, unsigned index=0) const {
+      static_assert(R::access==cvReadWrite, "read-modify-write of a read-only or write-only register");
+      assert(index<R::count);
+      checkCAENVMEexception(readWriteDataImpl(R::address(base,index),&data,R::AM,R::DW));
+      return data;
+    }
+    // block read of size elements from a register (FIFO, output buffer...), appended to the buffer (kept on failure)
+    template<typename R> int blockRead(uint32_t base, ReadoutBuffer& buffer, int size, bool multiplex=false) const {
+      VmeTransfer transfer = tryBlockRead<R>(base, buffer, size, multiplex);
+      checkCAENVMEexception(transfer.status);
+      return transfer.bytes/sizeof(typename R::type);
+    }
+    // non-throwing variants
+    template<typename R> CVErrorCodes tryRead(uint32_t base, typename R::type& data, unsigned index=0) const {
+      static_assert(R::readable, "write-only register");
+      assert(index<R::count);
+      return readDataImpl(R::address(base,index),&data,R::AM,R::DW);
+    }
+    template<typename R> CVErrorCodes tryWrite(uint32_t base, typename R::type data, unsigned index=0) const {
+      static_assert(R::writable, "read-only register");
+      assert(index<R::count);
+      return writeDataImpl(R::address(base,index),&data,R::AM,R::DW);
+    }
+    template<typename R> VmeTransfer tryBlockRead(uint32_t base, ReadoutBuffer& buffer, int size, bool multiplex=false) const {
+      static_assert(R::readable, "write-only register");
+      typedef typename R::type T;
+      size_t offset = buffer.size();
+      buffer.reserve(offset+size*sizeof(T));
+      int count = 0;
+      CVErrorCodes status = blockReadDataImpl(R::address(base), buffer.data<unsigned char>()+offset, size*sizeof(T), &count, R::AM, R::DW, multiplex);
+      buffer.resize(offset+count);
+      return VmeTransfer{status, count};
+    }
+
+    // lists of single cycles, each with its own mode, sent in one transaction when the controller supports it.
+    // An exception is thrown if one of the cycles failed. The status of each cycle is stored in the list.
+    void multiRead(std::vector<VmeCycle>& cycles) const {
+      if(cycles.size()) checkCAENVMEexception(multiReadImpl(cycles.data(),cycles.size()));
+    }
+    void multiWrite(std::vector<VmeCycle>& cycles) const {
+      if(cycles.size()) checkCAENVMEexception(multiWriteImpl(cycles.data(),cycles.size()));
     }
     
     // IRQ operations
@@ -82,19 +212,75 @@ class VmeController{
     virtual std::tuple<CVAddressModifier,CVDataWidth> useMode() const;///< more than a getter: it "consumes" the tmp mode.
     
   private:
-    CVAddressModifier AM_;
-    CVDataWidth DW_;
-    mutable CVAddressModifier AMtmp_;
-    mutable CVDataWidth DWtmp_;
+    std::atomic<CVAddressModifier> AM_;
+    std::atomic<CVDataWidth> DW_;
 
     // actual implementation with C-like type erasure (type unsafe, but the CAEN lib is anyway C.
     // not needed for ADOCycle, but we keep it here for consistency
-    virtual void writeDataImpl(long unsigned int address,void* data) const = 0;
-    virtual void readDataImpl(long unsigned int address,void* data) const = 0;
-    virtual void readWriteDataImpl(const long unsigned int address,void* data) const = 0;
-    virtual void blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, bool multiplex=false) const = 0;
-    virtual void blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, bool multiplex=false) const = 0;
-    virtual void ADOCycleImpl(const long unsigned int address) const = 0;
+    // Each cycle comes with its own mode: implementations must not rely on the controller state.
+    // They return the status of the cycle instead of throwing (the public methods throw), and *count is the number
+    // of bytes transferred even on failure.
+    virtual CVErrorCodes writeDataImpl(long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const = 0;
+    virtual CVErrorCodes readDataImpl(long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const = 0;
+    virtual CVErrorCodes readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const = 0;
+    virtual CVErrorCodes blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const = 0;
+    virtual CVErrorCodes blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const = 0;
+    virtual CVErrorCodes ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const = 0;
+
+    // by default, lists are executed as successive single cycles. The status of each cycle is stored in the list,
+    // the first failure is returned.
+    virtual CVErrorCodes multiReadImpl(VmeCycle* cycles, int n) const;
+    virtual CVErrorCodes multiWriteImpl(VmeCycle* cycles, int n) const;
+
+    friend class VmeBatch;
+    friend class VmeTracer;
+    friend class VmeRecorder;
+};
+
+// Helper to queue reads and writes, and to send them with as few transactions as possible.
+// Cycles are executed in order when flushed: each run of consecutive reads (or writes) is one transaction.
+class VmeBatch{
+  public:
+    VmeBatch(const VmeController* controller, CVAddressModifier AM, CVDataWidth DW);
+    ~VmeBatch() {}
+
+    // queue a cycle with the default mode of the batch, or with its own mode.
+    // read returns the index of the cycle, to retrieve the data after flush.
+    inline size_t read(uint32_t address) { return read(address,AM_,DW_); }
+    size_t read(uint32_t address, CVAddressModifier AM, CVDataWidth DW);
+    inline void write(uint32_t address, uint32_t data) { write(address,data,AM_,DW_); }
+    void write(uint32_t address, uint32_t data, CVAddressModifier AM, CVDataWidth DW);
+
+    // queue a cycle on a register described at compile time, with the mode of the register
+    template<typename R> size_t read(uint32_t base, unsigned index=0) {
+      static_assert(R::readable, "write-only register");
+      assert(index<R::count);
+      return read(R::address(base,index),R::AM,R::DW);
+    }
+    template<typename R> void write(uint32_t base, typename R::type data, unsigned index=0) {
+      static_assert(R::writable, "read-only register");
+      assert(index<R::count);
+      write(R::address(base,index),data,R::AM,R::DW);
+    }
+
+    // execute the cycles queued since the last flush
+    void flush();
+
+    // data of one cycle (available after flush)
+    inline uint32_t operator[](size_t i) const { return cycles_.at(i).data; }
+    inline const VmeCycle& cycle(size_t i) const { return cycles_.at(i); }
+    inline size_t size() const { return cycles_.size(); }
+
+    // forget all cycles
+    void clear();
+
+  private:
+    const VmeController* controller_;
+    CVAddressModifier AM_;
+    CVDataWidth DW_;
+    std::vector<VmeCycle> cycles_;
+    std::vector<bool> reads_;
+    size_t flushed_;
 };
 
 #endif
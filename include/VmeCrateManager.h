@@ -0,0 +1,81 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMECRATEMANAGER
+#define __VMECRATEMANAGER
+
+#include "CommonDef.h"
+#include "VmeController.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Reads several crates in parallel, one thread per crate.
+// Each crate has its own controller (e.g. one VmeUsbBridge per optical link), so that the crates do not wait for each other.
+class VmeCrateManager{
+  public:
+    // readout of one crate: called in a loop by the thread of the crate. Returns the number of events read.
+    typedef std::function<size_t()> Readout;
+
+    VmeCrateManager();
+    VmeCrateManager(const VmeCrateManager&) = delete;
+    VmeCrateManager& operator=(const VmeCrateManager&) = delete;
+    ~VmeCrateManager();
+
+    // adds a crate (before start). Returns its index.
+    size_t add(const std::string& name, const VmeController* controller, Readout readout);
+
+    // starts the readout threads
+    void start();
+
+    // stops and joins the readout threads.
+    // If a readout failed, its exception is rethrown (the other crates are stopped as well).
+    void stop();
+
+    // true while all crates are being read
+    inline bool running() const { return running_ && !failed_; }
+
+    // crates
+    inline size_t crates() const { return crates_.size(); }
+    inline const std::string& name(size_t crate) const { return crates_.at(crate)->name; }
+    inline const VmeController* controller(size_t crate) const { return crates_.at(crate)->controller; }
+
+    // number of events read, per crate or in total
+    inline uint64_t events(size_t crate) const { return crates_.at(crate)->events; }
+    uint64_t events() const;
+
+  private:
+    struct Crate {
+      std::string name;
+      const VmeController* controller;
+      Readout readout;
+      std::atomic<uint64_t> events;
+      std::exception_ptr error;
+      std::thread thread;
+    };
+
+    void run(Crate& crate);
+
+    std::vector<std::unique_ptr<Crate> > crates_;
+    std::atomic<bool> running_;
+    std::atomic<bool> failed_;
+};
+
+#endif
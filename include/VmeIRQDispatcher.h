@@ -0,0 +1,75 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMEIRQDISPATCHER
+#define __VMEIRQDISPATCHER
+
+#include "CommonDef.h"
+#include "VmeController.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Interrupt-driven readout: waits for VME interrupts in its own thread, acknowledges them
+// and calls the handler registered for the level and vector (e.g. the block readout of the board).
+// Between interrupts, the thread sleeps in IRQWait and the bus is left idle.
+// Boards with release on register access (RORA, like the V1190) keep the line asserted until the handler has read them out.
+class VmeIRQDispatcher{
+  public:
+    // handler, called from the dispatcher thread with the level (1-7) and vector of the interrupt
+    typedef std::function<void(uint8_t level, uint16_t vector)> Handler;
+
+    // IRQWait is called with the given timeout, which bounds the time needed to stop the dispatcher.
+    // IACK cycles are done with the given data width (D8 for the usual 8-bit vectors).
+    explicit VmeIRQDispatcher(const VmeController* controller, uint32_t timeout_ms=100, CVDataWidth iackWidth=cvD8);
+    VmeIRQDispatcher(const VmeIRQDispatcher&) = delete;
+    VmeIRQDispatcher& operator=(const VmeIRQDispatcher&) = delete;
+    ~VmeIRQDispatcher();
+
+    // register a handler for a level (1-7) and vector, as programmed in the board (e.g. Tdc::setInterrupt).
+    // Can be done while running.
+    void registerHandler(uint8_t level, uint16_t vector, Handler handler);
+    void unregisterHandler(uint8_t level, uint16_t vector);
+
+    // start and stop the dispatcher thread. The registered levels are enabled on the controller while running.
+    void start();
+    void stop();
+    inline bool running() const { return running_; }
+
+    // statistics
+    inline uint64_t interrupts() const { return interrupts_; }
+    inline uint64_t unhandled() const { return unhandled_; }
+
+  private:
+    void run();
+    uint32_t levels() const;
+
+    const VmeController* controller_;
+    uint32_t timeout_ms_;
+    CVDataWidth iackWidth_;
+    std::map<std::pair<uint8_t,uint16_t>, Handler> handlers_;
+    mutable std::mutex mutex_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> interrupts_;
+    std::atomic<uint64_t> unhandled_;
+    std::thread thread_;
+};
+
+#endif
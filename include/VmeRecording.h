@@ -0,0 +1,161 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMERECORDING
+#define __VMERECORDING
+
+#include "CommonDef.h"
+#include "VmeController.h"
+#include "VmeTracer.h"
+#include <chrono>
+#include <fstream>
+#include <mutex>
+
+// Binary recording of a session: a VmeRecordingHeader, then for each operation a VmeRecordEntry
+// followed by its payload (block read data, results of lists).
+struct VmeRecordingHeader {
+  char magic[8];            ///< "VMEREC01"
+  uint32_t AM;              ///< default mode of the recorded controller
+  uint32_t DW;
+};
+
+struct VmeRecordEntry {
+  uint64_t start;           ///< ns since the start of the recording
+  uint32_t duration;        ///< ns
+  uint32_t address;         ///< first address for lists, IRQ mask or level for IRQ operations
+  uint32_t data;            ///< single cycles: data written or read. IRQ check, IACK: result. IRQ wait: timeout
+  uint32_t length;          ///< block transfers: bytes transferred (stored for reads). Lists: cycles (data and status stored for reads, status for writes)
+  uint32_t thread;          ///< index of the calling thread
+  uint8_t type;             ///< VmeTraceRecord::CVTraceType
+  uint8_t AM;
+  uint8_t DW;
+  int8_t status;            ///< CVErrorCodes
+};
+
+// Decorator writing all the bus traffic done through it to a file, before forwarding it to the actual controller.
+// Block read data and the results of lists are stored, so that the session can be replayed by a VmeReplayer.
+class VmeRecorder: public VmeController{
+public:
+  VmeRecorder(const VmeController* controller, const std::string& filename);
+  VmeRecorder(const VmeRecorder&) = delete;
+  VmeRecorder& operator=(const VmeRecorder&) = delete;
+  ~VmeRecorder();
+
+  void close(); ///< flush and close the file. Operations are then forwarded without being recorded.
+  inline uint64_t entries() const { return entries_; }
+
+  /* Interupts */
+  void IRQEnable(uint32_t mask) const override;
+  void IRQDisable(uint32_t mask) const override;
+  void IRQWait(uint32_t mask, uint32_t timeout_ms) const override;
+  unsigned char IRQCheck() const override;
+  uint16_t IACK(CVIRQLevels Level) const override;
+
+private:
+  const VmeController* controller_;
+  std::chrono::steady_clock::time_point origin_;
+  mutable std::mutex mutex_;
+  mutable std::ofstream file_;
+  mutable uint64_t entries_;
+
+  void save(VmeRecordEntry& entry, std::chrono::steady_clock::time_point start, const void* payload) const;
+
+  // run op, and record it with its outcome: the status it returns (data cycles), or the exception it throws, which is
+  // rethrown. Once op is done, even if it failed, result fills the entry and returns its payload (entry.length bytes).
+  template<typename F, typename R> auto capture(VmeRecordEntry entry, F op, R result) const -> decltype(op()) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+      if constexpr(std::is_void<decltype(op())>::value) {
+        op();
+        entry.status = cvSuccess;
+        save(entry, start, result(entry));
+      } else {
+        CVErrorCodes status = op();
+        entry.status = status;
+        save(entry, start, result(entry));
+        return status;
+      }
+    } catch(CAENVMEexception& e) {
+      entry.status = e.errorcode();
+      save(entry, start, result(entry));
+      throw;
+    }
+  }
+  template<typename F> auto capture(const VmeRecordEntry& entry, F op) const -> decltype(op()) {
+    return capture(entry, op, [](VmeRecordEntry&) -> const void* { return nullptr; });
+  }
+
+  /* VME data cycles */
+  CVErrorCodes writeDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readDataImpl (const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const override;
+  CVErrorCodes multiReadImpl(VmeCycle* cycles, int n) const override;
+  CVErrorCodes multiWriteImpl(VmeCycle* cycles, int n) const override;
+};
+
+// Controller playing back a recording made with a VmeRecorder, to run the board classes offline.
+// Operations must come in the recorded order, to the same addresses: a diverging session throws a CAENVMEexception.
+// Recorded failures (bus errors ending block transfers, IRQ timeouts...) are thrown again.
+// The replay goes as fast as possible, or with the original timing of each operation.
+class VmeReplayer: public VmeController{
+public:
+  explicit VmeReplayer(const std::string& filename, bool originalTiming = false);
+  ~VmeReplayer() {}
+
+  inline void setOriginalTiming(bool originalTiming) { originalTiming_ = originalTiming; }
+  inline bool isOriginalTiming() const { return originalTiming_; }
+
+  void rewind(); ///< restart from the first operation
+  inline uint64_t replayed() const { return replayed_; }
+  inline bool done() const { return offset_==recording_.size(); }
+
+  /* Interupts */
+  void IRQEnable(uint32_t mask) const override;
+  void IRQDisable(uint32_t mask) const override;
+  void IRQWait(uint32_t mask, uint32_t timeout_ms) const override;
+  unsigned char IRQCheck() const override;
+  uint16_t IACK(CVIRQLevels Level) const override;
+
+private:
+  std::vector<unsigned char> recording_;
+  bool originalTiming_;
+  mutable std::mutex mutex_;
+  mutable size_t offset_;
+  mutable uint64_t replayed_;
+  mutable std::chrono::steady_clock::time_point origin_;
+
+  // next entry, that must match the operation. payload points to its payload.
+  VmeRecordEntry next(uint8_t type, uint32_t address, const unsigned char** payload = nullptr) const;
+  // wait until the end of the operation in the original timing, and return the recorded status
+  CVErrorCodes complete(const VmeRecordEntry& entry) const;
+
+  /* VME data cycles */
+  CVErrorCodes writeDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readDataImpl (const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const override;
+  CVErrorCodes multiReadImpl(VmeCycle* cycles, int n) const override;
+  CVErrorCodes multiWriteImpl(VmeCycle* cycles, int n) const override;
+};
+
+#endif
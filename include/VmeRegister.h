@@ -0,0 +1,76 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMEREGISTER
+#define __VMEREGISTER
+
+#include "CAENVMEtypes.h"
+#include <cstdint>
+
+// access rights of a register
+typedef enum CVRegisterAccess {
+  cvReadOnly  = 1,
+  cvWriteOnly = 2,
+  cvReadWrite = 3,
+} CVRegisterAccess;
+
+// data width of a register, from its C++ type
+template<typename T> struct VmeDataWidth;
+template<> struct VmeDataWidth<uint8_t>  { static constexpr CVDataWidth value = cvD8;  };
+template<> struct VmeDataWidth<uint16_t> { static constexpr CVDataWidth value = cvD16; };
+template<> struct VmeDataWidth<uint32_t> { static constexpr CVDataWidth value = cvD32; };
+template<> struct VmeDataWidth<uint64_t> { static constexpr CVDataWidth value = cvD64; };
+
+// Register of a board, described at compile time: offset from the base address, type (thus data width),
+// address modifier and access rights. Count>1 describes a set of identical registers (e.g. one per channel),
+// Stride bytes apart. Volatile masks the bits which change by themselves (status bits, self-clearing commands):
+// the field updates of VmeBoard neither compare nor restore them.
+// VmeController, VmeBatch and VmeBoard have read<R>/write<R> methods using this description, so that the
+// mode of each cycle is fixed at compile time and forbidden accesses do not compile.
+template<uint32_t Offset, typename T, CVAddressModifier Modifier, CVRegisterAccess Access, unsigned Count=1, uint32_t Stride=sizeof(T), uint64_t Volatile=0>
+struct VmeRegister {
+  typedef T type;
+  static constexpr uint32_t offset = Offset;
+  static constexpr CVAddressModifier AM = Modifier;
+  static constexpr CVDataWidth DW = VmeDataWidth<T>::value;
+  static constexpr CVRegisterAccess access = Access;
+  static constexpr unsigned count = Count;
+  static constexpr uint32_t stride = Stride;
+  static constexpr T volatileMask = T(Volatile);
+  static constexpr bool readable = Access & cvReadOnly;
+  static constexpr bool writable = Access & cvWriteOnly;
+
+  static constexpr uint32_t address(uint32_t base, unsigned index=0) { return base+Offset+index*Stride; }
+};
+
+// Field of Width bits, starting at bit Shift, in a register.
+template<typename Register, unsigned Shift, unsigned Width=1>
+struct VmeBitField {
+  typedef Register register_type;
+  typedef typename Register::type type;
+  static constexpr unsigned shift = Shift;
+  static_assert(Shift+Width<=8*sizeof(type), "bit field outside of the register");
+  static constexpr type mask = type(((uint64_t(1)<<Width)-1)<<Shift);
+
+  // value of the field in a register word
+  static constexpr type get(type word) { return (word&mask)>>Shift; }
+  // register word with the field set to value
+  static constexpr type set(type word, type value) { return (word&~mask) | ((value<<Shift)&mask); }
+};
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMESIMULATOR
+#define __VMESIMULATOR
+
+#include "CommonDef.h"
+#include "VmeController.h"
+#include "SimulatedCrate.h"
+
+// Controller connected to an in-memory crate of simulated boards.
+// Allows to develop and benchmark without hardware.
+class VmeSimulator final: public VmeController{
+public:
+  explicit VmeSimulator(SimulatedLatency latency = SimulatedLatency::none(), bool populate = true);
+  ~VmeSimulator() {}
+
+  // the simulated crate, to add boards or act on their front panel
+  inline SimulatedCrate& crate() { return crate_; }
+
+  /* System reset */
+  void systemReset();
+
+  /* Interupts */
+  void IRQEnable(uint32_t mask) const override;
+  void IRQDisable(uint32_t mask) const override;
+  void IRQWait(uint32_t mask, uint32_t timeout_ms) const override;
+  unsigned char IRQCheck() const override;
+  uint16_t IACK(CVIRQLevels Level) const override;
+
+private:
+  mutable SimulatedCrate crate_;
+
+  template<typename C> friend class VmeStaticController;
+
+  /* VME data cycles */
+  CVErrorCodes writeDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readDataImpl (const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const override;
+  CVErrorCodes multiReadImpl(VmeCycle* cycles, int n) const override;
+  CVErrorCodes multiWriteImpl(VmeCycle* cycles, int n) const override;
+};
+
+#endif
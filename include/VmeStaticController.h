@@ -0,0 +1,89 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMESTATICCONTROLLER
+#define __VMESTATICCONTROLLER
+
+#include "VmeController.h"
+
+// Statically dispatched access to a controller of known type C (VmeUsbBridge, VmeSimulator), for hot readout loops.
+// Cycles go directly to the implementation of C: no virtual call, no temporary mode.
+// It has the same register accessors as VmeController, so that code templated on the bus works with both.
+template<typename C> class VmeStaticController{
+  public:
+    explicit VmeStaticController(const C* controller):controller_(controller) {}
+
+    inline const C* controller() const { return controller_; }
+
+    template<typename R> typename R::type read(uint32_t base, unsigned index=0) const {
+      typename R::type data;
+      checkCAENVMEexception(tryRead<R>(base,data,index));
+      return data;
+    }
+    template<typename R> void write(uint32_t base, typename R::type data, unsigned index=0) const {
+      checkCAENVMEexception(tryWrite<R>(base,data,index));
+    }
+    template<typename R> typename R::type readWrite(uint32_t base, typename R::type data, unsigned index=0) const {
+      static_assert(R::access==cvReadWrite, "read-modify-write of a read-only or write-only register");
+      assert(index<R::count);
+      checkCAENVMEexception(controller_->C::readWriteDataImpl(R::address(base,index),&data,R::AM,R::DW));
+      return data;
+    }
+    template<typename R> int blockRead(uint32_t base, ReadoutBuffer& buffer, int size, bool multiplex=false) const {
+      VmeTransfer transfer = tryBlockRead<R>(base, buffer, size, multiplex);
+      checkCAENVMEexception(transfer.status);
+      return transfer.bytes/sizeof(typename R::type);
+    }
+
+    // non-throwing variants
+    template<typename R> CVErrorCodes tryRead(uint32_t base, typename R::type& data, unsigned index=0) const {
+      static_assert(R::readable, "write-only register");
+      assert(index<R::count);
+      return controller_->C::readDataImpl(R::address(base,index),&data,R::AM,R::DW);
+    }
+    template<typename R> CVErrorCodes tryWrite(uint32_t base, typename R::type data, unsigned index=0) const {
+      static_assert(R::writable, "read-only register");
+      assert(index<R::count);
+      return controller_->C::writeDataImpl(R::address(base,index),&data,R::AM,R::DW);
+    }
+    template<typename R> VmeTransfer tryBlockRead(uint32_t base, ReadoutBuffer& buffer, int size, bool multiplex=false) const {
+      static_assert(R::readable, "write-only register");
+      typedef typename R::type T;
+      size_t offset = buffer.size();
+      buffer.reserve(offset+size*sizeof(T));
+      int count = 0;
+      CVErrorCodes status = controller_->C::blockReadDataImpl(R::address(base), buffer.data<unsigned char>()+offset, size*sizeof(T), &count, R::AM, R::DW, multiplex);
+      buffer.resize(offset+count);
+      return VmeTransfer{status, count};
+    }
+
+    // single cycles with an explicit mode
+    template<typename T> T readData(uint32_t address, CVAddressModifier AM, CVDataWidth DW) const {
+      T data;
+      checkCAENVMEexception(controller_->C::readDataImpl(address,&data,AM,DW));
+      return data;
+    }
+    template<typename T> void writeData(uint32_t address, T data, CVAddressModifier AM, CVDataWidth DW) const {
+      checkCAENVMEexception(controller_->C::writeDataImpl(address,&data,AM,DW));
+    }
+
+  private:
+    const C* controller_;
+};
+
+#endif
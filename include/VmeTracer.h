@@ -0,0 +1,170 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __VMETRACER
+#define __VMETRACER
+
+#include "CommonDef.h"
+#include "VmeController.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+// One traced bus operation.
+struct VmeTraceRecord {
+  enum CVTraceType { cvRead, cvWrite, cvReadWrite, cvBlockRead, cvBlockWrite, cvADO, cvMultiRead, cvMultiWrite,
+                     cvIRQEnable, cvIRQDisable, cvIRQWait, cvIRQCheck, cvIACK };
+
+  uint64_t start;           ///< ns since the creation of the tracer
+  uint32_t duration;        ///< ns
+  uint32_t address;         ///< first address for lists, IRQ mask or level for IRQ operations
+  uint32_t size;            ///< bytes transferred (number of cycles for lists)
+  uint32_t thread;          ///< index of the calling thread
+  CVAddressModifier AM;
+  CVDataWidth DW;
+  CVErrorCodes status;
+  uint8_t type;             ///< CVTraceType
+  uint8_t board;            ///< index of the board owning the address (0 if none)
+
+  static const char* typeName(uint8_t type);
+};
+
+// Latency histogram of the operations of one board, with bins of powers of 2 ns.
+struct VmeLatencyHistogram {
+  static const int nbins = 32;  ///< bin i counts durations in [2^i, 2^(i+1)[ ns
+
+  std::string board;
+  uint64_t count;
+  uint64_t total;               ///< ns
+  uint32_t min;                 ///< ns
+  uint32_t max;                 ///< ns
+  std::vector<uint64_t> bins;
+
+  inline double mean() const { return count ? double(total)/count : 0.; }
+  std::string toString() const;
+};
+
+// Decorator recording every bus operation done through it, before forwarding it to the actual controller.
+// Boards are created on the tracer instead of the controller. Operations are attributed to a board from their
+// address, using the ranges given to registerBoard.
+// Records go to a lock-free ring buffer (the oldest ones are overwritten), that can be exported as a
+// Chrome/Perfetto trace (one track per board). Latency histograms are accumulated for all operations.
+class VmeTracer: public VmeController{
+public:
+  explicit VmeTracer(const VmeController* controller, size_t capacity = 1<<16);
+  VmeTracer(const VmeTracer&) = delete;
+  VmeTracer& operator=(const VmeTracer&) = delete;
+  ~VmeTracer() {}
+
+  // attribute the operations in [baseAddress, baseAddress+size[ to a board
+  void registerBoard(const std::string& name, uint32_t baseAddress, uint32_t size);
+
+  // recording can be paused
+  inline void enable(bool enable) { enabled_ = enable; }
+  inline bool isEnabled() const { return enabled_; }
+  void clear(); ///< forget records and histograms. Should not be called while tracing.
+
+  // records still in the ring buffer, oldest first
+  std::vector<VmeTraceRecord> records() const;
+  inline uint64_t recorded() const { return head_; } ///< operations recorded since the last clear, including overwritten ones
+
+  // Chrome trace event format, to be opened with ui.perfetto.dev or chrome://tracing
+  void writeChromeTrace(const std::string& filename) const;
+
+  // latency histograms, per board
+  VmeLatencyHistogram histogram(const std::string& board) const;
+  std::vector<VmeLatencyHistogram> histograms() const; ///< boards with at least one operation
+
+  /* Interupts */
+  void IRQEnable(uint32_t mask) const override;
+  void IRQDisable(uint32_t mask) const override;
+  void IRQWait(uint32_t mask, uint32_t timeout_ms) const override;
+  unsigned char IRQCheck() const override;
+  uint16_t IACK(CVIRQLevels Level) const override;
+
+private:
+  static const uint8_t maxBoards = 64;
+
+  struct Board {
+    std::string name;
+    uint32_t first;
+    uint32_t last;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total;
+    std::atomic<uint32_t> min;
+    std::atomic<uint32_t> max;
+    std::atomic<uint64_t> bins[VmeLatencyHistogram::nbins];
+  };
+
+  // ring slot, with a sequence number to detect slots being written while read
+  struct Slot {
+    std::atomic<uint64_t> sequence;
+    VmeTraceRecord record;
+  };
+
+  const VmeController* controller_;
+  std::chrono::steady_clock::time_point origin_;
+  std::atomic<bool> enabled_;
+
+  size_t mask_;
+  std::unique_ptr<Slot[]> ring_;
+  mutable std::atomic<uint64_t> head_;
+
+  std::mutex boardsMutex_; ///< for registration only
+  std::unique_ptr<Board[]> boards_;
+  std::atomic<uint8_t> nboards_;
+
+  uint8_t boardOf(uint32_t address) const;
+  void record(uint8_t type, uint32_t address, int size, CVAddressModifier AM, CVDataWidth DW, CVErrorCodes status,
+              std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point stop, bool addressed) const;
+  VmeLatencyHistogram histogram(uint8_t board) const;
+
+  // run op, and record it with its duration and outcome. Exceptions are recorded and rethrown.
+  // op either returns its status (data cycles) or throws (interrupts)
+  template<typename F> auto trace(uint8_t type, uint32_t address, const int& size, CVAddressModifier AM, CVDataWidth DW,
+                                  bool addressed, F op) const -> decltype(op()) {
+    if(!enabled_) return op();
+    auto start = std::chrono::steady_clock::now();
+    try {
+      if constexpr(std::is_void<decltype(op())>::value) {
+        op();
+        record(type, address, size, AM, DW, cvSuccess, start, std::chrono::steady_clock::now(), addressed);
+      } else {
+        CVErrorCodes status = op();
+        record(type, address, size, AM, DW, status, start, std::chrono::steady_clock::now(), addressed);
+        return status;
+      }
+    } catch(CAENVMEexception& e) {
+      record(type, address, size, AM, DW, (CVErrorCodes)e.errorcode(), start, std::chrono::steady_clock::now(), addressed);
+      throw;
+    }
+  }
+
+  /* VME data cycles */
+  CVErrorCodes writeDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readDataImpl (const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const override;
+  CVErrorCodes multiReadImpl(VmeCycle* cycles, int n) const override;
+  CVErrorCodes multiWriteImpl(VmeCycle* cycles, int n) const override;
+};
+
+#endif
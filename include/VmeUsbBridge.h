@@ -19,7 +19,9 @@
 #ifndef __UsbVmeBridge
 #define __UsbVmeBridge
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <tuple>
 
 #include "CommonDef.h"
@@ -53,6 +55,7 @@ class V1718Pulser
 
   private:
     uint32_t BHandle_;
+    std::mutex* handleMutex_;
     CVPulserSelect pulserId_;
     unsigned char period_;
     unsigned char width_;
@@ -91,6 +94,7 @@ class V1718Scaler
   
   private:
     uint32_t BHandle_;
+    std::mutex* handleMutex_;
     short limit_;
     short autoReset_;
     CVIOSources hit_;
@@ -100,13 +104,21 @@ class V1718Scaler
 };
 
 // V1718 VME USB bridge.
-class VmeUsbBridge: public VmeController{
+class VmeUsbBridge final: public VmeController{
 public:
-     explicit VmeUsbBridge();
+     // board type, link number and board number in the daisy chain, as for CAENVME_Init.
+     // e.g. V1718 (USB): cvV1718, USB link, 0. V2718 via A2818/A3818 (optical): cvV2718, optical link, position in the chain.
+     explicit VmeUsbBridge(CVBoardTypes board=cvV1718, short link=0, short boardNumber=0);
      VmeUsbBridge(const VmeUsbBridge& other); ///< copy constructor
      VmeUsbBridge& operator=(const VmeUsbBridge& other); ///< copy operator
      ~VmeUsbBridge();///< Liberates the USB controller and "BHandle    
     
+     /* Location */
+     inline CVBoardTypes boardType() const { return board_; }
+     inline short link() const { return link_; }
+     inline short boardNumber() const { return boardNumber_; }
+     inline std::string firmwareVersion() const { return firmwareVersion_; }
+
      /* Pulser */
      V1718Pulser& getPulser(CVPulserSelect); 
      
@@ -142,6 +154,13 @@ public:
      
      /* System reset */
      void systemReset() const;
+
+     /* Block transfers */
+     // Larger transfers are split in chunks of at most this size (bytes, multiple of 8), continuing at the next
+     // address (at the same address in FIFO mode), as the library would do in one call.
+     // Defaults: 64 kB on the V1718, 1 MB on the optical bridges. See benchmarkBlockSize.cpp to tune it.
+     inline void setMaxBlockSize(int bytes) { maxBlockSize_ = std::max(8, bytes&~7); }
+     inline int getMaxBlockSize() const { return maxBlockSize_; }
      
      /* Interupts */
      void IRQEnable(uint32_t mask) const override;
@@ -154,18 +173,28 @@ private:
   std::string firmwareVersion_;
   int32_t BHandle_;
   CVBoardTypes board_;
+  short link_;
+  short boardNumber_;
+  // calls on the handle are serialized, so that boards can be driven from several threads
+  std::mutex* handleMutex_;
+  int maxBlockSize_;
 
   V1718Pulser* pulserA_;
   V1718Pulser* pulserB_;
   V1718Scaler* scaler_;
+
+  template<typename C> friend class VmeStaticController;
   
   /* VME data cycles */
-  void writeDataImpl(const long unsigned int address,void* data) const override;
-  void readDataImpl (const long unsigned int address,void* data) const override;
-  void readWriteDataImpl(const long unsigned int address,void* data) const override;
-  void blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, bool multiplex=false) const override;
-  void blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, bool multiplex=false) const override;
-  void ADOCycleImpl(const long unsigned int address) const override;
+  CVErrorCodes writeDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readDataImpl (const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override;
+  CVErrorCodes blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override;
+  CVErrorCodes ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const override;
+  CVErrorCodes blockTransfer(bool read, const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const;
+  CVErrorCodes multiReadImpl(VmeCycle* cycles, int n) const override;
+  CVErrorCodes multiWriteImpl(VmeCycle* cycles, int n) const override;
 };
 
 #endif
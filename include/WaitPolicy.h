@@ -0,0 +1,103 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __WAITPOLICY
+#define __WAITPOLICY
+
+#include "CommonDef.h"
+#include <functional>
+#include <mutex>
+
+class VmeController;
+
+// Statistics of the waits done with a policy
+struct WaitStatistics {
+  uint64_t waits;       ///< number of waits
+  uint64_t polls;       ///< number of times the condition was checked
+  uint64_t timeouts;    ///< number of waits that reached the deadline
+  double totalTime;     ///< total time spent waiting (s)
+  double maxTime;       ///< longest wait (s)
+
+  inline double meanPolls() const { return waits ? double(polls)/waits : 0.; }
+  inline double meanTime() const { return waits ? totalTime/waits : 0.; }
+};
+
+// How to wait for a condition polled on the bus (status bit, handshake...).
+// The condition is checked first, then the policy pauses between successive checks.
+// With a timeout, a CAENVMEexception (cvTimeoutError) is thrown when the deadline is reached.
+// A policy can be shared by several boards and threads.
+class WaitPolicy{
+  public:
+    explicit WaitPolicy(uint32_t timeout_ms=0);
+    virtual ~WaitPolicy() {}
+
+    // wait until ready() returns true
+    void wait(const std::function<bool()>& ready);
+
+    // deadline of each wait (0: no deadline)
+    inline uint32_t getTimeout() const { return timeout_ms_; }
+    inline void setTimeout(uint32_t timeout_ms) { timeout_ms_ = timeout_ms; }
+
+    WaitStatistics statistics() const;
+    void resetStatistics();
+
+  protected:
+    // pause before the next check. attempt is the number of checks done so far in this wait.
+    virtual void pause(unsigned int attempt) = 0;
+
+  private:
+    uint32_t timeout_ms_;
+    mutable std::mutex mutex_;
+    WaitStatistics statistics_;
+};
+
+// Checks the condition again immediately: lowest latency, but keeps the bus and one CPU busy.
+class BusyWait: public WaitPolicy{
+  public:
+    explicit BusyWait(uint32_t timeout_ms=0):WaitPolicy(timeout_ms) {}
+  protected:
+    void pause(unsigned int) override {}
+};
+
+// Sleeps between checks, starting with initial_us and multiplying by factor up to max_us.
+// A factor of 1 gives a fixed polling period.
+class BackoffWait: public WaitPolicy{
+  public:
+    BackoffWait(uint32_t initial_us=10, uint32_t max_us=10000, double factor=2., uint32_t timeout_ms=0);
+  protected:
+    void pause(unsigned int attempt) override;
+  private:
+    uint32_t initial_us_;
+    uint32_t max_us_;
+    double factor_;
+};
+
+// Waits for an interrupt on the given levels (mask as for IRQWait) between checks, by slices of slice_ms.
+// The board has to be programmed to raise the interrupt when the condition is met, and the levels enabled.
+class IRQAssistedWait: public WaitPolicy{
+  public:
+    IRQAssistedWait(const VmeController* controller, uint32_t mask, uint32_t slice_ms=1, uint32_t timeout_ms=0);
+  protected:
+    void pause(unsigned int attempt) override;
+  private:
+    const VmeController* controller_;
+    uint32_t mask_;
+    uint32_t slice_ms_;
+};
+
+#endif
@@ -18,31 +18,33 @@
 
 #include "CaenetBridge.h"
 #include "PythonModule.h"
-#include <unistd.h>
 
-CaenetBridge::CaenetBridge(VmeController *cont, uint32_t bridgeAdd, uint8_t interrupt):VmeBoard(cont,bridgeAdd,cvA24_S_DATA,cvD16,true),interrupt_(interrupt) {}
+CaenetBridge::CaenetBridge(VmeController *cont, uint32_t bridgeAdd, uint8_t interrupt):VmeBoard(cont,bridgeAdd,cvA24_S_DATA,cvD16,true),interrupt_(interrupt) {
+  // the response comes after a few ms: wait for the interrupt if possible, poll every 10ms otherwise
+  if(interrupt_) setWaitPolicy(std::make_shared<IRQAssistedWait>(cont,1<<(interrupt_-1),10));
+  else setWaitPolicy(std::make_shared<BackoffWait>(10000,10000,1.));
+}
 
 void CaenetBridge::reset() {
-  LOG_TRACE("sending reset command " + int_to_hex(baseAddress()+0x6));
-  writeData(baseAddress()+0x6,0x0000);
+  LOG_TRACE("sending reset command " + int_to_hex(Registers::Reset::address(baseAddress())));
+  VmeBoard::write<Registers::Reset>(0x0000);
 }
 
 bool CaenetBridge::validStatus() {
-  uint16_t data = 0x0000;
-  LOG_TRACE("checking the status at " + int_to_hex(baseAddress()+0x2));
-  return !(readData<uint16_t>(baseAddress()+0x2)&0x1);
+  LOG_TRACE("checking the status at " + int_to_hex(Registers::Status::address(baseAddress())));
+  return !Registers::Invalid::get(read<Registers::Status>());
 }
 
 void CaenetBridge::write(const std::vector<uint32_t>& data) {
   // buffers data
   for(auto d : data) {
     LOG_TRACE("writing data " + int_to_hex(d) + " to " + int_to_hex(baseAddress()));
-    writeData(baseAddress(),d);
+    VmeBoard::write<Registers::Data>(d);
     if (!validStatus()) throw CAENETexception(0XFFF0);
   }
   // start transmission
   LOG_TRACE("start the transmission");
-  writeData(baseAddress()+0x4,0x0000);
+  VmeBoard::write<Registers::Transmit>(0x0000);
   if (!validStatus()) throw CAENETexception(0XFFF0);
 }
 
@@ -50,21 +52,17 @@ std::pair<uint32_t, std::vector<uint32_t> > CaenetBridge::readResponse() {
   uint32_t errorCode = 0;
   std::vector<uint32_t> data;
   uint32_t tmp = 0;
-  // first wait for the response
-  if (interrupt_) { // wait for interrupt if possible
-    LOG_TRACE("waiting for interrupt")
-    controller()->IRQWait(1<<(interrupt_-1),500);
-    controller()->IRQDisable(1<<(interrupt_-1));
-  }
-  // polling. First word read is the error code (0 for success)
-  do {
-    usleep(10000); // wait 10ms 
-    errorCode = readData<uint16_t>(baseAddress());
-  } while (!validStatus());
+  // wait for the response. First word read is the error code (0 for success)
+  LOG_TRACE("waiting for the response")
+  waitFor([&]() {
+    errorCode = read<Registers::Data>();
+    return validStatus();
+  });
+  if (interrupt_) controller()->IRQDisable(1<<(interrupt_-1));
   LOG_TRACE("received first data word: " + int_to_hex(tmp));
   // then read data
   while (validStatus()) {
-    tmp = readData<uint16_t>(baseAddress());
+    tmp = read<Registers::Data>();
     LOG_TRACE("received data: " + int_to_hex(tmp));
     data.push_back(tmp);
   }
@@ -28,15 +28,20 @@ std::vector<float> Discri::wcounts_   = {0,15,30,45,60,75,90,105,120,135,150,165
 std::vector<float> Discri::deadtimes_ = {150,2000};
 std::vector<float> Discri::dtcounts_  = {0,255};
 
-Discri::Discri(VmeController *controller,int add):VmeBoard(controller, add, cvA32_U_DATA, cvD16, true),status_(0x0000) {
+Discri::Discri(VmeController *controller,int add):VmeBoard(controller, add, cvA32_U_DATA, cvD16, true) {
   // check the connection...
-  info_.moduleType_ = readData<uint16_t>(baseAddress()+0xFC);
-  info_.serial_number_ = readData<uint16_t>(baseAddress()+0xFE);
-  info_.moduleId_ = readData<uint16_t>(baseAddress()+0xFA);
+  VmeBatch id = batch();
+  id.read<Registers::ModuleType>(baseAddress());
+  id.read<Registers::SerialNumber>(baseAddress());
+  id.read<Registers::FixedCode>(baseAddress());
+  id.flush();
+  info_.moduleType_ = id[0];
+  info_.serial_number_ = id[1];
+  info_.moduleId_ = id[2];
   assert(info_.moduleId_==0xFAF5);
   
   // initial config
-  setChannelMask(status_);
+  setChannelMask(0x0000);
   
   LOG_DEBUG("CAEN V812 initialized. " + 
             int_to_hex(info_.moduleType_&0x3FF) + " " + int_to_hex(info_.moduleType_>>10) + " " + 
@@ -55,35 +60,31 @@ void Discri::disableChannel(uint8_t channel) {
 }
   
 void Discri::setChannelMask(uint16_t mask) {
-  status_ = mask;
-  writeData(baseAddress()+0x4A,status_);
-  LOG_INFO("Channels changed. Mask:" + to_string(status_));
+  write<Registers::PatternInhibit>(mask);
+  LOG_INFO("Channels changed. Mask:" + to_string(mask));
 }
 
 void Discri::setChannel(uint8_t channel, bool newState){
-  if (newState != ((status_>>channel)&1)) {
-    status_ ^= (1u << channel);
-    // write the result to the proper register
-    writeData(baseAddress()+0x4A,status_);
-  }
+  // the register is write-only: updated from its shadow
+  if (newState != ((getChannelMask()>>channel)&1))
+    update<Registers::PatternInhibit>(1u << channel, uint16_t(newState) << channel);
   LOG_INFO("New status for channel " + to_string(channel) +": "+ to_string(newState));
 }
 
 void Discri::setMajority(uint8_t num){
   assert(num>0 && num<21);
-  writeData(baseAddress()+0x48,round((num*50.-25.)/4.));
+  write<Registers::Majority>(round((num*50.-25.)/4.));
   LOG_INFO("Set majority level to " + to_string(num) + "(sent: " + to_string(round((num*50.-25.)/4.)) + ")");
 }
 
 void Discri::setThreshold(uint8_t value,int8_t channel){
   if (channel==-1){
     LOG_INFO("Setting all thresholds to "+to_string(value));
-    for (int i=0; i<16; i++) 
-      this->setThreshold(value,i);
+    writeAll<Registers::Threshold>(value);
   } else {
     assert(channel>=0 && channel<16);
     LOG_DEBUG("Setting threshold to " + to_string(value) + " on channel " + to_string(channel));
-    writeData(baseAddress()+2*channel,value);
+    write<Registers::Threshold>(value,channel);
   }
 }
 
@@ -91,27 +92,19 @@ void Discri::setWidth(float ns,uint8_t channel){
   assert(channel<16);
   uint16_t wcount = (uint16_t)Discri::getWCount(ns);
   LOG_INFO("Setting output width to "+ to_string(wcount));
-  if (channel<8) {
-    writeData(baseAddress()+0x40,wcount);
-  } else {
-    writeData(baseAddress()+0x42,wcount);
-  }
+  write<Registers::OutputWidth>(wcount,channel/8);
 }
 
 void Discri::setDeadTime(float ns,uint8_t channel){
   assert(channel<16);
   uint16_t dtcount = (uint16_t)Discri::getDTCount(ns);
   LOG_INFO("Setting dead time to " + to_string(dtcount));
-  if (channel<8) {
-    writeData(baseAddress()+0x44,dtcount);
-  } else { 
-    writeData(baseAddress()+0x46,dtcount);
-  }
+  write<Registers::DeadTime>(dtcount,channel/8);
 }
 
 void Discri::testPulse() {
   LOG_INFO("Generating a test pulse.");
-  writeData(baseAddress()+0x4C,status_);
+  write<Registers::TestPulse>(getChannelMask());
 }
 
 float Discri::interpolate( std::vector<float> &xData, std::vector<float> &yData, float x, bool extrapolate ) {
@@ -135,7 +128,7 @@ float Discri::interpolate( std::vector<float> &xData, std::vector<float> &yData,
 using namespace boost::python;
 
 template<> void exposeToPython<Discri>() {
-  class_<Discri>("Discri",init<VmeController*,uint32_t>())
+  class_<Discri, bases<VmeBoard> >("Discri",init<VmeController*,uint32_t>())
     .def("enableChannel",&Discri::enableChannel)
     .def("disableChannel",&Discri::disableChannel)
     .def("setChannelMask",&Discri::setChannelMask)
@@ -0,0 +1,127 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "EventBatch.h"
+#include "PythonModule.h"
+#include <stdexcept>
+using namespace std;
+
+EventBatch::EventBatch():hitOffset_(1, 0), tdcOffset_(1, 0), header_(0), extdTime_(0) {
+}
+
+void EventBatch::clear() {
+  // the hits and TDC blocks of the event being decoded move to the front
+  size_t hits = this->hits(), tdcs = this->tdcs();
+  channel_.erase(channel_.begin(), channel_.begin()+hits);
+  edge_.erase(edge_.begin(), edge_.begin()+hits);
+  measurement_.erase(measurement_.begin(), measurement_.begin()+hits);
+  tdcId_.erase(tdcId_.begin(), tdcId_.begin()+tdcs);
+  tdcEventId_.erase(tdcEventId_.begin(), tdcEventId_.begin()+tdcs);
+  bunchId_.erase(bunchId_.begin(), bunchId_.begin()+tdcs);
+  errorFlags_.erase(errorFlags_.begin(), errorFlags_.begin()+tdcs);
+  tdcHitOffset_.erase(tdcHitOffset_.begin(), tdcHitOffset_.begin()+tdcs);
+  for(auto& offset: tdcHitOffset_) offset -= hits;
+  eventCount_.clear();
+  extTriggerTime_.clear();
+  geo_.clear();
+  status_.clear();
+  hitOffset_.assign(1, 0);
+  tdcOffset_.assign(1, 0);
+}
+
+void EventBatch::reserve(size_t events, size_t hits, size_t tdcs) {
+  eventCount_.reserve(events);
+  extTriggerTime_.reserve(events);
+  geo_.reserve(events);
+  status_.reserve(events);
+  hitOffset_.reserve(events+1);
+  tdcOffset_.reserve(events+1);
+  channel_.reserve(hits);
+  edge_.reserve(hits);
+  measurement_.reserve(hits);
+  tdcId_.reserve(tdcs);
+  tdcEventId_.reserve(tdcs);
+  bunchId_.reserve(tdcs);
+  errorFlags_.reserve(tdcs);
+  tdcHitOffset_.reserve(tdcs);
+}
+
+V1190Event EventBatch::event(size_t i) const {
+  V1190Event event;
+  event.setEventCount(eventCount_[i]);
+  event.setGeo(geo_[i]);
+  event.setStatus(status_[i]);
+  event.setExtdTriggerTime(extTriggerTime_[i]);
+  auto hit = [this](size_t j) {
+    TDCHit hit;
+    hit.setChannel(channel_[j]);
+    hit.setType(edge_[j]);
+    hit.setMeasurement(measurement_[j]);
+    return hit;
+  };
+  // hits before the first TDC block belong to the event, the others to their TDC block
+  size_t first = tdcBegin(i)<tdcEnd(i) ? tdcHitOffset_[tdcBegin(i)] : hitEnd(i);
+  for(size_t j=hitBegin(i); j<first; ++j) event.addHit(hit(j));
+  for(size_t t=tdcBegin(i); t<tdcEnd(i); ++t) {
+    TDCEvent tdc;
+    tdc.setTDCId(tdcId_[t]);
+    tdc.setEventId(tdcEventId_[t]);
+    tdc.setBunchId(bunchId_[t]);
+    tdc.setErrorFlags(errorFlags_[t]);
+    size_t end = t+1<tdcEnd(i) ? tdcHitOffset_[t+1] : hitEnd(i);
+    for(size_t j=tdcHitOffset_[t]; j<end; ++j) tdc.addHit(hit(j));
+    event.addTDCEvent(std::move(tdc));
+  }
+  return event;
+}
+
+using namespace boost::python;
+
+namespace {
+  uint32_t eventCount(const EventBatch& b, size_t i) { return b.eventCounts().at(i); }
+  uint8_t geo(const EventBatch& b, size_t i) { return b.geos().at(i); }
+  uint8_t status(const EventBatch& b, size_t i) { return b.statuses().at(i); }
+  uint32_t extdTriggerTime(const EventBatch& b, size_t i) { return b.extdTriggerTimes().at(i); }
+  size_t hitBegin(const EventBatch& b, size_t i) { if(i>=b.size()) throw std::out_of_range("event index"); return b.hitBegin(i); }
+  size_t hitEnd(const EventBatch& b, size_t i) { if(i>=b.size()) throw std::out_of_range("event index"); return b.hitEnd(i); }
+  uint8_t channel(const EventBatch& b, size_t j) { if(j>=b.hits()) throw std::out_of_range("hit index"); return b.channels()[j]; }
+  uint32_t measurement(const EventBatch& b, size_t j) { if(j>=b.hits()) throw std::out_of_range("hit index"); return b.measurements()[j]; }
+  uint8_t edge(const EventBatch& b, size_t j) { if(j>=b.hits()) throw std::out_of_range("hit index"); return b.edges()[j]; }
+  V1190Event event(const EventBatch& b, size_t i) { if(i>=b.size()) throw std::out_of_range("event index"); return b.event(i); }
+}
+
+template<> void exposeToPython<EventBatch>() {
+  class_<EventBatch>("EventBatch")
+    .def("__len__", &EventBatch::size)
+    .def("size", &EventBatch::size)
+    .def("hits", &EventBatch::hits)
+    .def("tdcs", &EventBatch::tdcs)
+    .def("clear", &EventBatch::clear)
+    .def("reserve", &EventBatch::reserve, (boost::python::arg("events"), boost::python::arg("hits"), boost::python::arg("tdcs")=0))
+    .def("eventCount", eventCount)
+    .def("geo", geo)
+    .def("status", status)
+    .def("extdTriggerTime", extdTriggerTime)
+    .def("hitBegin", hitBegin)
+    .def("hitEnd", hitEnd)
+    .def("channel", channel)
+    .def("measurement", measurement)
+    .def("edge", edge)
+    .def("event", event)
+  ;
+}
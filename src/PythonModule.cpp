@@ -20,6 +20,10 @@
 #include "PythonCaenVmeTypes.h"
 #include "VmeController.h"
 #include "VmeUsbBridge.h"
+#include "VmeSimulator.h"
+#include "VmeTracer.h"
+#include "VmeRecording.h"
+#include "WaitPolicy.h"
 #include "VmeBoard.h"
 #include "CaenetBridge.h"
 #include "HVmodule.h"
@@ -28,6 +32,10 @@
 #include "Scaler.h"
 #include "Discri.h"
 #include "TDC.h"
+#include "TdcChain.h"
+#include "TdcStream.h"
+#include "TdcReadoutEngine.h"
+#include "RunFile.h"
 #include "TTCvi.h"
 
 
@@ -43,7 +51,22 @@ BOOST_PYTHON_MODULE(VeheMencE)
   exposeToPython<VmeUsbBridge>();
   exposeToPython<V1718Pulser>();
   exposeToPython<V1718Scaler>();
+
+  // expose VmeSimulator
+  exposeToPython<SimulatedLatency>();
+  exposeToPython<SimulatedCrate>();
+  exposeToPython<VmeSimulator>();
+
+  // expose VmeTracer
+  exposeToPython<VmeTracer>();
+
+  // expose VmeRecorder and VmeReplayer
+  exposeToPython<VmeRecorder>();
+  exposeToPython<VmeReplayer>();
   
+  // expose WaitPolicy
+  exposeToPython<WaitPolicy>();
+
   // expose VmeBoard
   exposeToPython<VmeBoard>();
   
@@ -76,9 +99,14 @@ BOOST_PYTHON_MODULE(VeheMencE)
   exposeToPython<TDCHit>();
   exposeToPython<TDCEvent>();
   exposeToPython<V1190Event>();
+  exposeToPython<EventBatch>();
   exposeToPython<V1190ControlRegister>();
   exposeToPython<V1190StatusRegister>();
   exposeToPython<Tdc>();
+  exposeToPython<TdcChain>();
+  exposeToPython<TdcStream>();
+  exposeToPython<TdcReadoutEngine>();
+  exposeToPython<RunFileWriter>();
   
   // expose TtcVi
   exposeToPython<TtcVi>();
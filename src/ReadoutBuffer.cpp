@@ -0,0 +1,118 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ReadoutBuffer.h"
+#include "CommonDef.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+  const size_t hugePageSize = 2*1024*1024;
+
+  size_t roundUp(size_t size, size_t granularity) {
+    return ((size+granularity-1)/granularity)*granularity;
+  }
+}
+
+ReadoutBuffer::ReadoutBuffer(size_t capacity, CVBacking backing):
+  data_(nullptr),size_(0),capacity_(0),allocated_(0),backing_(backing),hugePages_(false) {
+  reserve(capacity);
+}
+
+ReadoutBuffer::ReadoutBuffer(const ReadoutBuffer& other):ReadoutBuffer(other.capacity_, other.backing_) {
+  size_ = other.size_;
+  if(size_) memcpy(data_, other.data_, size_);
+}
+
+ReadoutBuffer::ReadoutBuffer(ReadoutBuffer&& other) noexcept:
+  data_(other.data_),size_(other.size_),capacity_(other.capacity_),allocated_(other.allocated_),
+  backing_(other.backing_),hugePages_(other.hugePages_) {
+  other.data_ = nullptr;
+  other.size_ = other.capacity_ = other.allocated_ = 0;
+}
+
+ReadoutBuffer& ReadoutBuffer::operator=(ReadoutBuffer other) noexcept {
+  std::swap(data_, other.data_);
+  std::swap(size_, other.size_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(allocated_, other.allocated_);
+  std::swap(backing_, other.backing_);
+  std::swap(hugePages_, other.hugePages_);
+  return *this;
+}
+
+ReadoutBuffer::~ReadoutBuffer() {
+  release(data_, allocated_, hugePages_);
+}
+
+void ReadoutBuffer::reserve(size_t capacity) {
+  if(capacity<=capacity_) return;
+  // grow geometrically, to keep the number of reallocations low when filled progressively
+  capacity = std::max(capacity, 2*capacity_);
+  unsigned char* data;
+  size_t allocated;
+  bool huge;
+  allocate(capacity, data, allocated, huge);
+  if(size_) memcpy(data, data_, size_);
+  release(data_, allocated_, hugePages_);
+  data_ = data;
+  allocated_ = allocated;
+  capacity_ = allocated;
+  hugePages_ = huge;
+}
+
+void ReadoutBuffer::resize(size_t size) {
+  reserve(size);
+  size_ = size;
+}
+
+void ReadoutBuffer::allocate(size_t capacity, unsigned char*& data, size_t& allocated, bool& huge) const {
+  huge = false;
+#ifdef MAP_HUGETLB
+  if(backing_==cvHugePages) {
+    allocated = roundUp(capacity, hugePageSize);
+    void* ptr = mmap(nullptr, allocated, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+    if(ptr!=MAP_FAILED) {
+      data = static_cast<unsigned char*>(ptr);
+      huge = true;
+      return;
+    }
+    LOG_WARN("Huge pages not available for the readout buffer. Using normal pages.");
+  }
+#endif
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  allocated = roundUp(capacity, pageSize);
+  void* ptr = nullptr;
+  if(posix_memalign(&ptr, pageSize, allocated)) throw_with_trace(std::bad_alloc());
+  data = static_cast<unsigned char*>(ptr);
+}
+
+void ReadoutBuffer::release(unsigned char* data, size_t allocated, bool huge) const {
+  if(!data) return;
+  if(huge) {
+    munmap(data, allocated);
+  } else {
+    free(data);
+  }
+}
@@ -0,0 +1,201 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RunFile.h"
+#include "PythonModule.h"
+#include <chrono>
+#include <cstring>
+
+static const char magic[8] = {'V','1','1','9','0','R','U','N'};
+static const uint32_t blockMarker = 0x314B4C42; // "BLK1"
+
+static uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+RunConfiguration RunFileWriter::snapshot(Tdc& tdc) {
+  RunConfiguration configuration;
+  std::memset(&configuration, 0, sizeof(configuration));
+  configuration.baseAddress = tdc.getBaseAddress();
+  configuration.control = tdc.getControlRegister().registr();
+  configuration.almostFullLevel = tdc.getAlmostFullLevel();
+  configuration.acquisitionMode = tdc.getAcquisitionMode();
+  configuration.edgeDetection = tdc.getEdgeDetectionConfiguration();
+  configuration.resolution = tdc.getResolution();
+  configuration.deadTime = tdc.getDeadTime();
+  configuration.tdcHeaders = tdc.isTDCHeaderEnabled();
+  configuration.geo = tdc.getGeoAddress();
+  configuration.blockTransfer = tdc.getBlockTransferMode();
+  Tdc::WindowConfiguration window = tdc.getTriggerWindow();
+  configuration.triggerTimeSubstraction = window.triggerTimeSubstraction;
+  configuration.windowWidth = window.width;
+  configuration.windowOffset = window.offset;
+  configuration.extraMargin = window.extraMargin;
+  configuration.rejectMargin = window.rejectMargin;
+  configuration.maxHits = tdc.getMaxHitsPerEvent();
+  configuration.internalErrorTypes = tdc.getInternalErrorTypes();
+  configuration.fifoSize = tdc.getFifoSize();
+  return configuration;
+}
+
+RunFileWriter::RunFileWriter(const std::string& filename, Tdc& tdc, uint32_t runNumber, size_t bufferSize):
+  file_(filename, std::ios::binary),filename_(filename),buffer_(bufferSize),used_(0),blocks_(0),bytes_(0) {
+  if(!file_) {
+    LOG_ERROR("Cannot open the run file " + filename);
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  std::memset(&header_, 0, sizeof(header_));
+  std::memcpy(header_.magic, magic, sizeof(magic));
+  header_.version = 1;
+  header_.headerSize = sizeof(RunFileHeader);
+  header_.startTime = now();
+  header_.runNumber = runNumber;
+  Tdc::ModuleInfo info = tdc.getModuleInfo();
+  header_.manufacturer = info.manufacturer_;
+  header_.moduleType = info.moduletype_;
+  header_.serialNumber = info.serial_number_;
+  header_.revisionMinor = info.revision_minor_;
+  header_.revisionMajor = info.revision_major_;
+  header_.moduleVersion = info.version_;
+  header_.firmwareVersion = info.firmwareVersion_;
+  header_.configuration = snapshot(tdc);
+  append(&header_, sizeof(header_));
+  LOG_INFO("Writing run " + std::to_string(runNumber) + " to " + filename);
+}
+
+RunFileWriter::~RunFileWriter() {
+  try {
+    close();
+  } catch(CAENVMEexception&) {
+    // already logged
+  }
+}
+
+void RunFileWriter::append(const void* data, size_t size) {
+  bytes_ += size;
+  if(used_+size>buffer_.size()) {
+    flush();
+    // larger than the buffer: written directly
+    if(size>buffer_.size()) {
+      file_.write(static_cast<const char*>(data), size);
+      if(!file_) {
+        LOG_ERROR("Cannot write to the run file " + filename_);
+        throw_with_trace(CAENVMEexception(cvGenericError));
+      }
+      return;
+    }
+  }
+  std::memcpy(buffer_.data()+used_, data, size);
+  used_ += size;
+}
+
+void RunFileWriter::write(const uint32_t* words, size_t n, uint64_t timestamp) {
+  if(!file_.is_open()) return;
+  RunBlockHeader block = {blockMarker, uint32_t(n), blocks_, timestamp ? timestamp : now()};
+  append(&block, sizeof(block));
+  append(words, n*sizeof(uint32_t));
+  ++blocks_;
+}
+
+void RunFileWriter::flush() {
+  if(!file_.is_open() || !used_) return;
+  file_.write(buffer_.data(), used_);
+  used_ = 0;
+  if(!file_) {
+    LOG_ERROR("Cannot write to the run file " + filename_);
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+}
+
+void RunFileWriter::close() {
+  if(!file_.is_open()) return;
+  flush();
+  file_.close();
+  LOG_INFO(std::to_string(blocks_) + " blocks, " + std::to_string(bytes_) + " bytes written to " + filename_);
+}
+
+RunFileReader::RunFileReader(const std::string& filename):file_(filename, std::ios::binary),filename_(filename) {
+  if(!file_.read(reinterpret_cast<char*>(&header_), sizeof(header_)) || std::memcmp(header_.magic, magic, sizeof(magic))) {
+    LOG_ERROR(filename + " is not a run file");
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  if(header_.headerSize<sizeof(header_)) {
+    LOG_ERROR("Corrupted header in the run file " + filename);
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  // the block sizes are checked against the size of the file
+  file_.seekg(0, std::ios::end);
+  size_ = file_.tellg();
+  // newer versions may have a longer header
+  file_.seekg(header_.headerSize);
+}
+
+bool RunFileReader::next(std::vector<uint32_t>& words, RunBlockHeader& block) {
+  if(!file_.read(reinterpret_cast<char*>(&block), sizeof(block))) return false;
+  if(block.marker!=blockMarker) {
+    LOG_ERROR("Corrupted block in the run file " + filename_);
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  if(uint64_t(block.words)*sizeof(uint32_t) > size_-uint64_t(file_.tellg())) {
+    LOG_ERROR("Block " + std::to_string(block.sequence) + " of the run file " + filename_ + " is corrupted or truncated: "
+              + std::to_string(block.words) + " words announced");
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  words.resize(block.words);
+  if(!file_.read(reinterpret_cast<char*>(words.data()), block.words*sizeof(uint32_t))) {
+    LOG_ERROR("Cannot read the run file " + filename_);
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  return true;
+}
+
+using namespace boost::python;
+
+namespace {
+  void writeWords(RunFileWriter& writer, const list& words) {
+    std::vector<uint32_t> data(len(words));
+    for(size_t i=0;i<data.size();++i) data[i] = extract<uint32_t>(words[i]);
+    writer.write(data.data(), data.size());
+  }
+  object nextWords(RunFileReader& reader) {
+    std::vector<uint32_t> data;
+    if(!reader.next(data)) return object();
+    list words;
+    for(auto word : data) words.append(word);
+    return words;
+  }
+  uint32_t runNumber(const RunFileReader& reader) { return reader.header().runNumber; }
+  uint64_t startTime(const RunFileReader& reader) { return reader.header().startTime; }
+  uint16_t serialNumber(const RunFileReader& reader) { return reader.header().serialNumber; }
+}
+
+template<> void exposeToPython<RunFileWriter>() {
+  class_<RunFileWriter, boost::noncopyable>("RunFileWriter", init<std::string, Tdc&, optional<uint32_t, size_t> >())
+    .def("write", writeWords)
+    .def("flush", &RunFileWriter::flush)
+    .def("close", &RunFileWriter::close)
+    .add_property("blocks", &RunFileWriter::blocks)
+    .add_property("bytes", &RunFileWriter::bytes)
+  ;
+  class_<RunFileReader, boost::noncopyable>("RunFileReader", init<std::string>())
+    .def("next", nextWords)
+    .add_property("runNumber", runNumber)
+    .add_property("startTime", startTime)
+    .add_property("serialNumber", serialNumber)
+  ;
+}
@@ -26,9 +26,14 @@ using namespace std;
 Scaler::Scaler(VmeController* controller,uint32_t address):VmeBoard(controller,address,cvA24_U_DATA,cvD16,true){
   LOG_DEBUG("Address" + int_to_hex(baseAddress()));
   // check the connection...
-  info_.moduleType_ = readData<uint16_t>(baseAddress()+0xFC);
-  info_.serial_number_ = readData<uint16_t>(baseAddress()+0xFE);
-  info_.moduleId_ = readData<uint16_t>(baseAddress()+0xFA);
+  VmeBatch id = batch();
+  id.read<Registers::ModuleType>(baseAddress());
+  id.read<Registers::SerialNumber>(baseAddress());
+  id.read<Registers::FixedCode>(baseAddress());
+  id.flush();
+  info_.moduleType_ = id[0];
+  info_.serial_number_ = id[1];
+  info_.moduleId_ = id[2];
   assert(info_.moduleId_==0xFAF5);
   LOG_DEBUG("Lecroy 1151N scaler initialized. " + 
             int_to_hex(info_.moduleType_&0x3FF) + " " + int_to_hex(info_.moduleType_>>10) + " " + 
@@ -37,26 +42,25 @@ Scaler::Scaler(VmeController* controller,uint32_t address):VmeBoard(controller,a
 }
  
 uint32_t Scaler::getCount(uint8_t channel, bool reset){
-  int completeAdd = baseAddress()+0x40+((!reset)*0x40)+4*channel;
-  uint32_t data = controller()->mode(cvA24_U_DATA,cvD32)->readData<uint32_t>(completeAdd);
+  uint32_t data = reset ? read<Registers::CountAndReset>(channel) : read<Registers::Count>(channel);
   LOG_DEBUG("Count for channel " + to_string(channel) + " = " + to_string(data));
   return data;
 }
 
 void Scaler::setPreset(uint8_t channel, uint32_t value){
   LOG_INFO("Setting presets to "+to_string(value)+" for channel " + to_string(channel) +"...");
-  controller()->mode(cvA24_U_DATA,cvD32)->writeData(baseAddress()+0x40+4*channel,value);
+  write<Registers::Preset>(value,channel);
 }
 
 void Scaler::reset(){
   LOG_INFO("Reseting Scaler...");
-  writeData(baseAddress(),0);
+  write<Registers::Reset>(0);
 }
 
 using namespace boost::python;
 
 template<> void exposeToPython<Scaler>() {
-  class_<Scaler>("Scaler",init<VmeController*,uint32_t>())
+  class_<Scaler, bases<VmeBoard> >("Scaler",init<VmeController*,uint32_t>())
     .def("getCount",&Scaler::getCount)
     .def("setPreset",&Scaler::setPreset)
     .def("reset",&Scaler::reset)
@@ -0,0 +1,1035 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SimulatedCrate.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+namespace {
+  // number of bytes of one cycle for a given data width
+  inline int bytes(CVDataWidth DW) { return DW&0x0F; }
+
+  // copy a value to/from the caller buffer, with the size corresponding to DW
+  inline void store(void* data, uint32_t value, CVDataWidth DW) {
+    switch(bytes(DW)) {
+      case 1: { uint8_t v = value; memcpy(data,&v,1); break; }
+      case 2: { uint16_t v = value; memcpy(data,&v,2); break; }
+      default: { memcpy(data,&value,4); break; }
+    }
+  }
+  inline uint32_t load(const void* data, CVDataWidth DW) {
+    switch(bytes(DW)) {
+      case 1: { uint8_t v; memcpy(&v,data,1); return v; }
+      case 2: { uint16_t v; memcpy(&v,data,2); return v; }
+      default: { uint32_t v; memcpy(&v,data,4); return v; }
+    }
+  }
+
+  // V1190 data words
+  const uint32_t V1190_GLOBAL_HEADER  = 0x08<<27;
+  const uint32_t V1190_GLOBAL_TRAILER = 0x10<<27;
+  const uint32_t V1190_EXTENDED_TIME  = 0x11<<27;
+  const uint32_t V1190_TDC_HEADER     = 0x01<<27;
+  const uint32_t V1190_TDC_TRAILER    = 0x03<<27;
+  const uint32_t V1190_TDC_ERROR      = 0x04<<27;
+  const uint32_t V1190_FILLER         = 0x18<<27;
+  const size_t V1190_BUFFER_SIZE = 32768;
+  const size_t V1190_FIFO_SIZE = 1024;
+}
+
+//////////////////////////////////////////
+// SimulatedBoard
+//////////////////////////////////////////
+
+SimulatedBoard::SimulatedBoard(uint32_t baseAddress, uint32_t size):baseAddress_(baseAddress),size_(size),crate_(nullptr) {}
+
+CVErrorCodes SimulatedBoard::blockRead(uint32_t offset, unsigned char* buffer, int size, CVDataWidth DW, int* count) {
+  // D64 is done as pairs of D32 cycles
+  CVDataWidth width = bytes(DW)==8 ? cvD32 : DW;
+  int step = bytes(width);
+  *count = 0;
+  for(int i=0; i+step<=size; i+=step) {
+    uint32_t data;
+    CVErrorCodes status = read(offset+i, data, width);
+    if(status) return status;
+    store(buffer+i, data, width);
+    *count += step;
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedBoard::blockWrite(uint32_t offset, const unsigned char* buffer, int size, CVDataWidth DW, int* count) {
+  CVDataWidth width = bytes(DW)==8 ? cvD32 : DW;
+  int step = bytes(width);
+  *count = 0;
+  for(int i=0; i+step<=size; i+=step) {
+    CVErrorCodes status = write(offset+i, load(buffer+i, width), width);
+    if(status) return status;
+    *count += step;
+  }
+  return cvSuccess;
+}
+
+void SimulatedBoard::irqChanged() {
+  if(crate_) crate_->notify();
+}
+
+std::unique_lock<std::recursive_mutex> SimulatedBoard::lockCrate() const {
+  if(crate_) return std::unique_lock<std::recursive_mutex>(crate_->mutex_);
+  return std::unique_lock<std::recursive_mutex>();
+}
+
+//////////////////////////////////////////
+// SimulatedV1190
+//////////////////////////////////////////
+
+SimulatedV1190::SimulatedV1190(uint32_t baseAddress, bool versionB, uint16_t serialNumber):
+  SimulatedBoard(baseAddress,0x10000),versionB_(versionB),serialNumber_(serialNumber),occupancy_(4.),rng_(baseAddress) {
+  moduleReset();
+}
+
+void SimulatedV1190::moduleReset() {
+  control_ = 0x0021; // BERR enabled, compensation enabled
+  geo_ = 0;
+  interruptLevel_ = 0;
+  interruptVector_ = 0;
+  almostFullLevel_ = 64;
+  bltEventNumber_ = 0;
+  mcstAddress_ = 0xAA;
+  mcstControl_ = 0;
+  chainEvents_ = 0;
+  opcode_ = 0;
+  parameters_.clear();
+  expectedParameters_ = 0;
+  microOutput_.clear();
+  triggerMatching_ = true;
+  window_ = {0x14, 0xFFD8, 0x08, 0x04, 0x0};
+  edgeDetection_ = 2;
+  resolution_ = 2;
+  deadTime_ = 0;
+  tdcHeaders_ = true;
+  maxHits_ = 9;
+  errorMark_ = true;
+  bypass_ = false;
+  errorTypes_ = 0x7FF;
+  fifoSize_ = 7;
+  enabledChannels_.set();
+  softwareClear();
+}
+
+void SimulatedV1190::softwareClear() {
+  outputBuffer_.clear();
+  eventFIFO_.clear();
+  storedEvents_ = 0;
+  eventCounter_ = 0;
+  triggerLost_ = false;
+  clock_ = 0;
+  irqChanged();
+}
+
+uint16_t SimulatedV1190::status() const {
+  uint16_t status = 0;
+  status |= (!outputBuffer_.empty());
+  status |= (outputBuffer_.size()>=almostFullLevel_)<<1;
+  status |= (outputBuffer_.size()>=V1190_BUFFER_SIZE)<<2;
+  status |= triggerMatching_<<3;
+  status |= tdcHeaders_<<4;
+  status |= 1<<5;
+  status |= (resolution_&0x3)<<12;
+  status |= (edgeDetection_==0)<<14;
+  status |= triggerLost_<<15;
+  return status;
+}
+
+uint8_t SimulatedV1190::irqLevel() const {
+  return (interruptLevel_ && outputBuffer_.size()>=almostFullLevel_) ? interruptLevel_ : 0;
+}
+
+CVErrorCodes SimulatedV1190::read(uint32_t offset, uint32_t& data, CVDataWidth DW) {
+  // output buffer
+  if(offset<0x1000) {
+    if(outputBuffer_.empty()) {
+      if(control_&0x1) return cvBusError;
+      data = V1190_FILLER;
+      return cvSuccess;
+    }
+    data = outputBuffer_.front();
+    outputBuffer_.pop_front();
+    if((data>>27)==0x10 && storedEvents_) --storedEvents_;
+    irqChanged();
+    return cvSuccess;
+  }
+  // configuration ROM
+  if(offset>=0x4000) {
+    switch(offset) {
+      case 0x4024: data = 0x00; break;
+      case 0x4028: data = 0x40; break;
+      case 0x402C: data = 0xE6; break;
+      case 0x4030: data = versionB_; break;
+      case 0x4034: data = 0x00; break;
+      case 0x4038: data = 0x04; break;
+      case 0x403C: data = 0xA6; break;
+      case 0x4040: data = 0x00; break;
+      case 0x4044: data = 0x01; break;
+      case 0x4048: data = 0x00; break;
+      case 0x404C: data = 0x01; break;
+      case 0x4080: data = serialNumber_>>8; break;
+      case 0x4084: data = serialNumber_&0xFF; break;
+      default: data = 0; break;
+    }
+    return cvSuccess;
+  }
+  // registers
+  switch(offset) {
+    case 0x1000: data = control_; break;
+    case 0x1002: data = status(); break;
+    case 0x100A: data = interruptLevel_; break;
+    case 0x100C: data = interruptVector_; break;
+    case 0x1010: data = mcstAddress_; break;
+    case 0x1012: data = mcstControl_; break;
+    case 0x101C: data = eventCounter_; break;
+    case 0x101E: data = geo_; break;
+    case 0x1020: data = storedEvents_; break;
+    case 0x1022: data = almostFullLevel_; break;
+    case 0x1024: data = bltEventNumber_; break;
+    case 0x1026: data = 0x0C; break;
+    case 0x102E:
+      if(microOutput_.empty()) {
+        data = 0;
+      } else {
+        data = microOutput_.front();
+        microOutput_.pop_front();
+      }
+      break;
+    case 0x1030: data = 0x1 | ((!microOutput_.empty())<<1); break;
+    case 0x1038:
+      if(eventFIFO_.empty()) {
+        data = 0;
+      } else {
+        data = eventFIFO_.front();
+        eventFIFO_.pop_front();
+      }
+      break;
+    case 0x103C: data = eventFIFO_.size(); break;
+    case 0x103E: data = (!eventFIFO_.empty()) | ((eventFIFO_.size()>=V1190_FIFO_SIZE)<<1); break;
+    default: data = 0; break;
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedV1190::write(uint32_t offset, uint32_t data, CVDataWidth DW) {
+  switch(offset) {
+    case 0x1000: control_ = data&0x1FFF; break;
+    case 0x100A: interruptLevel_ = data&0x7; irqChanged(); break;
+    case 0x100C: interruptVector_ = data&0xFF; break;
+    case 0x1010: mcstAddress_ = data&0xFF; break;
+    case 0x1012: mcstControl_ = data&0x3; chainEvents_ = 0; break;
+    case 0x1014: moduleReset(); break;
+    case 0x1016: softwareClear(); break;
+    case 0x1018: eventCounter_ = 0; break;
+    case 0x101A: trigger(); break;
+    case 0x101E: geo_ = data&0x1F; break;
+    case 0x1022: almostFullLevel_ = data&0x7FFF; irqChanged(); break;
+    case 0x1024: bltEventNumber_ = data&0xFF; break;
+    case 0x102E: writeMicro(data); break;
+    default: break;
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedV1190::blockRead(uint32_t offset, unsigned char* buffer, int size, CVDataWidth DW, int* count) {
+  if(offset>=0x1000) return SimulatedBoard::blockRead(offset, buffer, size, DW, count);
+  // the output buffer is read sequentially, whatever the address in the window
+  size_t requested = size/4;
+  size_t available = std::min(requested,outputBuffer_.size());
+  uint32_t* words = reinterpret_cast<uint32_t*>(buffer);
+  for(size_t i=0;i<available;++i) {
+    words[i] = outputBuffer_.front();
+    outputBuffer_.pop_front();
+    if((words[i]>>27)==0x10 && storedEvents_) --storedEvents_;
+  }
+  irqChanged();
+  *count = available*4;
+  if(available==requested) return cvSuccess;
+  // the buffer is empty: bus error if enabled, otherwise fillers.
+  if(control_&0x1) return cvBusError;
+  for(size_t i=available;i<requested;++i) words[i] = V1190_FILLER;
+  *count = requested*4;
+  return cvSuccess;
+}
+
+uint8_t SimulatedV1190::chainPosition(uint32_t address) const {
+  return (address>>24)==mcstAddress_ ? mcstControl_ : 0;
+}
+
+bool SimulatedV1190::chainedRead(unsigned char* buffer, int size, int* count) {
+  // complete events, up to the BLT event number (all of them if 0). The alignment filler goes with its event.
+  uint32_t* words = reinterpret_cast<uint32_t*>(buffer);
+  size_t requested = size/4;
+  size_t n = 0;
+  bool passed = false;
+  while(n<requested && !outputBuffer_.empty()) {
+    if(bltEventNumber_ && chainEvents_>=bltEventNumber_ && outputBuffer_.front()!=V1190_FILLER) {
+      passed = true;
+      break;
+    }
+    words[n] = outputBuffer_.front();
+    outputBuffer_.pop_front();
+    if((words[n]>>27)==0x10) {
+      if(storedEvents_) --storedEvents_;
+      ++chainEvents_;
+    }
+    ++n;
+  }
+  if(outputBuffer_.empty()) passed = true;
+  if(passed) chainEvents_ = 0;
+  irqChanged();
+  *count = n*4;
+  return passed;
+}
+
+void SimulatedV1190::writeMicro(uint16_t word) {
+  // parameter of the pending opcode
+  if(parameters_.size()<expectedParameters_) {
+    parameters_.push_back(word);
+    if(parameters_.size()<expectedParameters_) return;
+  } else {
+    opcode_ = word;
+    parameters_.clear();
+    switch(word>>8) {
+      case 0x10: case 0x11: case 0x12: case 0x13:
+      case 0x22: case 0x24: case 0x25: case 0x28:
+      case 0x33: case 0x39: case 0x3B:
+        expectedParameters_ = 1; return;
+      case 0x44:
+        expectedParameters_ = versionB_ ? 4 : 8; return;
+      default:
+        expectedParameters_ = 0; break;
+    }
+  }
+  // execute the opcode
+  uint16_t parameter = parameters_.empty() ? 0 : parameters_[0];
+  int nwords = versionB_ ? 4 : 8;
+  switch(opcode_>>8) {
+    case 0x00: triggerMatching_ = true; break;
+    case 0x01: triggerMatching_ = false; break;
+    case 0x02: microOutput_.push_back(triggerMatching_); break;
+    case 0x05: { // load default configuration
+      enabledChannels_.set();
+      triggerMatching_ = true; window_ = {0x14, 0xFFD8, 0x08, 0x04, 0x0};
+      edgeDetection_ = 2; resolution_ = 2; deadTime_ = 0; tdcHeaders_ = true; maxHits_ = 9;
+      break;
+    }
+    case 0x10: window_[0] = parameter&0xFFF; break;
+    case 0x11: window_[1] = parameter; break;
+    case 0x12: window_[2] = parameter&0xFFF; break;
+    case 0x13: window_[3] = parameter&0xFFF; break;
+    case 0x14: window_[4] = 1; break;
+    case 0x15: window_[4] = 0; break;
+    case 0x16: for(auto w : window_) microOutput_.push_back(w); break;
+    case 0x22: edgeDetection_ = parameter&0x3; break;
+    case 0x23: microOutput_.push_back(edgeDetection_); break;
+    case 0x24: resolution_ = parameter&0x3; break;
+    case 0x25: resolution_ = parameter&0x0F07; break;
+    case 0x26: microOutput_.push_back(resolution_); break;
+    case 0x28: deadTime_ = parameter&0x3; break;
+    case 0x29: microOutput_.push_back(deadTime_); break;
+    case 0x30: tdcHeaders_ = true; break;
+    case 0x31: tdcHeaders_ = false; break;
+    case 0x32: microOutput_.push_back(tdcHeaders_); break;
+    case 0x33: maxHits_ = parameter&0xF; break;
+    case 0x34: microOutput_.push_back(maxHits_); break;
+    case 0x35: errorMark_ = true; break;
+    case 0x36: errorMark_ = false; break;
+    case 0x37: bypass_ = true; break;
+    case 0x38: bypass_ = false; break;
+    case 0x39: errorTypes_ = parameter&0x7FF; break;
+    case 0x3A: microOutput_.push_back(errorTypes_); break;
+    case 0x3B: fifoSize_ = parameter&0x7; break;
+    case 0x3C: microOutput_.push_back(fifoSize_); break;
+    case 0x40: enabledChannels_.set(opcode_&0x7F); break;
+    case 0x41: enabledChannels_.reset(opcode_&0x7F); break;
+    case 0x42: enabledChannels_.set(); break;
+    case 0x43: enabledChannels_.reset(); break;
+    case 0x44:
+      for(int i=0;i<nwords;++i)
+        for(int j=0;j<16;++j) enabledChannels_.set(16*i+j,(parameters_[i]>>j)&1);
+      break;
+    case 0x45:
+      for(int i=0;i<nwords;++i) {
+        uint16_t w = 0;
+        for(int j=0;j<16;++j) w |= enabledChannels_.test(16*i+j)<<j;
+        microOutput_.push_back(w);
+      }
+      break;
+    default: break;
+  }
+  expectedParameters_ = 0;
+  parameters_.clear();
+}
+
+std::vector<uint32_t> SimulatedV1190::makeHits(uint8_t tdc) {
+  std::vector<uint32_t> hits;
+  int nTDC = versionB_ ? 2 : 4;
+  std::poisson_distribution<int> nhits(occupancy_/nTDC);
+  std::uniform_int_distribution<int> channel(0,31);
+  std::uniform_int_distribution<uint32_t> time(0,0x7FFFF);
+  std::uniform_int_distribution<uint32_t> burst(0,0x3FFF);
+  int n = nhits(rng_);
+  int limit = maxHits_==0 ? 0 : (maxHits_>=9 ? n : 1<<(maxHits_-1));
+  for(int i=0;i<n && i<limit;++i) {
+    uint32_t ch = tdc*32+channel(rng_);
+    if(!enabledChannels_.test(ch)) continue;
+    uint32_t measurement = triggerMatching_ ? time(rng_) : (clock_+burst(rng_))&0x7FFFF;
+    switch(edgeDetection_) {
+      case 0: // pair: width in the upper 7 bits, leading time in the lower 12 bits
+        hits.push_back((ch<<19) | (measurement&0x7FFFF));
+        break;
+      case 1: // trailing
+        hits.push_back((1<<26) | (ch<<19) | measurement);
+        break;
+      case 2: // leading
+        hits.push_back((ch<<19) | measurement);
+        break;
+      default: // both
+        hits.push_back((ch<<19) | measurement);
+        hits.push_back((1<<26) | (ch<<19) | std::min<uint32_t>(measurement+40,0x7FFFF));
+        break;
+    }
+  }
+  // continuous storage: in time order, across the rollover
+  if(!triggerMatching_)
+    std::stable_sort(hits.begin(), hits.end(), [this](uint32_t a, uint32_t b) { return ((a-clock_)&0x7FFFF)<((b-clock_)&0x7FFFF); });
+  if(n>limit && errorMark_) hits.push_back(V1190_TDC_ERROR | (tdc<<24) | (1<<12));
+  return hits;
+}
+
+void SimulatedV1190::pushEvent(const std::vector<uint32_t>& words) {
+  if(outputBuffer_.size()+words.size()>V1190_BUFFER_SIZE) {
+    triggerLost_ = true;
+    return;
+  }
+  outputBuffer_.insert(outputBuffer_.end(),words.begin(),words.end());
+}
+
+void SimulatedV1190::trigger() {
+  auto lock = lockCrate();
+  int nTDC = versionB_ ? 2 : 4;
+  // continuous storage: hits are directly sent to the output buffer
+  if(!triggerMatching_) {
+    for(int tdc=0;tdc<nTDC;++tdc) pushEvent(makeHits(tdc));
+    clock_ = (clock_+0x4000)&0x7FFFF;
+    irqChanged();
+    return;
+  }
+  // trigger matching: build a complete event
+  eventCounter_ = (eventCounter_+1)&0x3FFFFF;
+  uint32_t eventId = eventCounter_&0xFFF;
+  uint32_t bunchId = (eventCounter_*7)&0xFFF;
+  std::vector<uint32_t> event;
+  event.push_back(V1190_GLOBAL_HEADER | (eventCounter_<<5) | geo_);
+  for(int tdc=0;tdc<nTDC;++tdc) {
+    auto hits = makeHits(tdc);
+    if(tdcHeaders_) {
+      event.push_back(V1190_TDC_HEADER | (tdc<<24) | (eventId<<12) | bunchId);
+      event.insert(event.end(),hits.begin(),hits.end());
+      event.push_back(V1190_TDC_TRAILER | (tdc<<24) | (eventId<<12) | ((hits.size()+2)&0xFFF));
+    } else {
+      event.insert(event.end(),hits.begin(),hits.end());
+    }
+  }
+  // no data from the TDCs: the event is only written if empty events are enabled.
+  if(event.size()==1 && !(control_&0x8)) return;
+  if(control_&(1<<9)) event.push_back(V1190_EXTENDED_TIME | ((eventCounter_*1000)&0x7FFFFFF));
+  uint32_t nwords = event.size()+1;
+  event.push_back(V1190_GLOBAL_TRAILER | (triggerLost_<<26) | ((nwords&0xFFFF)<<5) | geo_);
+  // 64 bits alignment
+  if((control_&0x10) && (event.size()%2)) event.push_back(V1190_FILLER);
+  size_t before = outputBuffer_.size();
+  pushEvent(event);
+  if(outputBuffer_.size()==before) return;
+  ++storedEvents_;
+  if((control_&0x100) && eventFIFO_.size()<V1190_FIFO_SIZE)
+    eventFIFO_.push_back(((eventCounter_&0xFFFF)<<16) | (event.size()&0xFFFF));
+  irqChanged();
+}
+
+//////////////////////////////////////////
+// SimulatedV812
+//////////////////////////////////////////
+
+SimulatedV812::SimulatedV812(uint32_t baseAddress, uint16_t serialNumber):SimulatedBoard(baseAddress,0x100),serialNumber_(serialNumber),
+  majority_(0),pattern_(0),testPulses_(0) {
+  thresholds_.fill(0);
+  widths_.fill(0);
+  deadTimes_.fill(0);
+}
+
+CVErrorCodes SimulatedV812::read(uint32_t offset, uint32_t& data, CVDataWidth DW) {
+  switch(offset) {
+    case 0xFA: data = 0xFAF5; break;
+    case 0xFC: data = (0x2<<10) | 0x51; break;
+    case 0xFE: data = serialNumber_&0xFFF; break;
+    default: return cvBusError; // all other registers are write-only
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedV812::write(uint32_t offset, uint32_t data, CVDataWidth DW) {
+  if(offset<0x20) {
+    thresholds_.at(offset/2) = data&0xFF;
+    return cvSuccess;
+  }
+  switch(offset) {
+    case 0x40: widths_[0] = data&0xFF; break;
+    case 0x42: widths_[1] = data&0xFF; break;
+    case 0x44: deadTimes_[0] = data&0xFF; break;
+    case 0x46: deadTimes_[1] = data&0xFF; break;
+    case 0x48: majority_ = data&0xFF; break;
+    case 0x4A: pattern_ = data&0xFFFF; break;
+    case 0x4C: ++testPulses_; break;
+    default: return cvBusError;
+  }
+  return cvSuccess;
+}
+
+//////////////////////////////////////////
+// Simulated1151N
+//////////////////////////////////////////
+
+Simulated1151N::Simulated1151N(uint32_t baseAddress, uint16_t serialNumber):SimulatedBoard(baseAddress,0x100),serialNumber_(serialNumber) {
+  counts_.fill(0);
+  presets_.fill(0);
+}
+
+void Simulated1151N::count(uint8_t channel, uint32_t n) {
+  auto lock = lockCrate();
+  counts_.at(channel) += n;
+}
+
+uint32_t Simulated1151N::value(uint8_t channel) const {
+  if(!presets_[channel]) return counts_[channel];
+  return counts_[channel]>=presets_[channel] ? 0 : presets_[channel]-counts_[channel];
+}
+
+CVErrorCodes Simulated1151N::read(uint32_t offset, uint32_t& data, CVDataWidth DW) {
+  if(offset>=0x40 && offset<0x80) { // read and reset
+    uint8_t channel = (offset-0x40)/4;
+    data = value(channel);
+    counts_[channel] = 0;
+    return cvSuccess;
+  }
+  if(offset>=0x80 && offset<0xC0) {
+    data = value((offset-0x80)/4);
+    return cvSuccess;
+  }
+  switch(offset) {
+    case 0xFA: data = 0xFAF5; break;
+    case 0xFC: data = (0x1<<10) | 0x51; break;
+    case 0xFE: data = serialNumber_&0xFFF; break;
+    default: return cvBusError;
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes Simulated1151N::write(uint32_t offset, uint32_t data, CVDataWidth DW) {
+  if(offset==0) {
+    counts_.fill(0);
+    return cvSuccess;
+  }
+  if(offset>=0x40 && offset<0x80) {
+    presets_[(offset-0x40)/4] = data;
+    return cvSuccess;
+  }
+  return cvBusError;
+}
+
+//////////////////////////////////////////
+// SimulatedTTCvi
+//////////////////////////////////////////
+
+SimulatedTTCvi::SimulatedTTCvi(uint32_t baseAddress, uint32_t serialNumber):SimulatedBoard(baseAddress,0x100),serialNumber_(serialNumber),
+  csr1_(0x7),csr2_(0),eventCounter_(0),asyncCommands_(0) {
+  bgo_.fill(0);
+  inhibitDelay_.fill(0);
+  inhibitDuration_.fill(0);
+}
+
+CVErrorCodes SimulatedTTCvi::read(uint32_t offset, uint32_t& data, CVDataWidth DW) {
+  uint32_t revision = 0x00000102;
+  switch(offset) {
+    // configuration EEPROM
+    case 0x26: data = 0x08; break;
+    case 0x2A: data = 0x00; break;
+    case 0x2E: data = 0x30; break;
+    case 0x32: data = (serialNumber_>>24)&0xFF; break;
+    case 0x36: data = (serialNumber_>>16)&0xFF; break;
+    case 0x3A: data = (serialNumber_>>8)&0xFF; break;
+    case 0x3E: data = serialNumber_&0xFF; break;
+    case 0x42: data = (revision>>24)&0xFF; break;
+    case 0x46: data = (revision>>16)&0xFF; break;
+    case 0x4A: data = (revision>>8)&0xFF; break;
+    case 0x4E: data = revision&0xFF; break;
+    // CSR and counters. The L1A FIFO is always empty.
+    case 0x80: data = (csr1_&0xFF0F) | (0x2<<4); break;
+    case 0x82: data = csr2_; break;
+    case 0x88: data = (eventCounter_>>16)&0xFF; break;
+    case 0x8A: data = eventCounter_&0xFFFF; break;
+    default:
+      if(offset>=0x90 && offset<0xB0) {
+        unsigned int n = (offset-0x90)/8;
+        switch((offset-0x90)%8) {
+          case 0: data = bgo_[n]; break;
+          case 2: data = inhibitDelay_[n]; break;
+          case 4: data = inhibitDuration_[n]; break;
+          default: data = 0; break;
+        }
+      } else {
+        data = 0;
+      }
+      break;
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedTTCvi::write(uint32_t offset, uint32_t data, CVDataWidth DW) {
+  switch(offset) {
+    case 0x80: csr1_ = data&0xFF8F; break; // bit 6 (L1A FIFO reset) is not stored
+    case 0x82: csr2_ = data; break;
+    case 0x84: // module reset
+      csr1_ = 0x7; csr2_ = 0; eventCounter_ = 0;
+      bgo_.fill(0); inhibitDelay_.fill(0); inhibitDuration_.fill(0);
+      break;
+    case 0x86: if((csr1_&0x7)==4) l1a(); break;
+    case 0x88: eventCounter_ = (eventCounter_&0xFFFF) | ((data&0xFF)<<16); break;
+    case 0x8A: eventCounter_ = (eventCounter_&0xFF0000) | (data&0xFFFF); break;
+    case 0x8B: case 0xC2: case 0xC4: ++asyncCommands_; break;
+    case 0x8C: eventCounter_ = 0; break;
+    default:
+      if(offset>=0x90 && offset<0xB0) {
+        unsigned int n = (offset-0x90)/8;
+        switch((offset-0x90)%8) {
+          case 0: bgo_[n] = data&0xF; break;
+          case 2: inhibitDelay_[n] = data&0xFFF; break;
+          case 4: inhibitDuration_[n] = data&0xFF; break;
+          default: break;
+        }
+      }
+      break;
+  }
+  return cvSuccess;
+}
+
+void SimulatedTTCvi::externalTrigger(uint8_t input) {
+  auto lock = lockCrate();
+  if((csr1_&0x7)==input) l1a();
+}
+
+void SimulatedTTCvi::l1a() {
+  // in orbit mode, the counter is incremented by the orbit signal, not by L1As
+  if(!(csr1_&0x8000)) eventCounter_ = (eventCounter_+1)&0xFFFFFF;
+  for(auto& callback : l1aCallbacks_) callback();
+}
+
+//////////////////////////////////////////
+// SimulatedV288
+//////////////////////////////////////////
+
+SimulatedV288::SimulatedV288(uint32_t baseAddress, uint8_t irqLevel):SimulatedBoard(baseAddress,0x10),irqLevel_(irqLevel),irqPending_(false),valid_(true) {}
+
+void SimulatedV288::attach(uint8_t address, Slave slave) {
+  slaves_.push_back(std::make_pair(address,slave));
+}
+
+CVErrorCodes SimulatedV288::read(uint32_t offset, uint32_t& data, CVDataWidth DW) {
+  switch(offset) {
+    case 0x0:
+      if(rxBuffer_.empty()) {
+        valid_ = false;
+        data = 0xFFFF;
+      } else {
+        valid_ = true;
+        data = rxBuffer_.front();
+        rxBuffer_.pop_front();
+      }
+      break;
+    case 0x2: data = valid_ ? 0x0 : 0x1; break;
+    default: return cvBusError;
+  }
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedV288::write(uint32_t offset, uint32_t data, CVDataWidth DW) {
+  switch(offset) {
+    case 0x0: txBuffer_.push_back(data&0xFFFF); valid_ = true; break;
+    case 0x4: transmit(); valid_ = true; break;
+    case 0x6: txBuffer_.clear(); rxBuffer_.clear(); irqPending_ = false; valid_ = true; irqChanged(); break;
+    default: return cvBusError;
+  }
+  return cvSuccess;
+}
+
+uint16_t SimulatedV288::iack() {
+  irqPending_ = false;
+  irqChanged();
+  return 0xFF;
+}
+
+void SimulatedV288::transmit() {
+  // frame: controller identifier, slave address, code, parameters
+  rxBuffer_.clear();
+  std::vector<uint16_t> frame;
+  frame.swap(txBuffer_);
+  uint16_t errorCode = 0xFFFF; // the addressed module does not exist.
+  if(frame.size()>=3) {
+    for(auto& [address, slave] : slaves_) {
+      if(address!=(frame[1]&0xFF)) continue;
+      auto [ code, data ] = slave(frame);
+      errorCode = code;
+      rxBuffer_.insert(rxBuffer_.end(),data.begin(),data.end());
+      break;
+    }
+  }
+  rxBuffer_.push_front(errorCode);
+  if(irqLevel_) {
+    irqPending_ = true;
+    irqChanged();
+  }
+}
+
+SimulatedV288::Slave SimulatedV288::N470() {
+  struct Channel {
+    uint16_t status = 0;
+    uint16_t vmon = 0, imon = 0;
+    uint16_t v0 = 0, i0 = 0, v1 = 0, i1 = 0;
+    uint16_t trip = 0, rampup = 0, rampdown = 0;
+    uint16_t maxV = 8000;
+  };
+  auto channels = std::make_shared<std::array<Channel,4> >();
+  return [channels](const std::vector<uint16_t>& frame) -> std::pair<uint16_t,std::vector<uint16_t> > {
+    std::vector<uint16_t> data;
+    uint16_t code = frame[2]&0xFF;
+    uint16_t id = frame[2]>>8;
+    uint16_t value = frame.size()>3 ? frame[3] : 0;
+    if(id>=channels->size()) return std::make_pair(0xFF03,data);
+    Channel& ch = channels->at(id);
+    switch(code) {
+      case 0: { // identification
+        std::string name = "N470 simulated";
+        data.assign(name.begin(),name.end());
+        break;
+      }
+      case 1: // status of all channels
+        for(auto& c : *channels) {
+          data.push_back(c.vmon); data.push_back(c.imon); data.push_back(c.maxV); data.push_back(c.status);
+        }
+        break;
+      case 2: // operational parameters of one channel
+        data = {ch.status, ch.vmon, ch.imon, ch.v0, ch.i0, ch.v1, ch.i1, ch.trip, ch.rampup, ch.rampdown, ch.maxV};
+        break;
+      case 3: ch.v0 = value; if(ch.status&0x1) ch.vmon = value; break;
+      case 4: ch.i0 = value; break;
+      case 5: ch.v1 = value; break;
+      case 6: ch.i1 = value; break;
+      case 7: ch.trip = value; break;
+      case 8: ch.rampup = value; break;
+      case 9: ch.rampdown = value; break;
+      case 10: ch.status |= 0x1; ch.vmon = ch.v0; data.push_back(ch.status); break;
+      case 11: ch.status &= ~0x1; ch.vmon = 0; data.push_back(ch.status); break;
+      case 12: case 13: case 14: case 15: case 16: case 17: break;
+      default: return std::make_pair(0xFF01,data);
+    }
+    return std::make_pair(0x0,data);
+  };
+}
+
+//////////////////////////////////////////
+// SimulatedCrate
+//////////////////////////////////////////
+
+SimulatedCrate::SimulatedCrate(SimulatedLatency latency):latency_(latency),irqMask_(0),cycles_(0),blockTransfers_(0),bytes_(0),chainToken_(0) {}
+
+void SimulatedCrate::add(std::unique_ptr<SimulatedBoard> board) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  board->crate_ = this;
+  boards_.push_back(std::move(board));
+}
+
+void SimulatedCrate::populate() {
+  add(new SimulatedV812());
+  add(new Simulated1151N());
+  SimulatedV288* caenet = add(new SimulatedV288());
+  caenet->attach(0x2,SimulatedV288::N470());
+  SimulatedTTCvi* ttc = add(new SimulatedTTCvi());
+  SimulatedV1190* tdc1 = add(new SimulatedV1190(0x00120000,false,0x0042));
+  SimulatedV1190* tdc2 = add(new SimulatedV1190(0x00AA0000,false,0x0043));
+  ttc->onL1A([tdc1](){ tdc1->trigger(); });
+  ttc->onL1A([tdc2](){ tdc2->trigger(); });
+}
+
+SimulatedBoard* SimulatedCrate::board(uint32_t address) const {
+  for(auto& b : boards_) {
+    if(b->decodes(address)) return b.get();
+  }
+  return nullptr;
+}
+
+SimulatedBoard* SimulatedCrate::decode(uint32_t& address, CVAddressModifier AM) const {
+  // truncate the address according to the address space
+  switch(AM) {
+    case cvA16_S: case cvA16_U: case cvA16_LCK:
+      address &= 0xFFFF; break;
+    case cvA24_S_BLT: case cvA24_S_PGM: case cvA24_S_DATA: case cvA24_S_MBLT:
+    case cvA24_U_BLT: case cvA24_U_PGM: case cvA24_U_DATA: case cvA24_U_MBLT:
+    case cvA24_LCK: case cvCR_CSR:
+      address &= 0xFFFFFF; break;
+    case cvA32_S_BLT: case cvA32_S_PGM: case cvA32_S_DATA: case cvA32_S_MBLT:
+    case cvA32_U_BLT: case cvA32_U_PGM: case cvA32_U_DATA: case cvA32_U_MBLT:
+    case cvA32_LCK:
+      break;
+    default:
+      return nullptr;
+  }
+  SimulatedBoard* b = board(address);
+  if(b) address -= b->baseAddress();
+  return b;
+}
+
+void SimulatedCrate::spend(std::chrono::steady_clock::time_point start, double ns) const {
+  if(ns<=0) return;
+  auto deadline = start + std::chrono::nanoseconds(uint64_t(ns));
+  // sleep for the bulk of long delays, then spin to be accurate
+  auto margin = std::chrono::microseconds(100);
+  if(deadline-std::chrono::steady_clock::now()>2*margin) std::this_thread::sleep_until(deadline-margin);
+  while(std::chrono::steady_clock::now()<deadline) {}
+}
+
+CVErrorCodes SimulatedCrate::read(uint32_t address, void* data, CVAddressModifier AM, CVDataWidth DW) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  ++cycles_;
+  CVErrorCodes status = cvBusError;
+  SimulatedBoard* b = decode(address,AM);
+  if(b && bytes(DW)<=4) {
+    uint32_t value = 0;
+    status = b->read(address,value,DW);
+    if(!status) store(data,value,DW);
+  }
+  spend(start,latency_.singleCycle);
+  return status;
+}
+
+CVErrorCodes SimulatedCrate::write(uint32_t address, const void* data, CVAddressModifier AM, CVDataWidth DW) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  ++cycles_;
+  CVErrorCodes status = cvBusError;
+  SimulatedBoard* b = decode(address,AM);
+  if(b && bytes(DW)<=4) status = b->write(address,load(data,DW),DW);
+  spend(start,latency_.singleCycle);
+  return status;
+}
+
+CVErrorCodes SimulatedCrate::readWrite(uint32_t address, void* data, CVAddressModifier AM, CVDataWidth DW) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  ++cycles_;
+  CVErrorCodes status = cvBusError;
+  SimulatedBoard* b = decode(address,AM);
+  if(b && bytes(DW)<=4) {
+    uint32_t value = 0;
+    status = b->read(address,value,DW);
+    if(!status) status = b->write(address,load(data,DW),DW);
+    if(!status) store(data,value,DW);
+  }
+  spend(start,latency_.singleCycle);
+  return status;
+}
+
+CVErrorCodes SimulatedCrate::blockRead(uint32_t address, unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, int* count) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  ++blockTransfers_;
+  *count = 0;
+  CVErrorCodes status = cvBusError;
+  SimulatedBoard* b = decode(address,AM);
+  if(b) {
+    status = b->blockRead(address,buffer,size,DW,count);
+  } else {
+    status = chainedRead(address,buffer,size,AM,count);
+  }
+  bytes_ += *count;
+  // MBLT moves 8 bytes per bus cycle instead of 4
+  spend(start,latency_.blockSetup+latency_.perByte*(*count)/(bytes(DW)==8 ? 2 : 1));
+  return status;
+}
+
+CVErrorCodes SimulatedCrate::chainedRead(uint32_t address, unsigned char* buffer, int size, CVAddressModifier AM, int* count) {
+  if(AM!=cvA32_U_BLT && AM!=cvA32_S_BLT && AM!=cvA32_U_MBLT && AM!=cvA32_S_MBLT) return cvBusError;
+  // boards of the chain, in the order of the crate, up to the last one
+  std::vector<SimulatedBoard*> chain;
+  bool terminated = false;
+  for(auto& b : boards_) {
+    uint8_t position = b->chainPosition(address);
+    if(position) chain.push_back(b.get());
+    if(position==1) {
+      terminated = true;
+      break;
+    }
+  }
+  if(chain.empty()) return cvBusError;
+  // the token goes from board to board, and the last one ends the transfer with a bus error.
+  // If the buffer is full before, the board keeps the token for the next transfer.
+  for(; chainToken_<chain.size(); ++chainToken_) {
+    int n = 0;
+    bool passed = chain[chainToken_]->chainedRead(buffer+*count, size-*count, &n);
+    *count += n;
+    if(!passed) return cvSuccess;
+  }
+  chainToken_ = 0;
+  // without a last board, nothing ends the transfer
+  return terminated ? cvBusError : cvSuccess;
+}
+
+CVErrorCodes SimulatedCrate::blockWrite(uint32_t address, const unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, int* count) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  ++blockTransfers_;
+  *count = 0;
+  CVErrorCodes status = cvBusError;
+  SimulatedBoard* b = decode(address,AM);
+  if(b) status = b->blockWrite(address,buffer,size,DW,count);
+  bytes_ += *count;
+  spend(start,latency_.blockSetup+latency_.perByte*(*count));
+  return status;
+}
+
+CVErrorCodes SimulatedCrate::addressOnly(uint32_t address, CVAddressModifier AM) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  ++cycles_;
+  CVErrorCodes status = decode(address,AM) ? cvSuccess : cvBusError;
+  spend(start,latency_.singleCycle);
+  return status;
+}
+
+CVErrorCodes SimulatedCrate::multiRead(const uint32_t* addresses, uint32_t* data, int n, const CVAddressModifier* AMs, const CVDataWidth* DWs, CVErrorCodes* ECs) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  // one round trip for the whole list, then the bus time of each cycle
+  CVErrorCodes status = cvSuccess;
+  double ns = latency_.singleCycle;
+  for(int i=0;i<n;++i) {
+    ++cycles_;
+    uint32_t address = addresses[i];
+    SimulatedBoard* b = decode(address,AMs[i]);
+    data[i] = 0;
+    ECs[i] = (b && bytes(DWs[i])<=4) ? b->read(address,data[i],DWs[i]) : cvBusError;
+    if(ECs[i] && !status) status = ECs[i];
+    ns += latency_.perByte*bytes(DWs[i]);
+  }
+  spend(start,ns);
+  return status;
+}
+
+CVErrorCodes SimulatedCrate::multiWrite(const uint32_t* addresses, const uint32_t* data, int n, const CVAddressModifier* AMs, const CVDataWidth* DWs, CVErrorCodes* ECs) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  CVErrorCodes status = cvSuccess;
+  double ns = latency_.singleCycle;
+  for(int i=0;i<n;++i) {
+    ++cycles_;
+    uint32_t address = addresses[i];
+    SimulatedBoard* b = decode(address,AMs[i]);
+    ECs[i] = (b && bytes(DWs[i])<=4) ? b->write(address,data[i],DWs[i]) : cvBusError;
+    if(ECs[i] && !status) status = ECs[i];
+    ns += latency_.perByte*bytes(DWs[i]);
+  }
+  spend(start,ns);
+  return status;
+}
+
+uint8_t SimulatedCrate::pendingIRQs() const {
+  uint8_t mask = 0;
+  for(auto& b : boards_) {
+    uint8_t level = b->irqLevel();
+    if(level) mask |= 1<<(level-1);
+  }
+  return mask;
+}
+
+void SimulatedCrate::notify() {
+  irqCondition_.notify_all();
+}
+
+CVErrorCodes SimulatedCrate::IRQEnable(uint32_t mask) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  irqMask_ |= mask&0x7F;
+  spend(start,latency_.irq);
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedCrate::IRQDisable(uint32_t mask) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  irqMask_ &= ~mask;
+  spend(start,latency_.irq);
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedCrate::IRQWait(uint32_t mask, uint32_t timeout_ms) {
+  std::unique_lock<std::recursive_mutex> lock(mutex_);
+  bool fired = irqCondition_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                      [this,mask](){ return pendingIRQs() & irqMask_ & mask; });
+  return fired ? cvSuccess : cvTimeoutError;
+}
+
+CVErrorCodes SimulatedCrate::IRQCheck(unsigned char* mask) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  *mask = pendingIRQs();
+  spend(start,latency_.irq);
+  return cvSuccess;
+}
+
+CVErrorCodes SimulatedCrate::IACK(CVIRQLevels level, void* vector, CVDataWidth DW) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto start = std::chrono::steady_clock::now();
+  CVErrorCodes status = cvBusError;
+  for(auto& b : boards_) {
+    uint8_t l = b->irqLevel();
+    if(l && (1<<(l-1))==level) {
+      store(vector,b->iack(),DW);
+      status = cvSuccess;
+      break;
+    }
+  }
+  spend(start,latency_.irq);
+  return status;
+}
+
+void SimulatedCrate::systemReset() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  for(auto& b : boards_) b->systemReset();
+  irqMask_ = 0;
+  chainToken_ = 0;
+}
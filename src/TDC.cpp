@@ -17,6 +17,9 @@
 */
 
 #include "TDC.h"
+#include "V1190Decoder.h"
+#include "VmeSimulator.h"
+#include "VmeUsbBridge.h"
 #include "PythonModule.h"
 
 #include <vector>
@@ -24,60 +27,54 @@
 #include <iostream>
 using namespace std;
 
-unsigned int digit(unsigned int data, int begin, int end) {
-    if (begin<end){return -1;}
-    else return (((1<<(begin+1))-1)&data)>>end;
-}
-
-unsigned int digit(unsigned int data, int position) {
-    return (data>>position)&1;
-}
-
-Tdc::Tdc(VmeController* controller,uint32_t address):VmeBoard(controller, address, cvA32_U_DATA, cvD16, true) {
-  opcode_=baseAddress()+0x102E;
-  statusRegister_=baseAddress()+0x1002;
-  microHandshake_=baseAddress()+0x1030;
-  outputBuffer_=baseAddress()+0x0000;
-  eventFIFO_=baseAddress()+0x1038;
-  controlRegister_=baseAddress()+0x1000;
-  // check configuration ROM and firmware version
-  info_.moduletype_ = readData<uint16_t>(baseAddress()+0x403C)&0xFF;
-  info_.moduletype_ |= (readData<uint16_t>(baseAddress()+0x4038)&0xFF)<<8;
-  info_.moduletype_ |= (readData<uint16_t>(baseAddress()+0x4034)&0xFF)<<16;
+Tdc::Tdc(VmeController* controller,uint32_t address):VmeBoard(controller, address, cvA32_U_DATA, cvD16, true), blockTransfer_(cvBLT), readout_(32768*sizeof(uint32_t)) {
+  // check configuration ROM and firmware version, all read in one go
+  VmeBatch rom = batch();
+  for(int i=2;i>=0;--i) rom.read<Registers::BoardId>(baseAddress(),i);
+  rom.read<Registers::Version>(baseAddress());
+  for(int i=2;i>=0;--i) rom.read<Registers::Oui>(baseAddress(),i);
+  for(int i=1;i>=0;--i) rom.read<Registers::SerialNumber>(baseAddress(),i);
+  for(int i=3;i>=0;--i) rom.read<Registers::Revision>(baseAddress(),i);
+  rom.read<Registers::FirmwareRevision>(baseAddress());
+  rom.flush();
+  info_.moduletype_ = (rom[0]&0xFF) | (rom[1]&0xFF)<<8 | (rom[2]&0xFF)<<16;
   assert(info_.moduletype_==0x04A6);
-  info_.version_ = readData<uint16_t>(baseAddress()+0x4030)&0x1;
-  info_.manufacturer_ = readData<uint16_t>(baseAddress()+0x402C)&0xFF;
-  info_.manufacturer_ |= (readData<uint16_t>(baseAddress()+0x4028)&0xFF)<<8;
-  info_.manufacturer_ |= (readData<uint16_t>(baseAddress()+0x4024)&0xFF)<<16;
+  info_.version_ = rom[3]&0x1;
+  info_.manufacturer_ = (rom[4]&0xFF) | (rom[5]&0xFF)<<8 | (rom[6]&0xFF)<<16;
   assert(info_.manufacturer_==0x40E6);
   // revision, serial number
-  info_.serial_number_ = readData<uint16_t>(baseAddress()+0x4084)&0xFF;
-  info_.serial_number_ |= (readData<uint16_t>(baseAddress()+0x4080)&0xFF)<<8;
-  info_.revision_major_ = readData<uint16_t>(baseAddress()+0x404C)&0xFF;
-  info_.revision_major_ |= (readData<uint16_t>(baseAddress()+0x4048)&0xFF)<<8;
-  info_.revision_minor_ = readData<uint16_t>(baseAddress()+0x4044)&0xFF;
-  info_.revision_minor_ |= (readData<uint16_t>(baseAddress()+0x4040)&0xFF)<<8;
+  info_.serial_number_ = (rom[7]&0xFF) | (rom[8]&0xFF)<<8;
+  info_.revision_major_ = (rom[9]&0xFF) | (rom[10]&0xFF)<<8;
+  info_.revision_minor_ = (rom[11]&0xFF) | (rom[12]&0xFF)<<8;
   // firmware version
-  info_.firmwareVersion_ = readData<uint16_t>(baseAddress()+0x1026)&0xFF;
+  info_.firmwareVersion_ = rom[13]&0xFF;
   
   LOG_DEBUG("CAEN V1190"+ ((info_.version_&0x1) ? string("B") : string("A")) + " initialized. " + 
             "Serial number: " + int_to_hex(info_.serial_number_) + 
             " rev. " + to_string(info_.revision_major_) + "." + to_string(info_.revision_minor_) + 
             " fw. "  + to_string(info_.firmwareVersion_>>4) + "." + to_string(info_.firmwareVersion_&0xF));
+
+  // configuration registers, read from the shadow cache when enabled
+  setCachePolicy<Registers::Control>(cvWriteThrough);
+  setCachePolicy<Registers::InterruptLevel>(cvWriteThrough);
+  setCachePolicy<Registers::InterruptVector>(cvWriteThrough);
+  setCachePolicy<Registers::MCSTBaseAddress>(cvWriteThrough);
+  setCachePolicy<Registers::MCSTControl>(cvWriteThrough);
+  setCachePolicy<Registers::GeoAddress>(cvWriteThrough);
+  setCachePolicy<Registers::AlmostFullLevel>(cvWriteThrough);
+  setCachePolicy<Registers::BLTEventNumber>(cvWriteThrough);
 }
 
 V1190ControlRegister Tdc::getControlRegister(){
-  return V1190ControlRegister(readData<uint16_t>(controlRegister_));
+  return V1190ControlRegister(read<Registers::Control>());
 }
 
 void Tdc::setControlRegister(V1190ControlRegister& reg){
-  writeData(controlRegister_, reg.registr());
+  write<Registers::Control>(reg.registr());
 }
 
 void Tdc::enableFIFO(bool enable) {
-  V1190ControlRegister reg = getControlRegister();
-  reg.setBit(V1190ControlRegister::cvFIFOEN,enable);
-  setControlRegister(reg);
+  setField<Registers::FIFOEnable>(enable);
   if(enable) {
     LOG_INFO("FIFO enabled !") 
   } else {
@@ -86,9 +83,7 @@ void Tdc::enableFIFO(bool enable) {
 }
 
 void Tdc::enableBERR(bool enable) {
-  V1190ControlRegister reg = getControlRegister();
-  reg.setBit(V1190ControlRegister::cvBERREN,enable);
-  setControlRegister(reg);
+  setField<Registers::BERREnable>(enable);
   if(enable) {
     LOG_INFO("BERR enabled !") 
   } else {
@@ -97,9 +92,7 @@ void Tdc::enableBERR(bool enable) {
 }
 
 void Tdc::enableExtdTrigTime(bool enable) {
-  V1190ControlRegister reg = getControlRegister();
-  reg.setBit(V1190ControlRegister::cvEXTDTTEN,enable);
-  setControlRegister(reg);
+  setField<Registers::ExtdTriggerTimeEnable>(enable);
   if(enable) { 
     LOG_INFO("Extended Trigger Time Tag enabled !") 
   } else {
@@ -108,9 +101,7 @@ void Tdc::enableExtdTrigTime(bool enable) {
 }
 
 void Tdc::enableCompensation(bool enable) {
-  V1190ControlRegister reg = getControlRegister();
-  reg.setBit(V1190ControlRegister::cvCOMPEN,enable);
-  setControlRegister(reg);
+  setField<Registers::CompensationEnable>(enable);
   if(enable) {
     LOG_INFO("Compensation enabled !") 
   } else {
@@ -118,186 +109,220 @@ void Tdc::enableCompensation(bool enable) {
   }
 }
 
+void Tdc::setBlockTransferMode(Tdc::CVBlockTransfer mode) {
+  // with 64 bits alignment, a filler is added to the events with an odd number of words
+  setField<Registers::Align64>(mode==cvMBLT);
+  blockTransfer_ = mode;
+  if(mode==cvMBLT) {
+    LOG_INFO("MBLT readout enabled !")
+  } else {
+    LOG_INFO("BLT readout enabled !");
+  }
+}
+
 V1190StatusRegister Tdc::getStatus() {
-  return V1190StatusRegister(readData<uint16_t>(statusRegister_));
+  return V1190StatusRegister(read<Registers::Status>());
 }
 
 void Tdc::setInterrupt(uint8_t level, uint16_t vector) {
-  writeData(baseAddress()+0x100A, (uint16_t)level);
-  writeData(baseAddress()+0x100C, vector);
+  write<Registers::InterruptLevel>(level);
+  write<Registers::InterruptVector>(vector);
 }
 
 void Tdc::reset(bool moduleReset, bool softClear, bool softEvtReset) {
-  if(moduleReset) { writeData(baseAddress() +0x1014, 0); LOG_INFO("Module Reset"); }
-  if(softClear) { writeData(baseAddress() +0x1016, 0); LOG_INFO("Software Clear"); }
-  if(softEvtReset) { writeData(baseAddress() +0x1018, 0); LOG_INFO("Software Event Reset"); }
+  if(moduleReset) { write<Registers::ModuleReset>(0); invalidateCache(); LOG_INFO("Module Reset"); }
+  if(softClear) { write<Registers::SoftwareClear>(0); LOG_INFO("Software Clear"); }
+  if(softEvtReset) { write<Registers::SoftwareEventReset>(0); LOG_INFO("Software Event Reset"); }
 }
 
 void Tdc::trigger() {
-  writeData(baseAddress() +0x101A, 0);
+  write<Registers::SoftwareTrigger>(0);
   LOG_INFO("Software Trigger generated.");
 }
 
 uint32_t Tdc::eventCount() {
-  return controller()->mode(cvA32_U_DATA,cvD32)->readData<uint32_t>(baseAddress() +0x101C);
+  return read<Registers::EventCounter>();
 }
 
 uint16_t Tdc::storedEventCount() {
-  return readData<uint16_t>(baseAddress() +0x1020);
+  return read<Registers::EventStored>();
 }
 
 void Tdc::setAlmostFullLevel(uint16_t level) {
-  writeData(baseAddress() +0x1022,level);
+  write<Registers::AlmostFullLevel>(level);
   LOG_INFO("Set almost-full level to " + to_string(level));
 }
 
 uint16_t Tdc::getAlmostFullLevel() {
-  return readData<uint16_t>(baseAddress() +0x1022);
+  return read<Registers::AlmostFullLevel>();
 }
 
 std::pair<uint16_t,uint16_t> Tdc::readFIFO() {
-  uint32_t data = controller()->mode(cvA32_U_DATA,cvD32)->readData<uint32_t>(baseAddress() +0x1038);
-  return make_pair(data>>16,data&0xFFFF);
+  uint32_t data = read<Registers::EventFIFO>();
+  return make_pair(Registers::FIFOEventCount::get(data),Registers::FIFOWordCount::get(data));
 }
 
 uint16_t Tdc::getFIFOCount() {
-  return readData<uint16_t>(baseAddress() +0x103C)&0x7FF;
+  return Registers::FIFOStoredCount::get(read<Registers::EventFIFOStored>());
 }
 
 uint8_t Tdc::getFIFOStatus() {
-  return readData<uint16_t>(baseAddress() +0x103E)&0x3;
+  return Registers::FIFOStatus::get(read<Registers::EventFIFOStatus>());
+}
+
+void Tdc::setGeoAddress(uint8_t geo) {
+  write<Registers::GeoAddress>(Registers::Geo::set(0,geo));
+}
+
+uint8_t Tdc::getGeoAddress() {
+  return Registers::Geo::get(read<Registers::GeoAddress>());
+}
+
+void Tdc::setBLTEventNumber(uint8_t events) {
+  write<Registers::BLTEventNumber>(events);
+}
+
+uint8_t Tdc::getBLTEventNumber() {
+  return read<Registers::BLTEventNumber>()&0xFF;
+}
+
+void Tdc::setChain(uint8_t address, Tdc::CVChainPosition position) {
+  write<Registers::MCSTBaseAddress>(Registers::MCSTAddress::set(0,address));
+  write<Registers::MCSTControl>(Registers::ChainPosition::set(0,position));
+}
+
+std::pair<uint8_t, Tdc::CVChainPosition> Tdc::getChain() {
+  uint8_t address = Registers::MCSTAddress::get(read<Registers::MCSTBaseAddress>());
+  return make_pair(address, Tdc::CVChainPosition(Registers::ChainPosition::get(read<Registers::MCSTControl>())));
 }
 
 V1190Event Tdc::getEvent(bool useFIFO) {
+  return readEvent(bus(), useFIFO);
+}
+
+template<typename Bus> V1190Event Tdc::readEvent(const Bus& bus, bool useFIFO) {
   waitDataReady();
-  V1190Event event;
-  TDCEvent tdc;
+  std::vector<V1190Event> event;
+  V1190Decoder decoder;
+  V1190EventSink sink(event);
   uint32_t data;
-  bool tdcHeadersEnabled = false;
   uint16_t eventId, nwords;
   if(useFIFO) {
-    std::tie(eventId, nwords) = readFIFO();
+    uint32_t fifo = bus.template read<Registers::EventFIFO>(baseAddress());
+    eventId = Registers::FIFOEventCount::get(fifo);
+    nwords = Registers::FIFOWordCount::get(fifo);
   }
-  // in D32 readout, read until we get to the trailer and fill progressively the event record
+  // in D32 readout, read until we get to the trailer, decoding word by word
   for(uint16_t i=0; !(useFIFO&&i) || (i<nwords);++i) { 
-    data = controller()->mode(cvA32_U_DATA,cvD32)->readData<uint32_t>(baseAddress());
-    switch(data>>27) {
-      case 0x8: // global header
-        event = V1190Event(data);
-        if(useFIFO && event.getEventCount()!=eventId)
-          LOG_WARN("Event Count mismatch: Expected " + to_string(eventId) + " from FIFO but got " 
-                   + to_string(event.getEventCount()) + " in the output buffer.");
-        break;
-      case 0x10: // global trailer
-        event.setStatus((data>>24)&0x7);
-        return event;
-      case 0x11: // extended trigger time
-        event.setExtdTriggerTime(data);
-        break;
-      case 0x1: // TDC header
-        tdc = TDCEvent(data);
-        tdcHeadersEnabled = true;
-        break;
-      case 0x0: // measurement
-        if(tdcHeadersEnabled) {
-          tdc.addHit(TDCHit(data));
-        } else {
-          event.addHit(TDCHit(data));
-        }
-        break;
-      case 0x4: // TDC Error
-        tdc.setErrorFlags(data);
-        break;
-      case 0x3: // TDC trailer
-        event.addTDCEvent(tdc);
-        break;
-      case 0x18: // Filler... this should never happen.
-        break;
+    data = bus.template read<Registers::OutputBuffer>(baseAddress());
+    if(decoder.decode(&data, 1, sink)) {
+      if(useFIFO && event[0].getEventCount()!=eventId)
+        LOG_WARN("Event Count mismatch: Expected " + to_string(eventId) + " from FIFO but got " 
+                 + to_string(event[0].getEventCount()) + " in the output buffer.");
+      return event[0];
     }
   }
   LOG_WARN("Read " + to_string(nwords) + " words from the output buffer without getting the Global Trailer.");
-  return event;
+  return V1190Event();
 }
 
 std::vector<V1190Event> Tdc::getEvents(bool useFIFO) {
-  waitDataReady();
-  unsigned char* buffer = NULL;
+  return readEvents(bus(), useFIFO);
+}
+
+template<typename Bus> std::vector<V1190Event> Tdc::readEvents(const Bus& bus, bool useFIFO) {
   std::vector<V1190Event> output;
-  std::vector<uint32_t> input;
-  V1190Event event;
-  TDCEvent tdc;
-  bool tdcHeadersEnabled = false;
+  waitDataReady();
+  readBuffer(bus, readout_, useFIFO);
+  decode(readout_.data<uint32_t>(), readout_.count<uint32_t>(), output);
+  return output;
+}
+
+size_t Tdc::getEvents(EventBatch& batch, bool useFIFO) {
+  size_t events = batch.size();
+  waitDataReady();
+  readBuffer(bus(), readout_, useFIFO);
+  decode(readout_.data<uint32_t>(), readout_.count<uint32_t>(), batch);
+  return batch.size()-events;
+}
+
+void Tdc::readRaw(ReadoutBuffer& buffer, bool useFIFO) {
+  readBuffer(bus(), buffer, useFIFO);
+}
+
+bool Tdc::isDataReady() {
+  return Registers::DataReady::get(read<Registers::Status>());
+}
+
+template<typename Bus> void Tdc::readBuffer(const Bus& bus, ReadoutBuffer& buffer, bool useFIFO) {
   uint32_t nwords = 256;
-  int count = 0;
   // if FIFO is enabled: compute exact nwords
   if(useFIFO) {
     // Calculate Nw: number of words which compose the events
     nwords=0;
-    uint16_t fifoCount = getFIFOCount();
+    uint16_t fifoCount = Registers::FIFOStoredCount::get(bus.template read<Registers::EventFIFOStored>(baseAddress()));
     for(int i=0; i< fifoCount; ++i) {
-      nwords += readFIFO().second;
+      uint32_t words = Registers::FIFOWordCount::get(bus.template read<Registers::EventFIFO>(baseAddress()));
+      // in MBLT, each event is aligned to 64 bits, whether the count includes the filler or not
+      nwords += blockTransfer_==cvMBLT ? (words+1)&~1u : words;
     }
   }
-  // read all
+  // read all, appending to the readout buffer (no allocation once it is large enough)
+  buffer.clear();
   bool done = false;
   while(!done) {
-    std::vector<uint32_t> tmp; 
-    // read n 32 bits words (from FIFO or default)
-    try {
-      tmp = controller()->mode(cvA32_U_BLT,cvD32)->blockReadData<uint32_t>(baseAddress(), nwords);
-    } catch(CAENVMEexception &e) {
-      // note: BERR stop condition should be avoided, since this implementation would discard the last BLT read.
-      done = true;
-    }
-    // copy to the input vector
-    input.insert(input.end(),tmp.begin(),tmp.end());
-    // stop conditions: BERR (above), useFIFO (one BLT is enough), or buffer empty
-    if(useFIFO) done = true;
-    done = (!(readData<uint16_t>(this->statusRegister_)&0x1));
+    VmeTransfer transfer = blockRead(bus, buffer, nwords);
+    // stop conditions: BERR (end of the data, what was read is kept in the buffer), useFIFO (one BLT is enough),
+    // or buffer empty
+    done = transfer.status==cvBusError || useFIFO ||
+           !Registers::DataReady::get(bus.template read<Registers::Status>(baseAddress()));
   }
-  // then loop on the data retrieved and create events
-  for(auto data : input) {
-    switch(data>>27) {
-      case 0x8: // global header
-        event = V1190Event(data);
-        tdcHeadersEnabled = false;
-        break;
-      case 0x10: // global trailer
-        event.setStatus((data>>24)&0x7);
-        output.push_back(event);
-        break;
-      case 0x11: // extended trigger time
-        event.setExtdTriggerTime(data);
-        break;
-      case 0x1: // TDC header
-        tdc = TDCEvent(data);
-        tdcHeadersEnabled = true;
-        break;
-      case 0x0: // measurement
-        if(tdcHeadersEnabled) {
-          tdc.addHit(TDCHit(data));
-        } else {
-          event.addHit(TDCHit(data));
-        }
-        break;
-      case 0x4: // TDC Error
-        tdc.setErrorFlags(data);
-        break;
-      case 0x3: // TDC trailer
-        event.addTDCEvent(tdc);
-        break;
-      case 0x18: // Filler... 
-        break;
-    }
+}
+
+size_t Tdc::readOutputBuffer(ReadoutBuffer& buffer, uint32_t nwords) {
+  return blockRead(bus(), buffer, nwords).bytes/sizeof(uint32_t);
+}
+
+template<typename Bus> VmeTransfer Tdc::blockRead(const Bus& bus, ReadoutBuffer& buffer, uint32_t nwords) {
+  while(true) {
+    // read n 32 bits words (from FIFO or default). In MBLT, the events are aligned to 64 bits: nwords is even.
+    // No exception on failure: the BERR which ends the data is the normal case.
+    VmeTransfer transfer = blockTransfer_==cvMBLT ?
+      bus.template tryBlockRead<Registers::OutputBufferMBLT>(baseAddress(), buffer, (nwords+1)/2, true) :
+      bus.template tryBlockRead<Registers::OutputBufferBLT>(baseAddress(), buffer, nwords);
+    if(transfer.status==cvSuccess || transfer.status==cvBusError) return transfer;
+    // only a rejected MBLT cycle means that the controller does not support it: the other errors are real failures
+    if(blockTransfer_!=cvMBLT || transfer.status!=cvInvalidParam) throw_with_trace(CAENVMEexception(transfer.status));
+    // BLT from now on, without the 64 bits alignment fillers
+    LOG_WARN("MBLT readout failed (" + string(CAENVME_DecodeError(transfer.status)) + "): falling back to BLT.");
+    setBlockTransferMode(cvBLT);
   }
-  return output;
 }
 
+void Tdc::decode(const uint32_t* data, size_t n, std::vector<V1190Event>& output) {
+  V1190Decoder decoder;
+  V1190EventSink sink(output);
+  decoder.decode(data, n, sink);
+}
+
+void Tdc::decode(const uint32_t* data, size_t n, EventBatch& output) {
+  V1190Decoder decoder;
+  decoder.decode(data, n, output);
+}
+
+// readout with statically dispatched cycles
+template V1190Event Tdc::readEvent(const VmeStaticController<VmeSimulator>&, bool);
+template V1190Event Tdc::readEvent(const VmeStaticController<VmeUsbBridge>&, bool);
+template std::vector<V1190Event> Tdc::readEvents(const VmeStaticController<VmeSimulator>&, bool);
+template std::vector<V1190Event> Tdc::readEvents(const VmeStaticController<VmeUsbBridge>&, bool);
+template void Tdc::readBuffer(const VmeStaticController<VmeSimulator>&, ReadoutBuffer&, bool);
+template void Tdc::readBuffer(const VmeStaticController<VmeUsbBridge>&, ReadoutBuffer&, bool);
+
 TDCHit Tdc::getHit()
 {
   waitDataReady();
   // read one word, interpret it as a hit and return the result
-  return TDCHit(controller()->mode(cvA32_U_DATA,cvD32)->readData<uint32_t>(baseAddress()));
+  return TDCHit(read<Registers::OutputBuffer>());
 }
 
 void Tdc::setAcquisitionMode(Tdc::CVAcquisitionMode mode) {
@@ -331,6 +356,8 @@ void Tdc::setStartupConfiguration(Tdc::CVConfiguration conf) {
 }
 
 void Tdc::setTriggerWindow(Tdc::WindowConfiguration &conf) {
+  // note: this cannot be sent as a list of cycles, since the micro controller
+  // handshake (WRITE_OK) has to be checked before each word.
   writeOpcode(0x1000);
   writeOpcode(conf.width);
   writeOpcode(0x1100);
@@ -475,35 +502,28 @@ std::bitset<128> Tdc::readEnablePattern(){
 /////  UTILITIES ///////
 
 void Tdc::waitRead(void) {
-  uint16_t data;
-  do {
-    data = readData<uint16_t>(this->microHandshake_);
-  } while(!(data&0x2));
+  waitFor([this]() { return Registers::ReadOk::get(read<Registers::MicroHandshake>()); });
 }
 
 void Tdc::waitWrite(void) {
-  uint16_t data;
-  do {
-    data = readData<uint16_t>(this->microHandshake_);
-  } while(!(data&0x1));
+  waitFor([this]() { return Registers::WriteOk::get(read<Registers::MicroHandshake>()); });
 }
 
 void Tdc::waitDataReady(void) {
-  uint16_t data;
-  do {
-    data = readData<uint16_t>(this->statusRegister_);
-  } while(!(data&0x1));
+  auto ready = [this]() { return Registers::DataReady::get(read<Registers::Status>()); };
+  if(dataReadyPolicy_) dataReadyPolicy_->wait(ready);
+  else waitFor(ready);
 }
 
 void Tdc::writeOpcode(uint16_t data) {
   waitWrite();
-  writeData(opcode_,data);
+  write<Registers::Micro>(data);
 }
 
 uint16_t Tdc::readOpcode()
 {
   waitRead();
-  return readData<uint16_t>(opcode_);
+  return read<Registers::Micro>();
 }
 
 using namespace boost::python;
@@ -546,7 +566,7 @@ template<> void exposeToPython<V1190Event>() {
     .def("getHits",&V1190Event::getHits,return_value_policy<copy_const_reference>())
     .def("getTDCEvents",&V1190Event::getTDCEvents,return_value_policy<copy_const_reference>())
     .def("addHit",&V1190Event::addHit)
-    .def("addTDCEvent",&V1190Event::addTDCEvent)
+    .def("addTDCEvent",static_cast<void (V1190Event::*)(TDCEvent&)>(&V1190Event::addTDCEvent))
     .def("toString",&V1190Event::toString)
   ;
   class_<std::vector<V1190Event> >("vec_v1190event")
@@ -603,14 +623,16 @@ template<> void exposeToPython<V1190StatusRegister>() {
 }
 
 template<> void exposeToPython<Tdc>() {
-  scope in_Tdc = class_<Tdc>("Tdc",init<VmeController*,uint32_t>())
+  scope in_Tdc = class_<Tdc, bases<VmeBoard> >("Tdc",init<VmeController*,uint32_t>())
     .def("getModuleInfo", &Tdc::getModuleInfo)
+    .add_property("dataReadyPolicy", &Tdc::getDataReadyPolicy, &Tdc::setDataReadyPolicy)
     .def("getControlRegister", &Tdc::getControlRegister)
     .def("setControlRegister", &Tdc::setControlRegister)
     .def("enableFIFO", &Tdc::enableFIFO)
     .def("enableBERR", &Tdc::enableBERR)
     .def("enableExtdTrigTime", &Tdc::enableExtdTrigTime)
     .def("enableCompensation", &Tdc::enableCompensation)
+    .add_property("blockTransferMode", &Tdc::getBlockTransferMode, &Tdc::setBlockTransferMode)
     .def("getStatus", &Tdc::getStatus)
     .def("setInterrupt", &Tdc::setInterrupt)
     .def("reset", &Tdc::reset)
@@ -622,8 +644,15 @@ template<> void exposeToPython<Tdc>() {
     .def("readFIFO", &Tdc::readFIFO)
     .def("getFIFOCount", &Tdc::getFIFOCount)
     .def("getFIFOStatus", &Tdc::getFIFOStatus)
-    .def("getEvent", &Tdc::getEvent)
-    .def("getEvents", &Tdc::getEvents)
+    .def("setGeoAddress", &Tdc::setGeoAddress)
+    .def("getGeoAddress", &Tdc::getGeoAddress)
+    .def("setBLTEventNumber", &Tdc::setBLTEventNumber)
+    .def("getBLTEventNumber", &Tdc::getBLTEventNumber)
+    .def("setChain", &Tdc::setChain)
+    .def("getChain", &Tdc::getChain)
+    .def("getEvent", static_cast<V1190Event (Tdc::*)(bool)>(&Tdc::getEvent))
+    .def("getEvents", static_cast<std::vector<V1190Event> (Tdc::*)(bool)>(&Tdc::getEvents))
+    .def("getEvents", static_cast<size_t (Tdc::*)(EventBatch&, bool)>(&Tdc::getEvents))
     .def("getHit", &Tdc::getHit)
     .def("writeOpcode", &Tdc::writeOpcode)
     .def("readOpcode", &Tdc::readOpcode)
@@ -669,6 +698,16 @@ template<> void exposeToPython<Tdc>() {
     .def("computeOffset",&Tdc::WindowConfiguration::computeOffset)
     .staticmethod("computeOffset") 
   ;
+  enum_<Tdc::CVBlockTransfer>("CVBlockTransfer")
+    .value("cvBLT", Tdc::CVBlockTransfer::cvBLT)
+    .value("cvMBLT", Tdc::CVBlockTransfer::cvMBLT)
+  ;
+  enum_<Tdc::CVChainPosition>("CVChainPosition")
+    .value("cvNotChained", Tdc::CVChainPosition::cvNotChained)
+    .value("cvLastBoard", Tdc::CVChainPosition::cvLastBoard)
+    .value("cvFirstBoard", Tdc::CVChainPosition::cvFirstBoard)
+    .value("cvIntermediateBoard", Tdc::CVChainPosition::cvIntermediateBoard)
+  ;
   enum_<Tdc::CVAcquisitionMode>("CVAcquisitionMode")
     .value("cvContinuous", Tdc::CVAcquisitionMode::cvContinuous)
     .value("cvTrigger", Tdc::CVAcquisitionMode::cvTrigger)
@@ -724,4 +763,8 @@ template<> void exposeToPython<Tdc>() {
     .def_readwrite("first", &std::pair<uint16_t,uint16_t>::first)
     .def_readwrite("second", &std::pair<uint16_t,uint16_t>::second)
   ;
+  class_<std::pair<uint8_t,Tdc::CVChainPosition> >("Chain")
+    .def_readwrite("first", &std::pair<uint8_t,Tdc::CVChainPosition>::first)
+    .def_readwrite("second", &std::pair<uint8_t,Tdc::CVChainPosition>::second)
+  ;
 }
@@ -23,151 +23,146 @@
 using namespace std;
 
 TtcVi::TtcVi(VmeController* controller,int address):VmeBoard(controller, address, cvA32_U_DATA, cvD16, true) {
-  info_.manufacturer_ = readData<uint16_t>(baseAddress()+0x2E)&0xFF;
-  info_.manufacturer_ |= (readData<uint16_t>(baseAddress()+0x2A)&0xFF)<<8;
-  info_.manufacturer_ |= (readData<uint16_t>(baseAddress()+0x26)&0xFF)<<16;
+  // the configuration EEPROM, all read in one go
+  VmeBatch rom = batch();
+  for(int i=2;i>=0;--i) rom.read<Registers::Manufacturer>(baseAddress(),i);
+  for(int i=3;i>=0;--i) rom.read<Registers::SerialNumber>(baseAddress(),i);
+  for(int i=3;i>=0;--i) rom.read<Registers::Revision>(baseAddress(),i);
+  rom.flush();
+  info_.manufacturer_ = (rom[0]&0xFF) | (rom[1]&0xFF)<<8 | (rom[2]&0xFF)<<16;
   assert(info_.manufacturer_==0x80030);
-  info_.serial_number_ = readData<uint16_t>(baseAddress()+0x3E)&0xFF;
-  info_.serial_number_ |= (readData<uint16_t>(baseAddress()+0x3A)&0xFF)<<8;
-  info_.serial_number_ |= (readData<uint16_t>(baseAddress()+0x36)&0xFF)<<16;
-  info_.serial_number_ |= (readData<uint16_t>(baseAddress()+0x32)&0xFF)<<24;
-  info_.revision_ = readData<uint16_t>(baseAddress()+0x4E)&0xFF;
-  info_.revision_ |= (readData<uint16_t>(baseAddress()+0x4A)&0xFF)<<8;
-  info_.revision_ |= (readData<uint16_t>(baseAddress()+0x46)&0xFF)<<16;
-  info_.revision_ |= (readData<uint16_t>(baseAddress()+0x42)&0xFF)<<24;
+  info_.serial_number_ = (rom[3]&0xFF) | (rom[4]&0xFF)<<8 | (rom[5]&0xFF)<<16 | (rom[6]&0xFF)<<24;
+  info_.revision_ = (rom[7]&0xFF) | (rom[8]&0xFF)<<8 | (rom[9]&0xFF)<<16 | (rom[10]&0xFF)<<24;
   
   LOG_INFO("TTCvi initialized. Serial number: " + int_to_hex(info_.serial_number_) + 
             " rev. " + to_string(info_.revision_) );
+
+  // configuration registers, read from the shadow cache when enabled (except the L1A FIFO status)
+  setCachePolicy<Registers::CSR1>(cvWriteThrough);
+  setCachePolicy<Registers::BGoMode>(cvWriteThrough);
 }
 
 void TtcVi::reset(){
-  writeData(baseAddress()+0x84,0);
+  write<Registers::ModuleReset>(0);
+  invalidateCache();
 }
 
 void TtcVi::trigger(){
-  writeData(baseAddress()+0x86,0);
+  write<Registers::SoftwareL1A>(0);
 }
 
 void TtcVi::resetCounter(){
-  writeData(baseAddress()+0x8C,0);
+  write<Registers::ResetCounter>(0);
 }
 
 uint32_t TtcVi::getEventNumber(){
-  uint32_t event = readData<uint16_t>(baseAddress()+0x8A);
-  event |= ((readData<uint16_t>(baseAddress()+0x88)&0xFF)<<16);
-  return event;
+  VmeBatch counter = batch();
+  counter.read<Registers::EventCounterLSW>(baseAddress());
+  counter.read<Registers::EventCounterMSW>(baseAddress());
+  counter.flush();
+  return (counter[0]&0xFFFF) | ((counter[1]&0xFF)<<16);
 }
 
 void TtcVi::setEventCounter(uint32_t count){
-  writeData(baseAddress()+0x8A,count&0xFFFF);
-  writeData(baseAddress()+0x88,(count>>16)&0xFF);
+  VmeBatch counter = batch();
+  counter.write<Registers::EventCounterLSW>(baseAddress(),count&0xFFFF);
+  counter.write<Registers::EventCounterMSW>(baseAddress(),(count>>16)&0xFF);
+  counter.flush();
 }
 
 void TtcVi::setCounterMode(bool orbit){
-  uint16_t csr1 = readCSR1();
-  if(orbit) { csr1 = csr1 |= (1<<15); }
-  else { csr1 = csr1 &= 0x7FFF; }
-  writeCSR1(csr1);
+  setField<Registers::OrbitCount>(orbit);
 }
 
 TtcVi::CVTriggerChannel TtcVi::getTriggerChannel(){
-  uint16_t csr1 = readCSR1();
-  return TtcVi::CVTriggerChannel(csr1&0x7);
+  return TtcVi::CVTriggerChannel(readField<Registers::TriggerSelect>());
 }
   
 void TtcVi::setTriggerChannel(TtcVi::CVTriggerChannel channel){
-  uint16_t csr1 = readCSR1();
-  csr1 = (csr1&0xFFF8)|int(channel);
-  writeCSR1(csr1);
+  setField<Registers::TriggerSelect>(channel);
 }
   
 TtcVi::CVTriggerRate TtcVi::getRandomTriggerRate(){
-  uint16_t csr1 = readCSR1();
-  return TtcVi::CVTriggerRate((csr1>>12)&0x7);
+  return TtcVi::CVTriggerRate(readField<Registers::RandomRate>());
 }
   
 void TtcVi::setRandomTriggerRate(TtcVi::CVTriggerRate rate){
-  uint16_t csr1 = readCSR1();
-  csr1 = (csr1&0x8FFF)|(int(rate)<<12);
-  writeCSR1(csr1);
+  setField<Registers::RandomRate>(rate);
 }
   
 uint8_t TtcVi::getFIFOStatus(){
-  uint16_t csr1 = readCSR1();
-  return (csr1>>4)&0x3;
+  return readField<Registers::L1FIFOStatus>();
 }
   
 void TtcVi::resetL1FIFO(){
-  uint16_t csr1 = readCSR1();
-  csr1 |= 0x40;
-  writeCSR1(csr1);
+  setField<Registers::ResetL1FIFO>();
 }
   
 uint8_t TtcVi::getBC0Delay(){
-  uint16_t csr1 = readCSR1();
-  return (csr1>>8)&0xF;
+  return readField<Registers::BC0Delay>();
 }
 
 void TtcVi::channelBAsyncCommand(uint8_t command){
-  writeData(baseAddress()+0x8b,(uint16_t)command);
+  write<Registers::ShortAsyncCycle>(command);
 }
   
 void TtcVi::channelBAsyncCommand(uint8_t addr, uint8_t subAddr, uint8_t data, bool internal){
   uint16_t dta = 0x8000 | (addr<<1) | (internal ? 0x0 : 0x1);
-  writeData(baseAddress()+0xC0,dta);
+  write<Registers::LongAsyncCycleMSW>(dta);
   dta = (subAddr<<8) | data;
-  writeData(baseAddress()+0xC2,dta);
+  write<Registers::LongAsyncCycleLSW>(dta);
 }
   
 std::pair<uint8_t, uint8_t> TtcVi::getInhibit(unsigned int n){
   uint8_t delay,duration;
   assert(n<4);
-  uint32_t address = baseAddress()+0x92+n*0x8;
-  delay = readData<uint16_t>(address)&0xFFF;
-  duration = readData<uint16_t>(address+0x2)&0xFF;
+  VmeBatch inhibit = batch();
+  inhibit.read<Registers::InhibitDelay>(baseAddress(),n);
+  inhibit.read<Registers::InhibitDuration>(baseAddress(),n);
+  inhibit.flush();
+  delay = Registers::Delay::get(inhibit[0]);
+  duration = Registers::Duration::get(inhibit[1]);
   return std::make_pair(delay,duration);
 }
   
 void TtcVi::setInhibit(unsigned int n,uint8_t delay,uint8_t duration){
   assert(n<4);
-  uint32_t address = baseAddress()+0x92+n*0x8;
-  writeData(address,(uint16_t)delay);
-  writeData(address+0x2,(uint16_t)duration);
+  VmeBatch inhibit = batch();
+  inhibit.write<Registers::InhibitDelay>(baseAddress(),delay,n);
+  inhibit.write<Registers::InhibitDuration>(baseAddress(),duration,n);
+  inhibit.flush();
 }
   
 std::bitset<4> TtcVi::getBGo(unsigned int n){
   assert(n<4);
-  uint32_t address = baseAddress()+0x90+n*0x8;
-  return std::bitset<4>(readData<uint16_t>(address)&0xF);
+  return std::bitset<4>(readField<Registers::BGoFlags>(n));
 }
   
 void TtcVi::setBGo(unsigned int n,bool softTrigger, bool asynchronous, bool repeat, bool autoTrigger){
   assert(n<4);
-  uint32_t address = baseAddress()+0x90+n*0x8;
   uint16_t data = (softTrigger<<3) | (asynchronous<<2) | (repeat<<1) | autoTrigger;
-  writeData(address,data);
+  write<Registers::BGoMode>(data,n);
 }
   
 void TtcVi::triggerBGo(unsigned int n){
   assert(n<4);
-  uint32_t address = baseAddress()+0x96+n*0x8;
-  writeData(address,1);
+  write<Registers::BGoTrigger>(1,n);
 }
 
 uint16_t TtcVi::readCSR1(){
-  return readData<uint16_t>(baseAddress()+0x80);
+  return read<Registers::CSR1>();
 }
 
 uint16_t TtcVi::readCSR2(){
-  return readData<uint16_t>(baseAddress()+0x82);
+  return read<Registers::CSR2>();
 }
 
 void TtcVi::writeCSR1(uint16_t word){
-  writeData(baseAddress()+0x80,word);
+  write<Registers::CSR1>(word);
 }
 
 void TtcVi::writeCSR2(uint16_t word){
-  writeData(baseAddress()+0x82,word);
+  write<Registers::CSR2>(word);
 }
 
 using namespace boost::python;
@@ -175,7 +170,7 @@ using namespace boost::python;
 template<> void exposeToPython<TtcVi>() {
   void (TtcVi::*channelBAsyncShortCommand)(uint8_t) = &TtcVi::channelBAsyncCommand;
   void (TtcVi::*channelBAsyncLongCommand)(uint8_t, uint8_t, uint8_t, bool) = &TtcVi::channelBAsyncCommand;
-  scope in_TTC = class_<TtcVi>("TtcVi",init<VmeController*,uint32_t>())
+  scope in_TTC = class_<TtcVi, bases<VmeBoard> >("TtcVi",init<VmeController*,uint32_t>())
     .def("reset",&TtcVi::reset)
     .def("trigger",&TtcVi::trigger)
     .def("resetCounter",&TtcVi::resetCounter)
@@ -0,0 +1,119 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TdcChain.h"
+#include "V1190Decoder.h"
+#include "PythonModule.h"
+
+using namespace std;
+
+TdcChain::TdcChain(const VmeController* controller, uint8_t address):
+  cont_(controller),address_(address),transferSize_(16384),readout_(32768*sizeof(uint32_t)) {
+  positions_.fill(-1);
+}
+
+void TdcChain::add(Tdc* board) {
+  uint8_t geo = board->getGeoAddress();
+  if(positions_[geo]>=0) {
+    LOG_ERROR("GEO address " + to_string(geo) + " already used in the chain: each board must have its own.");
+    throw_with_trace(CAENVMEexception(cvInvalidParam));
+  }
+  // the new board is the last one. The previous last one becomes the first (if alone) or an intermediate.
+  // A board alone cannot be both first and last: it is not chained, and read with plain block transfers.
+  if(boards_.size()) boards_.back()->setChain(address_, boards_.size()==1 ? Tdc::cvFirstBoard : Tdc::cvIntermediateBoard);
+  board->setChain(address_, boards_.empty() ? Tdc::cvNotChained : Tdc::cvLastBoard);
+  positions_[geo] = boards_.size();
+  boards_.push_back(board);
+  LOG_DEBUG("V1190 with GEO address " + to_string(geo) + " added to the chain at " + int_to_hex(address()));
+}
+
+std::vector<std::vector<V1190Event> > TdcChain::getEvents() {
+  readout_.clear();
+  readout(readout_);
+  return decode(readout_.data<uint32_t>(), readout_.count<uint32_t>());
+}
+
+size_t TdcChain::readout(ReadoutBuffer& buffer) const {
+  size_t before = buffer.count<uint32_t>();
+  // at most the output buffers of the boards: a V1190 without BERR sends fillers once empty
+  const size_t limit = boards_.size()*outputBufferWords;
+  if(boards_.size()==1) {
+    size_t n = 0;
+    for(size_t read = transferSize_; read==size_t(transferSize_) && n<limit; n += read)
+      read = boards_[0]->readOutputBuffer(buffer, transferSize_);
+    return n;
+  }
+  // one transfer after the other, until the last board ends the chain with a bus error.
+  // A shorter transfer without it means that no board ended the chain.
+  while(buffer.count<uint32_t>()-before<limit) {
+    VmeTransfer transfer = cont_->mode(cvA32_U_BLT,cvD32)->tryBlockReadData<uint32_t>(address(), buffer, transferSize_);
+    if(transfer.status==cvBusError) return buffer.count<uint32_t>()-before;
+    checkCAENVMEexception(transfer.status);
+    if(transfer.bytes<int(transferSize_*sizeof(uint32_t))) break;
+  }
+  LOG_WARN("The chained readout at " + int_to_hex(address()) + " was not ended by a bus error: is the last board of the chain set?");
+  return buffer.count<uint32_t>()-before;
+}
+
+namespace {
+  // V1190EventSink sending each event to the output of its board, from the GEO address of the global header
+  class ChainSink : public V1190EventSink {
+  public:
+    ChainSink(std::vector<std::vector<V1190Event> >& output, const int8_t* positions):
+      V1190EventSink(discarded_), output_(output), positions_(positions) {}
+    inline void globalHeader(uint32_t word) {
+      int8_t position = positions_[word&0x1F];
+      if(position<0) LOG_WARN("Event from an unknown GEO address (" + to_string(word&0x1F) + ") in the chained readout.");
+      setOutput(position<0 ? discarded_ : output_[position]);
+      V1190EventSink::globalHeader(word);
+    }
+    inline void globalTrailer(uint32_t word) {
+      V1190EventSink::globalTrailer(word);
+      discarded_.clear();
+    }
+  private:
+    std::vector<V1190Event> discarded_;
+    std::vector<std::vector<V1190Event> >& output_;
+    const int8_t* positions_;
+  };
+}
+
+std::vector<std::vector<V1190Event> > TdcChain::decode(const uint32_t* data, size_t n) const {
+  std::vector<std::vector<V1190Event> > output(boards_.size());
+  // each event goes from a global header to a global trailer, both carrying the GEO address
+  ChainSink sink(output, positions_.data());
+  V1190Decoder decoder;
+  decoder.decode(data, n, sink);
+  return output;
+}
+
+using namespace boost::python;
+
+template<> void exposeToPython<TdcChain>() {
+  class_<std::vector<std::vector<V1190Event> > >("V1190EventsPerBoard")
+    .def(vector_indexing_suite<std::vector<std::vector<V1190Event> > >())
+  ;
+  class_<TdcChain, boost::noncopyable>("TdcChain",init<const VmeController*, optional<uint8_t> >()[with_custodian_and_ward<1,2>()])
+    .def("add", &TdcChain::add, with_custodian_and_ward<1,2>())
+    .def("boards", &TdcChain::boards)
+    .def("board", &TdcChain::board, return_value_policy<reference_existing_object>())
+    .def("address", &TdcChain::address)
+    .add_property("transferSize", &TdcChain::getTransferSize, &TdcChain::setTransferSize)
+    .def("getEvents", &TdcChain::getEvents)
+  ;
+}
@@ -0,0 +1,168 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TdcReadoutEngine.h"
+#include "PythonModule.h"
+#include <chrono>
+
+// pause of the threads waiting for the other side of a ring: yield first, then sleep
+static void backoff(unsigned attempt) {
+  if(attempt<64) std::this_thread::yield();
+  else std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+static uint64_t elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count();
+}
+
+TdcReadoutEngine::TdcReadoutEngine(Tdc* tdc, unsigned buffers, bool useFIFO, std::shared_ptr<WaitPolicy> policy):
+  tdc_(tdc),useFIFO_(useFIFO),policy_(policy ? policy : std::make_shared<BackoffWait>(10, 1000)),free_(buffers),full_(buffers),
+  stop_(false),finished_(true),blocks_(0),bytes_(0),busTime_(0),stallTime_(0) {
+  for(unsigned i=0;i<buffers;++i) {
+    storage_.emplace_back(new Block{ReadoutBuffer(32768*sizeof(uint32_t)), 0, 0});
+    free_.push(storage_.back().get());
+  }
+}
+
+TdcReadoutEngine::~TdcReadoutEngine() {
+  stop();
+}
+
+void TdcReadoutEngine::start() {
+  if(thread_.joinable()) return;
+  // no other thread uses the rings now: all blocks are made free again
+  assert(full_.empty());
+  Block* block;
+  while(free_.pop(block)) {}
+  for(auto& b : storage_) free_.push(b.get());
+  blocks_ = 0;
+  bytes_ = 0;
+  busTime_ = 0;
+  stallTime_ = 0;
+  error_ = nullptr;
+  stop_ = false;
+  finished_ = false;
+  thread_ = std::thread(&TdcReadoutEngine::run, this);
+}
+
+void TdcReadoutEngine::stop() {
+  stop_ = true;
+  if(thread_.joinable()) thread_.join();
+}
+
+void TdcReadoutEngine::run() {
+  uint64_t sequence = 0;
+  Block* block = nullptr;
+  try {
+    while(!stop_) {
+      policy_->wait([this](){ return stop_ || tdc_->isDataReady(); });
+      if(stop_) break;
+      // a free buffer (kept from the previous loop if nothing was read). None: the consumer is late.
+      if(!block && !free_.pop(block)) {
+        auto start = std::chrono::steady_clock::now();
+        for(unsigned attempt=0; !stop_ && !free_.pop(block); ++attempt) backoff(attempt);
+        stallTime_ += elapsed(start);
+        if(!block) break;
+      }
+      auto start = std::chrono::steady_clock::now();
+      tdc_->readRaw(block->data, useFIFO_);
+      busTime_ += elapsed(start);
+      if(!block->data.size()) continue;
+      block->sequence = sequence++;
+      block->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+      ++blocks_;
+      bytes_ += block->data.size();
+      // cannot fail: there are as many slots as blocks
+      full_.push(block);
+      block = nullptr;
+    }
+  } catch(...) {
+    LOG_ERROR("Readout thread stopped by an exception.");
+    error_ = std::current_exception();
+  }
+  finished_ = true;
+}
+
+const TdcReadoutEngine::Block* TdcReadoutEngine::tryNext() {
+  Block* block;
+  return full_.pop(block) ? block : nullptr;
+}
+
+const TdcReadoutEngine::Block* TdcReadoutEngine::next() {
+  Block* block;
+  for(unsigned attempt=0;;++attempt) {
+    if(full_.pop(block)) return block;
+    if(finished_) {
+      // the last blocks may have been pushed just before the end
+      if(full_.pop(block)) return block;
+      if(error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+      }
+      return nullptr;
+    }
+    backoff(attempt);
+  }
+}
+
+void TdcReadoutEngine::release(const Block* block) {
+  free_.push(const_cast<Block*>(block));
+}
+
+using namespace boost::python;
+
+namespace {
+  // the GIL is released while waiting, so that the other Python threads run meanwhile
+  class ReleaseGIL {
+  public:
+    ReleaseGIL():state_(PyEval_SaveThread()) {}
+    ~ReleaseGIL() { PyEval_RestoreThread(state_); }
+  private:
+    PyThreadState* state_;
+  };
+
+  // blocks are returned to Python as lists of words, and released at once
+  object nextWords(TdcReadoutEngine& engine) {
+    const TdcReadoutEngine::Block* block;
+    {
+      ReleaseGIL unlocked;
+      block = engine.next();
+    }
+    if(!block) return object();
+    list words;
+    const uint32_t* data = block->data.data<uint32_t>();
+    for(size_t i=0;i<block->data.count<uint32_t>();++i) words.append(data[i]);
+    engine.release(block);
+    return words;
+  }
+}
+
+template<> void exposeToPython<TdcReadoutEngine>() {
+  class_<TdcReadoutEngine, boost::noncopyable>("TdcReadoutEngine",
+      init<Tdc*, optional<unsigned, bool, std::shared_ptr<WaitPolicy> > >()[with_custodian_and_ward<1,2>()])
+    .def("start", &TdcReadoutEngine::start)
+    .def("stop", &TdcReadoutEngine::stop)
+    .def("next", nextWords)
+    .add_property("running", &TdcReadoutEngine::running)
+    .add_property("blocks", &TdcReadoutEngine::blocks)
+    .add_property("bytes", &TdcReadoutEngine::bytes)
+    .add_property("busTime", &TdcReadoutEngine::busTime)
+    .add_property("stallTime", &TdcReadoutEngine::stallTime)
+  ;
+}
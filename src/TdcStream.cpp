@@ -0,0 +1,134 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TdcStream.h"
+#include "PythonModule.h"
+#include <algorithm>
+using namespace std;
+
+// size of the V1190 output buffer, in words: no point reading more in one transfer
+static const size_t OUTPUT_BUFFER_WORDS = 32768;
+
+TdcStream::TdcStream(Tdc* tdc, size_t capacity):tdc_(tdc), buffer_(min(capacity, OUTPUT_BUFFER_WORDS)*sizeof(uint32_t)),
+  ring_(max<size_t>(capacity, 2)), head_(0), size_(0), errors_(0), fillers_(0) {
+  reset();
+}
+
+void TdcStream::reset() {
+  head_ = 0;
+  size_ = 0;
+  latest_.fill(0);
+  started_.fill(false);
+}
+
+size_t TdcStream::fill() {
+  // each word gives at most one hit. Even number of words, for MBLT.
+  uint32_t nwords = min(ring_.size()-size_, OUTPUT_BUFFER_WORDS) & ~size_t(1);
+  if(!nwords) return 0;
+  size_t before = size_;
+  buffer_.clear();
+  tdc_->readOutputBuffer(buffer_, nwords);
+  unpack();
+  return size_-before;
+}
+
+void TdcStream::unpack() {
+  const uint32_t* words = buffer_.data<uint32_t>();
+  size_t n = buffer_.count<uint32_t>();
+  size_t tail = (head_+size_)%ring_.size();
+  for(size_t i=0; i<n; ++i) {
+    uint32_t word = words[i];
+    switch(word>>27) {
+      case 0x0: { // measurement
+        uint8_t channel = (word>>19)&0x7F;
+        unsigned chip = channel>>5;
+        uint32_t measurement = word&0x7FFFF;
+        uint64_t time = measurement;
+        if(started_[chip]) {
+          // signed distance to the latest timestamp of the chip, modulo the 19 bits range
+          int32_t delta = int32_t((measurement-uint32_t(latest_[chip]))<<13)>>13;
+          if(delta<0 && uint64_t(-delta)>latest_[chip]) delta += 0x80000;
+          time = latest_[chip]+delta;
+        }
+        if(!started_[chip] || time>latest_[chip]) latest_[chip] = time;
+        started_[chip] = true;
+        ring_[tail] = Hit{time, channel, uint8_t((word>>26)&0x1)};
+        if(++tail==ring_.size()) tail = 0;
+        ++size_;
+        break;
+      }
+      case 0x4: // TDC error
+        ++errors_;
+        break;
+      case 0x18: // filler, the buffer was empty
+        ++fillers_;
+        break;
+      default: // no headers nor trailers in continuous mode
+        break;
+    }
+  }
+}
+
+bool TdcStream::next(Hit& hit) {
+  if(!size_ && !fill()) return false;
+  hit = ring_[head_];
+  if(++head_==ring_.size()) head_ = 0;
+  --size_;
+  return true;
+}
+
+size_t TdcStream::read(Hit* hits, size_t max) {
+  if(!size_) fill();
+  size_t n = min(max, size_);
+  // in two parts if the hits wrap around the end of the ring
+  size_t first = min(n, ring_.size()-head_);
+  copy(ring_.begin()+head_, ring_.begin()+head_+first, hits);
+  copy(ring_.begin(), ring_.begin()+(n-first), hits+first);
+  head_ = (head_+n)%ring_.size();
+  size_ -= n;
+  return n;
+}
+
+using namespace boost::python;
+
+namespace {
+  list readHits(TdcStream& stream, size_t max) {
+    std::vector<TdcStream::Hit> hits(min(max, stream.capacity()));
+    hits.resize(stream.read(hits.data(), hits.size()));
+    list output;
+    for(const auto& hit: hits) output.append(hit);
+    return output;
+  }
+}
+
+template<> void exposeToPython<TdcStream>() {
+  class_<TdcStream::Hit>("TdcStreamHit")
+    .def_readonly("time", &TdcStream::Hit::time)
+    .def_readonly("channel", &TdcStream::Hit::channel)
+    .def_readonly("edge", &TdcStream::Hit::edge)
+  ;
+  class_<TdcStream, boost::noncopyable>("TdcStream", init<Tdc*, optional<size_t> >()[with_custodian_and_ward<1,2>()])
+    .def("fill", &TdcStream::fill)
+    .def("read", readHits)
+    .def("reset", &TdcStream::reset)
+    .add_property("available", &TdcStream::available)
+    .add_property("capacity", &TdcStream::capacity)
+    .add_property("errors", &TdcStream::errors)
+    .add_property("fillers", &TdcStream::fillers)
+  ;
+}
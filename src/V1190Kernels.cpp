@@ -0,0 +1,240 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "V1190Kernels.h"
+#include <atomic>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define V1190_KERNELS_X86
+#endif
+
+namespace {
+  struct Kernels {
+    void (*classify)(const uint32_t*, size_t, uint8_t*);
+    size_t (*hitRun)(const uint32_t*, size_t);
+    void (*extractHits)(const uint32_t*, size_t, uint8_t*, uint32_t*, uint8_t*);
+    size_t (*findBoundaries)(const uint32_t*, size_t, uint32_t*, size_t);
+  };
+  
+  //// scalar versions, also used for the last words of the vectorized ones
+  
+  void classifyScalar(const uint32_t* data, size_t n, uint8_t* types) {
+    for(size_t i=0; i<n; ++i) types[i] = data[i]>>27;
+  }
+  
+  size_t hitRunScalar(const uint32_t* data, size_t n) {
+    size_t i = 0;
+    while(i<n && (data[i]>>27)==0) ++i;
+    return i;
+  }
+  
+  void extractHitsScalar(const uint32_t* data, size_t n, uint8_t* channels, uint32_t* measurements, uint8_t* edges) {
+    for(size_t i=0; i<n; ++i) {
+      channels[i] = (data[i]>>19)&0x7F;
+      measurements[i] = data[i]&0x7FFFF;
+      edges[i] = (data[i]>>26)&0x1;
+    }
+  }
+  
+  size_t findBoundariesScalar(const uint32_t* data, size_t n, uint32_t* positions, size_t max, size_t start=0, size_t found=0) {
+    for(size_t i=start; i<n && found<max; ++i) {
+      uint32_t type = data[i]>>27;
+      if(type==0x8 || type==0x10) positions[found++] = i;
+    }
+    return found;
+  }
+  
+#ifdef V1190_KERNELS_X86
+  //// SSE4.2: 4 words per vector
+  
+  __attribute__((target("sse4.2"))) void classifySSE42(const uint32_t* data, size_t n, uint8_t* types) {
+    size_t i = 0;
+    for(; i+16<=n; i+=16) {
+      const __m128i* in = reinterpret_cast<const __m128i*>(data+i);
+      __m128i t0 = _mm_srli_epi32(_mm_loadu_si128(in), 27);
+      __m128i t1 = _mm_srli_epi32(_mm_loadu_si128(in+1), 27);
+      __m128i t2 = _mm_srli_epi32(_mm_loadu_si128(in+2), 27);
+      __m128i t3 = _mm_srli_epi32(_mm_loadu_si128(in+3), 27);
+      __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(t0, t1), _mm_packus_epi32(t2, t3));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(types+i), bytes);
+    }
+    classifyScalar(data+i, n-i, types+i);
+  }
+  
+  __attribute__((target("sse4.2"))) size_t hitRunSSE42(const uint32_t* data, size_t n) {
+    size_t i = 0;
+    for(; i+4<=n; i+=4) {
+      __m128i types = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i)), 27);
+      int hits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(types, _mm_setzero_si128())));
+      if(hits!=0xF) return i+__builtin_ctz(~hits);
+    }
+    return i+hitRunScalar(data+i, n-i);
+  }
+  
+  __attribute__((target("sse4.2"))) void extractHitsSSE42(const uint32_t* data, size_t n, uint8_t* channels, uint32_t* measurements, uint8_t* edges) {
+    size_t i = 0;
+    for(; i+4<=n; i+=4) {
+      __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(measurements+i), _mm_and_si128(words, _mm_set1_epi32(0x7FFFF)));
+      __m128i channel = _mm_and_si128(_mm_srli_epi32(words, 19), _mm_set1_epi32(0x7F));
+      __m128i edge = _mm_and_si128(_mm_srli_epi32(words, 26), _mm_set1_epi32(0x1));
+      // bytes: 4 channels, then 4 edges
+      __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(channel, edge), _mm_setzero_si128());
+      uint32_t out[2] = {uint32_t(_mm_cvtsi128_si32(bytes)), uint32_t(_mm_extract_epi32(bytes, 1))};
+      memcpy(channels+i, &out[0], 4);
+      memcpy(edges+i, &out[1], 4);
+    }
+    extractHitsScalar(data+i, n-i, channels+i, measurements+i, edges+i);
+  }
+  
+  __attribute__((target("sse4.2"))) size_t findBoundariesSSE42(const uint32_t* data, size_t n, uint32_t* positions, size_t max) {
+    size_t i = 0, found = 0;
+    for(; i+4<=n; i+=4) {
+      __m128i types = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i)), 27);
+      __m128i boundary = _mm_or_si128(_mm_cmpeq_epi32(types, _mm_set1_epi32(0x8)), _mm_cmpeq_epi32(types, _mm_set1_epi32(0x10)));
+      for(int mask = _mm_movemask_ps(_mm_castsi128_ps(boundary)); mask; mask &= mask-1) {
+        if(found==max) return found;
+        positions[found++] = i+__builtin_ctz(mask);
+      }
+    }
+    return findBoundariesScalar(data, n, positions, max, i, found);
+  }
+  
+  //// AVX2: 8 words per vector
+  
+  __attribute__((target("avx2"))) void classifyAVX2(const uint32_t* data, size_t n, uint8_t* types) {
+    size_t i = 0;
+    // the packs work in each 128 bits lane: the 32 bits groups are put back in order at the end
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for(; i+32<=n; i+=32) {
+      const __m256i* in = reinterpret_cast<const __m256i*>(data+i);
+      __m256i t0 = _mm256_srli_epi32(_mm256_loadu_si256(in), 27);
+      __m256i t1 = _mm256_srli_epi32(_mm256_loadu_si256(in+1), 27);
+      __m256i t2 = _mm256_srli_epi32(_mm256_loadu_si256(in+2), 27);
+      __m256i t3 = _mm256_srli_epi32(_mm256_loadu_si256(in+3), 27);
+      __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(t0, t1), _mm256_packus_epi32(t2, t3));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(types+i), _mm256_permutevar8x32_epi32(bytes, order));
+    }
+    classifySSE42(data+i, n-i, types+i);
+  }
+  
+  __attribute__((target("avx2"))) size_t hitRunAVX2(const uint32_t* data, size_t n) {
+    size_t i = 0;
+    for(; i+8<=n; i+=8) {
+      __m256i types = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i)), 27);
+      int hits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(types, _mm256_setzero_si256())));
+      if(hits!=0xFF) return i+__builtin_ctz(~hits);
+    }
+    return i+hitRunScalar(data+i, n-i);
+  }
+  
+  __attribute__((target("avx2"))) void extractHitsAVX2(const uint32_t* data, size_t n, uint8_t* channels, uint32_t* measurements, uint8_t* edges) {
+    size_t i = 0;
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for(; i+8<=n; i+=8) {
+      __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(measurements+i), _mm256_and_si256(words, _mm256_set1_epi32(0x7FFFF)));
+      __m256i channel = _mm256_and_si256(_mm256_srli_epi32(words, 19), _mm256_set1_epi32(0x7F));
+      __m256i edge = _mm256_and_si256(_mm256_srli_epi32(words, 26), _mm256_set1_epi32(0x1));
+      // low 128 bits: 8 channels, then 8 edges
+      __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(channel, edge), _mm256_setzero_si256());
+      __m128i low = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(bytes, order));
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(channels+i), low);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(edges+i), _mm_unpackhi_epi64(low, low));
+    }
+    extractHitsSSE42(data+i, n-i, channels+i, measurements+i, edges+i);
+  }
+  
+  __attribute__((target("avx2"))) size_t findBoundariesAVX2(const uint32_t* data, size_t n, uint32_t* positions, size_t max) {
+    size_t i = 0, found = 0;
+    for(; i+8<=n; i+=8) {
+      __m256i types = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i)), 27);
+      __m256i boundary = _mm256_or_si256(_mm256_cmpeq_epi32(types, _mm256_set1_epi32(0x8)),
+                                         _mm256_cmpeq_epi32(types, _mm256_set1_epi32(0x10)));
+      for(int mask = _mm256_movemask_ps(_mm256_castsi256_ps(boundary)); mask; mask &= mask-1) {
+        if(found==max) return found;
+        positions[found++] = i+__builtin_ctz(mask);
+      }
+    }
+    return findBoundariesScalar(data, n, positions, max, i, found);
+  }
+#endif
+  
+  const Kernels kernels[] = {
+    {classifyScalar, hitRunScalar, extractHitsScalar, [](const uint32_t* d, size_t n, uint32_t* p, size_t m) { return findBoundariesScalar(d, n, p, m); }},
+#ifdef V1190_KERNELS_X86
+    {classifySSE42, hitRunSSE42, extractHitsSSE42, findBoundariesSSE42},
+    {classifyAVX2, hitRunAVX2, extractHitsAVX2, findBoundariesAVX2},
+#endif
+  };
+  
+  V1190Kernels::CVInstructionSet best() {
+    for(int set=V1190Kernels::cvAVX2; set>V1190Kernels::cvScalar; --set)
+      if(V1190Kernels::supported(V1190Kernels::CVInstructionSet(set))) return V1190Kernels::CVInstructionSet(set);
+    return V1190Kernels::cvScalar;
+  }
+  
+  std::atomic<int>& current() {
+    static std::atomic<int> set(best());
+    return set;
+  }
+  
+  inline const Kernels& use() { return kernels[current().load(std::memory_order_relaxed)]; }
+}
+
+bool V1190Kernels::supported(CVInstructionSet set) {
+  switch(set) {
+    case cvScalar:
+      return true;
+#ifdef V1190_KERNELS_X86
+    case cvSSE42:
+      return __builtin_cpu_supports("sse4.2");
+    case cvAVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+V1190Kernels::CVInstructionSet V1190Kernels::active() {
+  return CVInstructionSet(current().load());
+}
+
+bool V1190Kernels::select(CVInstructionSet set) {
+  if(!supported(set)) return false;
+  current().store(set);
+  return true;
+}
+
+void V1190Kernels::classify(const uint32_t* data, size_t n, uint8_t* types) {
+  use().classify(data, n, types);
+}
+
+size_t V1190Kernels::hitRun(const uint32_t* data, size_t n) {
+  return use().hitRun(data, n);
+}
+
+void V1190Kernels::extractHits(const uint32_t* data, size_t n, uint8_t* channels, uint32_t* measurements, uint8_t* edges) {
+  use().extractHits(data, n, channels, measurements, edges);
+}
+
+size_t V1190Kernels::findBoundaries(const uint32_t* data, size_t n, uint32_t* positions, size_t max) {
+  return use().findBoundaries(data, n, positions, max);
+}
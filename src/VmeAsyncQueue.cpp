@@ -0,0 +1,310 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VmeAsyncQueue.h"
+
+namespace {
+  // maximum number of requests taken from the queue at once, and merged in one multi-cycle transaction
+  const size_t maxBatch = 256;
+  // while IRQ waits are pending and the queue is empty, the I/O thread waits for IRQs by slices of this length
+  const uint32_t irqSlice_ms = 1;
+
+  std::exception_ptr failure(const VmeRequest& request) {
+    return std::make_exception_ptr(CAENVMEexception(request.status));
+  }
+}
+
+VmeAsyncQueue::VmeAsyncQueue(const VmeController* controller):controller_(controller),
+  sleeping_(false),stop_(false),requests_(0),transactions_(0) {
+  stub_ = new Node;
+  stub_->next = nullptr;
+  head_ = stub_;
+  tail_ = stub_;
+  nodes_.reserve(maxBatch);
+  cycles_.reserve(maxBatch);
+  thread_ = std::thread(&VmeAsyncQueue::run, this);
+}
+
+VmeAsyncQueue::~VmeAsyncQueue() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wakeup_.notify_one();
+  thread_.join();
+  delete stub_;
+}
+
+//////////////////////////////////////////
+// Requests with a callback
+//////////////////////////////////////////
+
+void VmeAsyncQueue::read(uint32_t address, CVAddressModifier AM, CVDataWidth DW, Callback callback) {
+  post({VmeRequest::cvRead, address, 0, AM, DW, nullptr, 0, false, 0, cvGenericError}, std::move(callback));
+}
+
+void VmeAsyncQueue::write(uint32_t address, uint32_t data, CVAddressModifier AM, CVDataWidth DW, Callback callback) {
+  post({VmeRequest::cvWrite, address, data, AM, DW, nullptr, 0, false, 0, cvGenericError}, std::move(callback));
+}
+
+void VmeAsyncQueue::blockRead(uint32_t address, unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, bool multiplex, Callback callback) {
+  post({VmeRequest::cvBlockRead, address, 0, AM, DW, buffer, size, multiplex, 0, cvGenericError}, std::move(callback));
+}
+
+void VmeAsyncQueue::blockWrite(uint32_t address, const unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, bool multiplex, Callback callback) {
+  // the buffer is only read
+  post({VmeRequest::cvBlockWrite, address, 0, AM, DW, const_cast<unsigned char*>(buffer), size, multiplex, 0, cvGenericError}, std::move(callback));
+}
+
+void VmeAsyncQueue::IRQWait(uint32_t mask, uint32_t timeout_ms, Callback callback) {
+  post({VmeRequest::cvIRQWait, 0, mask, cvA32_S_DATA, cvD16, nullptr, (int)timeout_ms, false, 0, cvGenericError}, std::move(callback));
+}
+
+//////////////////////////////////////////
+// Requests with a future
+//////////////////////////////////////////
+
+std::future<uint32_t> VmeAsyncQueue::read(uint32_t address, CVAddressModifier AM, CVDataWidth DW) {
+  auto promise = std::make_shared<std::promise<uint32_t> >();
+  read(address, AM, DW, [promise](const VmeRequest& request) {
+    if(request.status) promise->set_exception(failure(request));
+    else promise->set_value(request.data);
+  });
+  return promise->get_future();
+}
+
+std::future<void> VmeAsyncQueue::write(uint32_t address, uint32_t data, CVAddressModifier AM, CVDataWidth DW) {
+  auto promise = std::make_shared<std::promise<void> >();
+  write(address, data, AM, DW, [promise](const VmeRequest& request) {
+    if(request.status) promise->set_exception(failure(request));
+    else promise->set_value();
+  });
+  return promise->get_future();
+}
+
+std::future<int> VmeAsyncQueue::blockRead(uint32_t address, unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, bool multiplex) {
+  auto promise = std::make_shared<std::promise<int> >();
+  blockRead(address, buffer, size, AM, DW, multiplex, [promise](const VmeRequest& request) {
+    // a BERR ends the data of the board: the bytes read before it are the result
+    if(request.status && request.status!=cvBusError) promise->set_exception(failure(request));
+    else promise->set_value(request.count);
+  });
+  return promise->get_future();
+}
+
+std::future<int> VmeAsyncQueue::blockWrite(uint32_t address, const unsigned char* buffer, int size, CVAddressModifier AM, CVDataWidth DW, bool multiplex) {
+  auto promise = std::make_shared<std::promise<int> >();
+  blockWrite(address, buffer, size, AM, DW, multiplex, [promise](const VmeRequest& request) {
+    if(request.status) promise->set_exception(failure(request));
+    else promise->set_value(request.count);
+  });
+  return promise->get_future();
+}
+
+std::future<uint32_t> VmeAsyncQueue::IRQWait(uint32_t mask, uint32_t timeout_ms) {
+  auto promise = std::make_shared<std::promise<uint32_t> >();
+  IRQWait(mask, timeout_ms, [promise](const VmeRequest& request) {
+    if(request.status) promise->set_exception(failure(request));
+    else promise->set_value(request.data);
+  });
+  return promise->get_future();
+}
+
+//////////////////////////////////////////
+// Lock-free MPSC queue (intrusive, with a stub node)
+//////////////////////////////////////////
+
+void VmeAsyncQueue::post(const VmeRequest& request, Callback callback) {
+  Node* node = new Node;
+  node->next = nullptr;
+  node->request = request;
+  node->callback = std::move(callback);
+  ++requests_;
+  // producers only swap the head, then link the previous one
+  Node* previous = head_.exchange(node);
+  previous->next = node;
+  // wake up the I/O thread if needed
+  if(sleeping_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wakeup_.notify_one();
+  }
+}
+
+VmeAsyncQueue::Node* VmeAsyncQueue::pop() {
+  Node* tail = tail_;
+  Node* next = tail->next;
+  if(tail==stub_) {
+    if(!next) return nullptr;
+    tail_ = next;
+    tail = next;
+    next = next->next;
+  }
+  if(next) {
+    tail_ = next;
+    return tail;
+  }
+  // a producer is linking a new node: try again later
+  if(tail!=head_) return nullptr;
+  // last node: put the stub back behind it, so that it can be taken
+  stub_->next = nullptr;
+  Node* previous = head_.exchange(stub_);
+  previous->next = stub_;
+  next = tail->next;
+  if(next) {
+    tail_ = next;
+    return tail;
+  }
+  return nullptr;
+}
+
+bool VmeAsyncQueue::empty() const {
+  return head_==tail_;
+}
+
+//////////////////////////////////////////
+// I/O thread
+//////////////////////////////////////////
+
+void VmeAsyncQueue::run() {
+  while(true) {
+    nodes_.clear();
+    Node* node;
+    while(nodes_.size()<maxBatch && (node = pop())) nodes_.push_back(node);
+    if(nodes_.size()) {
+      execute(nodes_);
+      if(irqWaiters_.size()) checkIRQs(false);
+      continue;
+    }
+    // a producer is linking a node
+    if(!empty()) {
+      std::this_thread::yield();
+      continue;
+    }
+    if(stop_) break;
+    if(irqWaiters_.size()) {
+      checkIRQs(true);
+      continue;
+    }
+    // nothing to do: sleep until a request is posted
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleeping_ = true;
+    wakeup_.wait(lock, [this]() { return stop_ || !empty(); });
+    sleeping_ = false;
+  }
+  // IRQs still awaited when stopping are reported as timeouts
+  for(auto& waiter : irqWaiters_) {
+    waiter.node->request.status = cvTimeoutError;
+    complete(waiter.node);
+  }
+  irqWaiters_.clear();
+}
+
+void VmeAsyncQueue::execute(std::vector<Node*>& nodes) {
+  size_t i = 0;
+  while(i<nodes.size()) {
+    VmeRequest::CVRequestType type = nodes[i]->request.type;
+    if(type==VmeRequest::cvRead || type==VmeRequest::cvWrite) {
+      // run of single cycles in the same direction
+      size_t last = i;
+      while(last<nodes.size() && nodes[last]->request.type==type) ++last;
+      executeCycles(nodes, i, last, type==VmeRequest::cvRead);
+      i = last;
+    } else if(type==VmeRequest::cvIRQWait) {
+      irqWaiters_.push_back({nodes[i], std::chrono::steady_clock::now() + std::chrono::milliseconds(nodes[i]->request.size)});
+      ++i;
+    } else {
+      executeBlock(nodes[i]);
+      ++i;
+    }
+  }
+}
+
+void VmeAsyncQueue::executeCycles(std::vector<Node*>& nodes, size_t first, size_t last, bool read) {
+  cycles_.clear();
+  for(size_t i=first; i<last; ++i) {
+    const VmeRequest& request = nodes[i]->request;
+    cycles_.push_back({request.address, request.data, request.AM, request.DW, cvGenericError});
+  }
+  try {
+    if(read) controller_->multiRead(cycles_);
+    else controller_->multiWrite(cycles_);
+  } catch(CAENVMEexception& e) {
+    // the status of each cycle is in the list
+  }
+  ++transactions_;
+  for(size_t i=first; i<last; ++i) {
+    VmeRequest& request = nodes[i]->request;
+    if(read) request.data = cycles_[i-first].data;
+    request.status = cycles_[i-first].status;
+    complete(nodes[i]);
+  }
+}
+
+void VmeAsyncQueue::executeBlock(Node* node) {
+  VmeRequest& request = node->request;
+  // no exception: the BERR which ends the data of a board is the normal case, and the bytes read before are kept
+  VmeTransfer transfer = request.type==VmeRequest::cvBlockRead ?
+    controller_->mode(request.AM,request.DW)->tryBlockReadData(request.address, request.buffer, request.size, request.multiplex) :
+    controller_->mode(request.AM,request.DW)->tryBlockWriteData(request.address, (const unsigned char*)request.buffer, request.size, request.multiplex);
+  request.count = transfer.bytes;
+  request.status = transfer.status;
+  ++transactions_;
+  complete(node);
+}
+
+void VmeAsyncQueue::checkIRQs(bool wait) {
+  uint32_t mask = 0;
+  for(auto& waiter : irqWaiters_) mask |= waiter.node->request.data;
+  unsigned char pending = 0;
+  CVErrorCodes status = cvSuccess;
+  try {
+    if(wait) {
+      try {
+        controller_->IRQWait(mask, irqSlice_ms);
+      } catch(CAENVMEexception& e) {
+        // timeout of the slice
+      }
+    }
+    pending = controller_->IRQCheck();
+  } catch(CAENVMEexception& e) {
+    status = (CVErrorCodes)e.errorcode();
+  }
+  auto now = std::chrono::steady_clock::now();
+  for(auto it = irqWaiters_.begin(); it!=irqWaiters_.end();) {
+    VmeRequest& request = it->node->request;
+    if(status || (pending & request.data) || now>=it->deadline) {
+      request.status = status ? status : ((pending & request.data) ? cvSuccess : cvTimeoutError);
+      request.data = pending;
+      complete(it->node);
+      it = irqWaiters_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void VmeAsyncQueue::complete(Node* node) {
+  if(node->callback) {
+    try {
+      node->callback(node->request);
+    } catch(std::exception& e) {
+      LOG_ERROR("Exception in the completion callback of a VME request: " + std::string(e.what()));
+    }
+  }
+  delete node;
+}
@@ -0,0 +1,114 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VmeBlockPipeline.h"
+#include <chrono>
+
+VmeBlockPipeline::VmeBlockPipeline(const VmeController* controller, int chunkSize, unsigned depth):
+  controller_(controller),chunkSize_(chunkSize),slots_(depth+1),address_(0),size_(0),AM_(cvA32_U_BLT),DW_(cvD32),
+  fifo_(false),multiplex_(false),issued_(0),consumed_(0),active_(false),finished_(true),busy_(false),waitTime_(0),stop_(false) {
+  for(auto& slot : slots_) slot.buffer.reserve(chunkSize_);
+  worker_ = std::thread(&VmeBlockPipeline::run, this);
+}
+
+VmeBlockPipeline::~VmeBlockPipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_all();
+  worker_.join();
+}
+
+void VmeBlockPipeline::setChunkSize(int bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  assert(!active_);
+  chunkSize_ = bytes;
+  for(auto& slot : slots_) slot.buffer.reserve(chunkSize_);
+}
+
+bool VmeBlockPipeline::transferPending() const {
+  return active_ && !finished_ && issued_-consumed_<slots_.size();
+}
+
+void VmeBlockPipeline::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while(true) {
+    condition_.wait(lock, [this](){ return stop_ || transferPending(); });
+    if(stop_) return;
+    Slot& slot = slots_[issued_%slots_.size()];
+    size_t offset = issued_*chunkSize_;
+    uint32_t address = address_ + (fifo_ ? 0 : offset);
+    int length = std::min<size_t>(chunkSize_, size_-offset);
+    busy_ = true;
+    lock.unlock();
+    // the bus is used without the lock, while the consumer processes the previous chunks
+    slot.buffer.clear();
+    slot.status = controller_->mode(AM_,DW_)->tryBlockReadData<unsigned char>(address, slot.buffer, length, multiplex_).status;
+    lock.lock();
+    busy_ = false;
+    ++issued_;
+    if(slot.status || (int)slot.buffer.size()<length || issued_*chunkSize_>=size_) finished_ = true;
+    condition_.notify_all();
+  }
+}
+
+size_t VmeBlockPipeline::read(uint32_t address, size_t size, CVAddressModifier AM, CVDataWidth DW, bool fifo, Consumer consumer, bool multiplex) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  address_ = address;
+  size_ = size;
+  AM_ = AM;
+  DW_ = DW;
+  fifo_ = fifo;
+  multiplex_ = multiplex;
+  issued_ = 0;
+  consumed_ = 0;
+  finished_ = size==0;
+  active_ = true;
+  waitTime_ = 0;
+  condition_.notify_all();
+  size_t total = 0;
+  CVErrorCodes status = cvSuccess;
+  try {
+    while(true) {
+      // wait for the next chunk, unless all of them have been processed
+      auto start = std::chrono::steady_clock::now();
+      condition_.wait(lock, [this](){ return consumed_<issued_ || (finished_ && !busy_); });
+      waitTime_ += std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+      if(consumed_==issued_) break;
+      Slot& slot = slots_[consumed_%slots_.size()];
+      lock.unlock();
+      if(slot.buffer.size()) consumer(slot.buffer);
+      total += slot.buffer.size();
+      lock.lock();
+      if(slot.status && slot.status!=cvBusError) status = slot.status;
+      ++consumed_;
+      condition_.notify_all();
+    }
+  } catch(...) {
+    // the consumer failed: let the transfer in progress complete before leaving
+    if(!lock.owns_lock()) lock.lock();
+    finished_ = true;
+    condition_.wait(lock, [this](){ return !busy_; });
+    active_ = false;
+    throw;
+  }
+  active_ = false;
+  if(status) throw_with_trace(CAENVMEexception(status));
+  return total;
+}
@@ -21,13 +21,22 @@
 
 VmeBoard::VmeBoard(VmeController* cont, uint32_t baseAddress, 
                    CVAddressModifier AM, CVDataWidth DW, 
-                   bool enforceAMDW):cont_(cont),AM_(AM),DW_(DW),enforceAMDW_(enforceAMDW),baseAddress_(baseAddress) {}
+                   bool enforceAMDW):cont_(cont),AM_(AM),DW_(DW),enforceAMDW_(enforceAMDW),baseAddress_(baseAddress),
+                   waitPolicy_(std::make_shared<BusyWait>()),cache_(false) {}
+
+void VmeBoard::invalidateCache() const {
+  for(auto& shadow: registers_)
+    if(shadow.second.policy!=cvReadOnce) shadow.second.known = false;
+}
                    
 using namespace boost::python;
 
 template<> void exposeToPython<VmeBoard>() {
   class_<VmeBoard>("VmeBoard",init<VmeController*, uint32_t, CVAddressModifier, CVDataWidth, bool>())
     .add_property("enforce",&VmeBoard::isAMDWenforced,&VmeBoard::enforceAMDW)
+    .add_property("waitPolicy",&VmeBoard::getWaitPolicy,&VmeBoard::setWaitPolicy)
+    .add_property("cache",&VmeBoard::isCacheEnabled,&VmeBoard::enableCache)
+    .def("invalidateCache",&VmeBoard::invalidateCache)
   ;
 }
 
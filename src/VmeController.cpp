@@ -21,28 +21,40 @@
 
 using namespace std;
 
-VmeController::VmeController() {
-  this->AM_=cvA32_S_DATA;
-  this->DW_=cvD16;
-  this->AMtmp_=cvA32_S_DATA;
-  this->DWtmp_=cvD16;
+namespace {
+  // temporary mode set by mode(), for the next operation of the current thread on that controller
+  struct PendingMode {
+    const VmeController* controller;
+    CVAddressModifier AM;
+    CVDataWidth DW;
+  };
+  thread_local PendingMode pendingMode_ = {nullptr, cvA32_S_DATA, cvD16};
+}
+
+VmeController::VmeController():AM_(cvA32_S_DATA),DW_(cvD16) {}
+
+VmeController::VmeController(const VmeController& other):AM_(other.getAM()),DW_(other.getDW()) {}
+
+VmeController& VmeController::operator=(const VmeController& other) {
+  this->AM_=other.getAM();
+  this->DW_=other.getDW();
+  return *this;
 }
 
 void VmeController::setMode(CVAddressModifier AM, CVDataWidth DW){
   this->AM_=AM;
   this->DW_=DW;
-  this->AMtmp_=AM;
-  this->DWtmp_=DW;
+  if(pendingMode_.controller==this) pendingMode_.controller=nullptr;
 }
 
 void VmeController::setAM(CVAddressModifier AM){
   this->AM_=AM;
-  this->AMtmp_=AM;
+  if(pendingMode_.controller==this) pendingMode_.controller=nullptr;
 }
 
 void VmeController::setDW(CVDataWidth DW){
   this->DW_=DW;
-  this->DWtmp_=DW;
+  if(pendingMode_.controller==this) pendingMode_.controller=nullptr;
 }
 
 CVAddressModifier VmeController::getAM(void) const {
@@ -54,41 +66,98 @@ CVDataWidth VmeController::getDW(void) const {
 }
 
 const VmeController* VmeController::mode(const CVAddressModifier AM, const CVDataWidth DW) const {
-  this->AMtmp_=AM;
-  this->DWtmp_=DW;
+  pendingMode_ = {this, AM, DW};
   return this;
 }
 
 std::tuple<CVAddressModifier,CVDataWidth> VmeController::useMode() const {
-  CVAddressModifier AM = this->AMtmp_;
-  CVDataWidth DW = this->DWtmp_;
-  this->AMtmp_ = this->AM_;
-  this->DWtmp_ = this->DW_;
-  return std::make_tuple(AM,DW);
+  if(pendingMode_.controller==this) {
+    pendingMode_.controller = nullptr;
+    return std::make_tuple(pendingMode_.AM,pendingMode_.DW);
+  }
+  return std::make_tuple(getAM(),getDW());
+}
+
+CVErrorCodes VmeController::multiReadImpl(VmeCycle* cycles, int n) const {
+  CVErrorCodes status = cvSuccess;
+  for(int i=0;i<n;++i) {
+    cycles[i].data = 0;
+    cycles[i].status = readDataImpl(cycles[i].address,&cycles[i].data,cycles[i].AM,cycles[i].DW);
+    if(!status) status = cycles[i].status;
+  }
+  return status;
+}
+
+CVErrorCodes VmeController::multiWriteImpl(VmeCycle* cycles, int n) const {
+  CVErrorCodes status = cvSuccess;
+  for(int i=0;i<n;++i) {
+    cycles[i].status = writeDataImpl(cycles[i].address,&cycles[i].data,cycles[i].AM,cycles[i].DW);
+    if(!status) status = cycles[i].status;
+  }
+  return status;
+}
+
+VmeBatch::VmeBatch(const VmeController* controller, CVAddressModifier AM, CVDataWidth DW):controller_(controller),AM_(AM),DW_(DW),flushed_(0) {}
+
+size_t VmeBatch::read(uint32_t address, CVAddressModifier AM, CVDataWidth DW) {
+  cycles_.push_back({address, 0, AM, DW, cvGenericError});
+  reads_.push_back(true);
+  return cycles_.size()-1;
+}
+
+void VmeBatch::write(uint32_t address, uint32_t data, CVAddressModifier AM, CVDataWidth DW) {
+  cycles_.push_back({address, data, AM, DW, cvGenericError});
+  reads_.push_back(false);
+}
+
+void VmeBatch::flush() {
+  while(flushed_<cycles_.size()) {
+    // find the run of cycles in the same direction
+    size_t end = flushed_;
+    while(end<cycles_.size() && reads_[end]==reads_[flushed_]) ++end;
+    CVErrorCodes status = reads_[flushed_] ? controller_->multiReadImpl(&cycles_[flushed_],end-flushed_) :
+                                             controller_->multiWriteImpl(&cycles_[flushed_],end-flushed_);
+    flushed_ = end;
+    checkCAENVMEexception(status);
+  }
+}
+
+void VmeBatch::clear() {
+  cycles_.clear();
+  reads_.clear();
+  flushed_ = 0;
 }
 
 using namespace boost::python;
 
+// python uses the block transfers from/to vectors
+template<typename T> using VectorBlockRead = std::vector<T> (VmeController::*)(const long unsigned int, int, bool) const;
+template<typename T> using VectorBlockWrite = int (VmeController::*)(const long unsigned int, const std::vector<T>&, bool) const;
+
 template<> void exposeToPython<VmeController>() {
   struct VmeControllerWrap : VmeController, wrapper<VmeController> {
     VmeControllerWrap():VmeController(),wrapper<VmeController>() {}
-    void writeDataImpl(long unsigned int address,void* data) const override {
-      this->get_override("writeDataImpl")(address,data);
+    // the python implementations raise exceptions, or return a status (None is a success)
+    static CVErrorCodes status(object result) {
+      return result.is_none() ? cvSuccess : CVErrorCodes(extract<int>(result)());
+    }
+    CVErrorCodes writeDataImpl(long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override {
+      return status(this->get_override("writeDataImpl")(address,data,AM,DW));
     }
-    void readDataImpl(long unsigned int address,void* data) const override {
-      this->get_override("readDataImpl")(address,data);
+    CVErrorCodes readDataImpl(long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override {
+      return status(this->get_override("readDataImpl")(address,data,AM,DW));
     }
-    void readWriteDataImpl(const long unsigned int address,void* data) const override {
-      this->get_override("readWriteDataImpl")(address,data);
+    CVErrorCodes readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const override {
+      return status(this->get_override("readWriteDataImpl")(address,data,AM,DW));
     }
-    void blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, bool multiplex=false) const override {
-      this->get_override("blockReadDataImpl")(address,buffer,size,count,multiplex);
+    CVErrorCodes blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override {
+      return status(this->get_override("blockReadDataImpl")(address,buffer,size,count,AM,DW,multiplex));
     }
-    void blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, bool multiplex=false) const override {
-      this->get_override("blockWriteDataImpl")(address,buffer,size,count,multiplex);
+    CVErrorCodes blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex=false) const override {
+      return status(this->get_override("blockWriteDataImpl")(address,buffer,size,count,AM,DW,multiplex));
     }
-    void ADOCycleImpl(const long unsigned int address) const override {
-      this->get_override("ADOCycleImpl")(address);
+    CVErrorCodes ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const override {
+      return status(this->get_override("ADOCycleImpl")(address,AM));
     }
     void IRQEnable(uint32_t mask) const override {
       this->get_override("IRQEnable")(mask);
@@ -115,18 +184,18 @@ template<> void exposeToPython<VmeController>() {
     .def("writeData16",&VmeController::writeData<uint16_t>)
     .def("readData16",&VmeController::readData<uint16_t>)
     .def("readWriteData16",&VmeController::readWriteData<uint16_t>)
-    .def("blockReadData16",&VmeController::blockReadData<uint16_t>)
-    .def("blockWriteData16",&VmeController::blockWriteData<uint16_t>)
+    .def("blockReadData16",static_cast<VectorBlockRead<uint16_t> >(&VmeController::blockReadData<uint16_t>))
+    .def("blockWriteData16",static_cast<VectorBlockWrite<uint16_t> >(&VmeController::blockWriteData<uint16_t>))
     .def("writeData32",&VmeController::writeData<uint32_t>)
     .def("readData32",&VmeController::readData<uint32_t>)
     .def("readWriteData32",&VmeController::readWriteData<uint32_t>)
-    .def("blockReadData32",&VmeController::blockReadData<uint32_t>)
-    .def("blockWriteData32",&VmeController::blockWriteData<uint32_t>)
+    .def("blockReadData32",static_cast<VectorBlockRead<uint32_t> >(&VmeController::blockReadData<uint32_t>))
+    .def("blockWriteData32",static_cast<VectorBlockWrite<uint32_t> >(&VmeController::blockWriteData<uint32_t>))
     .def("writeData64",&VmeController::writeData<uint64_t>)
     .def("readData64",&VmeController::readData<uint64_t>)
     .def("readWriteData64",&VmeController::readWriteData<uint64_t>)
-    .def("blockReadData64",&VmeController::blockReadData<uint64_t>)
-    .def("blockWriteData64",&VmeController::blockWriteData<uint64_t>)
+    .def("blockReadData64",static_cast<VectorBlockRead<uint64_t> >(&VmeController::blockReadData<uint64_t>))
+    .def("blockWriteData64",static_cast<VectorBlockWrite<uint64_t> >(&VmeController::blockWriteData<uint64_t>))
     .def("ADOCycle",&VmeController::ADOCycle)
     .def("IRQEnable",pure_virtual(&VmeController::IRQEnable))
     .def("IRQDisable",pure_virtual(&VmeController::IRQDisable))
@@ -134,5 +203,24 @@ template<> void exposeToPython<VmeController>() {
     .def("IRQCheck",pure_virtual(&VmeController::IRQCheck))
     .def("IACK",pure_virtual(&VmeController::IACK))
   ;
+
+  class_<VmeCycle>("VmeCycle")
+    .def_readwrite("address",&VmeCycle::address)
+    .def_readwrite("data",&VmeCycle::data)
+    .def_readwrite("AM",&VmeCycle::AM)
+    .def_readwrite("DW",&VmeCycle::DW)
+    .def_readonly("status",&VmeCycle::status)
+  ;
+
+  size_t (VmeBatch::*read)(uint32_t, CVAddressModifier, CVDataWidth) = &VmeBatch::read;
+  void (VmeBatch::*write)(uint32_t, uint32_t, CVAddressModifier, CVDataWidth) = &VmeBatch::write;
+  class_<VmeBatch>("VmeBatch",init<const VmeController*, CVAddressModifier, CVDataWidth>())
+    .def("read",read)
+    .def("write",write)
+    .def("flush",&VmeBatch::flush)
+    .def("clear",&VmeBatch::clear)
+    .def("__getitem__",&VmeBatch::operator[])
+    .def("__len__",&VmeBatch::size)
+  ;
 }
 
@@ -0,0 +1,83 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VmeCrateManager.h"
+#include <cassert>
+
+VmeCrateManager::VmeCrateManager():running_(false),failed_(false) {}
+
+VmeCrateManager::~VmeCrateManager() {
+  try {
+    stop();
+  } catch(std::exception& e) {
+    LOG_ERROR("Crate readout failed: " + std::string(e.what()));
+  }
+}
+
+size_t VmeCrateManager::add(const std::string& name, const VmeController* controller, Readout readout) {
+  assert(!running_);
+  std::unique_ptr<Crate> crate(new Crate);
+  crate->name = name;
+  crate->controller = controller;
+  crate->readout = std::move(readout);
+  crate->events = 0;
+  crates_.push_back(std::move(crate));
+  return crates_.size()-1;
+}
+
+void VmeCrateManager::start() {
+  if(running_) return;
+  running_ = true;
+  failed_ = false;
+  for(auto& crate : crates_) {
+    crate->error = nullptr;
+    crate->thread = std::thread(&VmeCrateManager::run, this, std::ref(*crate));
+  }
+  LOG_INFO("Readout of " + std::to_string(crates_.size()) + " crates started.");
+}
+
+void VmeCrateManager::stop() {
+  if(!running_) return;
+  running_ = false;
+  for(auto& crate : crates_) {
+    if(crate->thread.joinable()) crate->thread.join();
+  }
+  LOG_INFO("Readout stopped after " + std::to_string(events()) + " events.");
+  for(auto& crate : crates_) {
+    if(crate->error) std::rethrow_exception(crate->error);
+  }
+}
+
+uint64_t VmeCrateManager::events() const {
+  uint64_t total = 0;
+  for(auto& crate : crates_) total += crate->events;
+  return total;
+}
+
+void VmeCrateManager::run(Crate& crate) {
+  try {
+    while(running_ && !failed_) {
+      crate.events += crate.readout();
+    }
+  } catch(...) {
+    // one crate failing stops the whole readout
+    crate.error = std::current_exception();
+    failed_ = true;
+    LOG_ERROR("Readout of crate " + crate.name + " failed.");
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VmeIRQDispatcher.h"
+#include <cassert>
+
+VmeIRQDispatcher::VmeIRQDispatcher(const VmeController* controller, uint32_t timeout_ms, CVDataWidth iackWidth):
+  controller_(controller),timeout_ms_(timeout_ms),iackWidth_(iackWidth),running_(false),interrupts_(0),unhandled_(0) {}
+
+VmeIRQDispatcher::~VmeIRQDispatcher() {
+  stop();
+}
+
+void VmeIRQDispatcher::registerHandler(uint8_t level, uint16_t vector, Handler handler) {
+  assert(level>=1 && level<=7);
+  uint32_t enabled;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handlers_[std::make_pair(level,vector)] = std::move(handler);
+    enabled = running_ ? levels() : 0;
+  }
+  if(enabled) controller_->IRQEnable(enabled);
+}
+
+void VmeIRQDispatcher::unregisterHandler(uint8_t level, uint16_t vector) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  handlers_.erase(std::make_pair(level,vector));
+}
+
+uint32_t VmeIRQDispatcher::levels() const {
+  uint32_t mask = 0;
+  for(auto& handler : handlers_) mask |= 1<<(handler.first.first-1);
+  return mask;
+}
+
+void VmeIRQDispatcher::start() {
+  if(running_) return;
+  uint32_t mask;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mask = levels();
+  }
+  controller_->IRQEnable(mask);
+  running_ = true;
+  thread_ = std::thread(&VmeIRQDispatcher::run, this);
+  LOG_INFO("IRQ dispatcher started (levels " + int_to_hex(mask) + ").");
+}
+
+void VmeIRQDispatcher::stop() {
+  if(!running_) return;
+  running_ = false;
+  thread_.join();
+  std::lock_guard<std::mutex> lock(mutex_);
+  controller_->IRQDisable(levels());
+  LOG_INFO("IRQ dispatcher stopped after " + std::to_string(interrupts_) + " interrupts.");
+}
+
+void VmeIRQDispatcher::run() {
+  while(running_) {
+    uint32_t mask;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      mask = levels();
+    }
+    try {
+      controller_->IRQWait(mask, timeout_ms_);
+    } catch(CAENVMEexception& e) {
+      // timeout: check whether we should stop
+      continue;
+    }
+    try {
+      unsigned char pending = controller_->IRQCheck() & mask;
+      // highest level first, as on the bus
+      for(int level=7; level>=1; --level) {
+        if(!(pending & (1<<(level-1)))) continue;
+        uint16_t vector = controller_->mode(controller_->getAM(),iackWidth_)->IACK(CVIRQLevels(1<<(level-1)));
+        if(iackWidth_==cvD8) vector &= 0xFF;
+        ++interrupts_;
+        Handler handler;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          auto it = handlers_.find(std::make_pair(uint8_t(level),vector));
+          if(it!=handlers_.end()) handler = it->second;
+        }
+        if(handler) {
+          handler(level, vector);
+        } else {
+          ++unhandled_;
+          LOG_WARN("Unhandled interrupt at level " + std::to_string(level) + " with vector " + int_to_hex(vector));
+        }
+      }
+    } catch(std::exception& e) {
+      LOG_ERROR("Interrupt handling failed: " + std::string(e.what()));
+    }
+  }
+}
@@ -0,0 +1,335 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VmeRecording.h"
+#include "PythonModule.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace {
+  const char magic[8] = {'V','M','E','R','E','C','0','1'};
+
+  // small index for each thread, stored in the entries
+  std::atomic<uint32_t> nthreads(0);
+  thread_local uint32_t threadIndex = nthreads++;
+
+  // number of bytes of a single cycle
+  inline int cycleSize(CVDataWidth DW) { return DW & 0xF; }
+
+  inline VmeRecordEntry makeEntry(uint8_t type, uint32_t address, uint32_t data, CVAddressModifier AM, CVDataWidth DW) {
+    return {0, 0, address, data, 0, threadIndex, type, uint8_t(AM), uint8_t(DW), 0};
+  }
+
+  // number of bytes stored after the entry
+  inline size_t payloadSize(const VmeRecordEntry& entry) {
+    switch(entry.type) {
+      case VmeTraceRecord::cvBlockRead: return entry.length;
+      case VmeTraceRecord::cvMultiRead: return entry.length*2*sizeof(uint32_t);
+      case VmeTraceRecord::cvMultiWrite: return entry.length*sizeof(uint32_t);
+      default: return 0;
+    }
+  }
+}
+
+//////////////////////////////////////////
+// Recorder
+//////////////////////////////////////////
+
+VmeRecorder::VmeRecorder(const VmeController* controller, const std::string& filename):VmeController(),controller_(controller),
+  origin_(std::chrono::steady_clock::now()),file_(filename, std::ios::binary),entries_(0) {
+  if(!file_) {
+    LOG_ERROR("Cannot open " + filename + " to record the VME session");
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  setMode(controller_->getAM(), controller_->getDW());
+  VmeRecordingHeader header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.AM = getAM();
+  header.DW = getDW();
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  LOG_INFO("Recording the VME session to " + filename);
+}
+
+VmeRecorder::~VmeRecorder() {
+  close();
+}
+
+void VmeRecorder::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(!file_.is_open()) return;
+  file_.close();
+  LOG_INFO(std::to_string(entries_) + " VME operations recorded");
+}
+
+void VmeRecorder::save(VmeRecordEntry& entry, std::chrono::steady_clock::time_point start, const void* payload) const {
+  auto stop = std::chrono::steady_clock::now();
+  entry.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start-origin_).count();
+  entry.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop-start).count();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(!file_.is_open()) return;
+  file_.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+  if(payloadSize(entry)) file_.write(reinterpret_cast<const char*>(payload), payloadSize(entry));
+  ++entries_;
+}
+
+CVErrorCodes VmeRecorder::writeDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  uint32_t value = 0;
+  std::memcpy(&value, data, cycleSize(DW));
+  return capture(makeEntry(VmeTraceRecord::cvWrite, address, value, AM, DW), [&]() { return controller_->writeDataImpl(address,data,AM,DW); });
+}
+
+CVErrorCodes VmeRecorder::readDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  return capture(makeEntry(VmeTraceRecord::cvRead, address, 0, AM, DW), [&]() { return controller_->readDataImpl(address,data,AM,DW); },
+          [&](VmeRecordEntry& entry) -> const void* { std::memcpy(&entry.data, data, cycleSize(DW)); return nullptr; });
+}
+
+CVErrorCodes VmeRecorder::readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  // the data read back is recorded
+  return capture(makeEntry(VmeTraceRecord::cvReadWrite, address, 0, AM, DW), [&]() { return controller_->readWriteDataImpl(address,data,AM,DW); },
+          [&](VmeRecordEntry& entry) -> const void* { std::memcpy(&entry.data, data, cycleSize(DW)); return nullptr; });
+}
+
+CVErrorCodes VmeRecorder::blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  return capture(makeEntry(VmeTraceRecord::cvBlockRead, address, size, AM, DW), [&]() { return controller_->blockReadDataImpl(address,buffer,size,count,AM,DW,multiplex); },
+          [&](VmeRecordEntry& entry) -> const void* { entry.length = std::max(*count,0); return buffer; });
+}
+
+CVErrorCodes VmeRecorder::blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  return capture(makeEntry(VmeTraceRecord::cvBlockWrite, address, size, AM, DW), [&]() { return controller_->blockWriteDataImpl(address,buffer,size,count,AM,DW,multiplex); },
+          [&](VmeRecordEntry& entry) -> const void* { entry.length = std::max(*count,0); return nullptr; });
+}
+
+CVErrorCodes VmeRecorder::ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const {
+  return capture(makeEntry(VmeTraceRecord::cvADO, address, 0, AM, cvD32), [&]() { return controller_->ADOCycleImpl(address,AM); });
+}
+
+CVErrorCodes VmeRecorder::multiReadImpl(VmeCycle* cycles, int n) const {
+  std::vector<uint32_t> results(2*n);
+  return capture(makeEntry(VmeTraceRecord::cvMultiRead, cycles[0].address, 0, cycles[0].AM, cycles[0].DW), [&]() { return controller_->multiReadImpl(cycles,n); },
+          [&](VmeRecordEntry& entry) -> const void* {
+            entry.length = n;
+            for(int i=0;i<n;++i) {
+              results[2*i] = cycles[i].data;
+              results[2*i+1] = cycles[i].status;
+            }
+            return results.data();
+          });
+}
+
+CVErrorCodes VmeRecorder::multiWriteImpl(VmeCycle* cycles, int n) const {
+  std::vector<uint32_t> results(n);
+  return capture(makeEntry(VmeTraceRecord::cvMultiWrite, cycles[0].address, 0, cycles[0].AM, cycles[0].DW), [&]() { return controller_->multiWriteImpl(cycles,n); },
+          [&](VmeRecordEntry& entry) -> const void* {
+            entry.length = n;
+            for(int i=0;i<n;++i) results[i] = cycles[i].status;
+            return results.data();
+          });
+}
+
+void VmeRecorder::IRQEnable(uint32_t mask) const {
+  capture(makeEntry(VmeTraceRecord::cvIRQEnable, mask, 0, getAM(), getDW()), [&]() { controller_->IRQEnable(mask); });
+}
+
+void VmeRecorder::IRQDisable(uint32_t mask) const {
+  capture(makeEntry(VmeTraceRecord::cvIRQDisable, mask, 0, getAM(), getDW()), [&]() { controller_->IRQDisable(mask); });
+}
+
+void VmeRecorder::IRQWait(uint32_t mask, uint32_t timeout_ms) const {
+  capture(makeEntry(VmeTraceRecord::cvIRQWait, mask, timeout_ms, getAM(), getDW()), [&]() { controller_->IRQWait(mask,timeout_ms); });
+}
+
+unsigned char VmeRecorder::IRQCheck() const {
+  unsigned char pending = 0;
+  capture(makeEntry(VmeTraceRecord::cvIRQCheck, 0, 0, getAM(), getDW()), [&]() { pending = controller_->IRQCheck(); },
+          [&](VmeRecordEntry& entry) -> const void* { entry.data = pending; return nullptr; });
+  return pending;
+}
+
+uint16_t VmeRecorder::IACK(CVIRQLevels Level) const {
+  // the temporary mode set on the recorder applies to the IACK cycle of the controller
+  CVAddressModifier AM;
+  CVDataWidth DW;
+  std::tie(AM, DW) = useMode();
+  uint16_t vector = 0;
+  capture(makeEntry(VmeTraceRecord::cvIACK, Level, 0, AM, DW), [&]() { vector = controller_->mode(AM, DW)->IACK(Level); },
+          [&](VmeRecordEntry& entry) -> const void* { entry.data = vector; return nullptr; });
+  return vector;
+}
+
+//////////////////////////////////////////
+// Replayer
+//////////////////////////////////////////
+
+VmeReplayer::VmeReplayer(const std::string& filename, bool originalTiming):VmeController(),originalTiming_(originalTiming),
+  offset_(sizeof(VmeRecordingHeader)),replayed_(0) {
+  // the whole recording is loaded, so that the replay does no I/O
+  std::ifstream file(filename, std::ios::binary);
+  if(file) recording_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  VmeRecordingHeader header;
+  if(recording_.size()<sizeof(header)) {
+    LOG_ERROR("Cannot read the VME recording " + filename);
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  std::memcpy(&header, recording_.data(), sizeof(header));
+  if(std::memcmp(header.magic, magic, sizeof(magic))) {
+    LOG_ERROR(filename + " is not a VME recording");
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  setMode(CVAddressModifier(header.AM), CVDataWidth(header.DW));
+  LOG_INFO("Replaying the VME session recorded in " + filename);
+}
+
+void VmeReplayer::rewind() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  offset_ = sizeof(VmeRecordingHeader);
+  replayed_ = 0;
+}
+
+VmeRecordEntry VmeReplayer::next(uint8_t type, uint32_t address, const unsigned char** payload) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  VmeRecordEntry entry;
+  if(offset_+sizeof(entry)>recording_.size()) {
+    LOG_ERROR("End of the VME recording reached after " + std::to_string(replayed_) + " operations");
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  std::memcpy(&entry, recording_.data()+offset_, sizeof(entry));
+  if(entry.type!=type || entry.address!=address) {
+    LOG_ERROR("VME replay diverged at operation " + std::to_string(replayed_) + ": " + VmeTraceRecord::typeName(type) + " at " +
+              int_to_hex(address) + " instead of " + VmeTraceRecord::typeName(entry.type) + " at " + int_to_hex(entry.address));
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  if(payload) *payload = recording_.data()+offset_+sizeof(entry);
+  offset_ += sizeof(entry)+payloadSize(entry);
+  // the original timing is relative to the first operation replayed
+  if(!replayed_) origin_ = std::chrono::steady_clock::now()-std::chrono::nanoseconds(entry.start);
+  ++replayed_;
+  return entry;
+}
+
+CVErrorCodes VmeReplayer::complete(const VmeRecordEntry& entry) const {
+  if(originalTiming_) std::this_thread::sleep_until(origin_+std::chrono::nanoseconds(entry.start+entry.duration));
+  return CVErrorCodes(entry.status);
+}
+
+CVErrorCodes VmeReplayer::writeDataImpl(const long unsigned int address,void*, CVAddressModifier, CVDataWidth) const {
+  return complete(next(VmeTraceRecord::cvWrite, address));
+}
+
+CVErrorCodes VmeReplayer::readDataImpl(const long unsigned int address,void* data, CVAddressModifier, CVDataWidth DW) const {
+  VmeRecordEntry entry = next(VmeTraceRecord::cvRead, address);
+  std::memcpy(data, &entry.data, cycleSize(DW));
+  return complete(entry);
+}
+
+CVErrorCodes VmeReplayer::readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier, CVDataWidth DW) const {
+  VmeRecordEntry entry = next(VmeTraceRecord::cvReadWrite, address);
+  std::memcpy(data, &entry.data, cycleSize(DW));
+  return complete(entry);
+}
+
+CVErrorCodes VmeReplayer::blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier, CVDataWidth, bool) const {
+  const unsigned char* payload = nullptr;
+  VmeRecordEntry entry = next(VmeTraceRecord::cvBlockRead, address, &payload);
+  *count = std::min<int>(size, entry.length);
+  std::memcpy(buffer, payload, *count);
+  return complete(entry);
+}
+
+CVErrorCodes VmeReplayer::blockWriteDataImpl(const long unsigned int address,unsigned char*, int size, int *count, CVAddressModifier, CVDataWidth, bool) const {
+  VmeRecordEntry entry = next(VmeTraceRecord::cvBlockWrite, address);
+  *count = std::min<int>(size, entry.length);
+  return complete(entry);
+}
+
+CVErrorCodes VmeReplayer::ADOCycleImpl(const long unsigned int address, CVAddressModifier) const {
+  return complete(next(VmeTraceRecord::cvADO, address));
+}
+
+CVErrorCodes VmeReplayer::multiReadImpl(VmeCycle* cycles, int n) const {
+  const unsigned char* payload = nullptr;
+  VmeRecordEntry entry = next(VmeTraceRecord::cvMultiRead, cycles[0].address, &payload);
+  const uint32_t* results = reinterpret_cast<const uint32_t*>(payload);
+  for(int i=0;i<n;++i) {
+    cycles[i].data = i<int(entry.length) ? results[2*i] : 0;
+    cycles[i].status = i<int(entry.length) ? CVErrorCodes(results[2*i+1]) : cvGenericError;
+  }
+  if(n!=int(entry.length)) {
+    LOG_ERROR("VME replay diverged at operation " + std::to_string(replayed_) + ": list of " + std::to_string(n) +
+              " cycles instead of " + std::to_string(entry.length));
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  return complete(entry);
+}
+
+CVErrorCodes VmeReplayer::multiWriteImpl(VmeCycle* cycles, int n) const {
+  const unsigned char* payload = nullptr;
+  VmeRecordEntry entry = next(VmeTraceRecord::cvMultiWrite, cycles[0].address, &payload);
+  const uint32_t* results = reinterpret_cast<const uint32_t*>(payload);
+  for(int i=0;i<n;++i) cycles[i].status = i<int(entry.length) ? CVErrorCodes(results[i]) : cvGenericError;
+  if(n!=int(entry.length)) {
+    LOG_ERROR("VME replay diverged at operation " + std::to_string(replayed_) + ": list of " + std::to_string(n) +
+              " cycles instead of " + std::to_string(entry.length));
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  return complete(entry);
+}
+
+void VmeReplayer::IRQEnable(uint32_t mask) const {
+  checkCAENVMEexception(complete(next(VmeTraceRecord::cvIRQEnable, mask)));
+}
+
+void VmeReplayer::IRQDisable(uint32_t mask) const {
+  checkCAENVMEexception(complete(next(VmeTraceRecord::cvIRQDisable, mask)));
+}
+
+void VmeReplayer::IRQWait(uint32_t mask, uint32_t) const {
+  // with the original timing, the interrupt (or the timeout) comes after the recorded delay
+  checkCAENVMEexception(complete(next(VmeTraceRecord::cvIRQWait, mask)));
+}
+
+unsigned char VmeReplayer::IRQCheck() const {
+  VmeRecordEntry entry = next(VmeTraceRecord::cvIRQCheck, 0);
+  checkCAENVMEexception(complete(entry));
+  return entry.data;
+}
+
+uint16_t VmeReplayer::IACK(CVIRQLevels Level) const {
+  useMode(); // the temporary mode, if any, was for this cycle
+  VmeRecordEntry entry = next(VmeTraceRecord::cvIACK, Level);
+  checkCAENVMEexception(complete(entry));
+  return entry.data;
+}
+
+using namespace boost::python;
+
+template<> void exposeToPython<VmeRecorder>() {
+  class_<VmeRecorder, bases<VmeController>, boost::noncopyable>("VmeRecorder",init<const VmeController*, std::string>()[with_custodian_and_ward<1,2>()])
+    .def("close",&VmeRecorder::close)
+    .def("entries",&VmeRecorder::entries)
+  ;
+}
+
+template<> void exposeToPython<VmeReplayer>() {
+  class_<VmeReplayer, bases<VmeController>, boost::noncopyable>("VmeReplayer",init<std::string, optional<bool> >())
+    .add_property("originalTiming",&VmeReplayer::isOriginalTiming,&VmeReplayer::setOriginalTiming)
+    .def("rewind",&VmeReplayer::rewind)
+    .def("replayed",&VmeReplayer::replayed)
+    .def("done",&VmeReplayer::done)
+  ;
+}
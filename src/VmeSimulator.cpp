@@ -0,0 +1,143 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VmeSimulator.h"
+#include "PythonModule.h"
+
+VmeSimulator::VmeSimulator(SimulatedLatency latency, bool populate):VmeController(),crate_(latency) {
+  if(populate) crate_.populate();
+  LOG_INFO("VME simulator Init... ok!");
+}
+
+CVErrorCodes VmeSimulator::writeDataImpl(long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  return crate_.write(address,data,AM,DW);
+}
+
+CVErrorCodes VmeSimulator::readDataImpl(long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  return crate_.read(address,data,AM,DW);
+}
+
+CVErrorCodes VmeSimulator::readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  return crate_.readWrite(address,data,AM,DW);
+}
+
+CVErrorCodes VmeSimulator::blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  return crate_.blockRead(address,buffer,size,AM,multiplex ? cvD64 : DW,count);
+}
+
+CVErrorCodes VmeSimulator::blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  return crate_.blockWrite(address,buffer,size,AM,multiplex ? cvD64 : DW,count);
+}
+
+CVErrorCodes VmeSimulator::ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const {
+  return crate_.addressOnly(address,AM);
+}
+
+CVErrorCodes VmeSimulator::multiReadImpl(VmeCycle* cycles, int n) const {
+  std::vector<uint32_t> addresses(n), data(n);
+  std::vector<CVAddressModifier> AMs(n);
+  std::vector<CVDataWidth> DWs(n);
+  std::vector<CVErrorCodes> ECs(n);
+  for(int i=0;i<n;++i) {
+    addresses[i] = cycles[i].address;
+    AMs[i] = cycles[i].AM;
+    DWs[i] = cycles[i].DW;
+  }
+  CVErrorCodes status = crate_.multiRead(addresses.data(),data.data(),n,AMs.data(),DWs.data(),ECs.data());
+  for(int i=0;i<n;++i) {
+    cycles[i].data = data[i];
+    cycles[i].status = ECs[i];
+  }
+  return status;
+}
+
+CVErrorCodes VmeSimulator::multiWriteImpl(VmeCycle* cycles, int n) const {
+  std::vector<uint32_t> addresses(n), data(n);
+  std::vector<CVAddressModifier> AMs(n);
+  std::vector<CVDataWidth> DWs(n);
+  std::vector<CVErrorCodes> ECs(n);
+  for(int i=0;i<n;++i) {
+    addresses[i] = cycles[i].address;
+    data[i] = cycles[i].data;
+    AMs[i] = cycles[i].AM;
+    DWs[i] = cycles[i].DW;
+  }
+  CVErrorCodes status = crate_.multiWrite(addresses.data(),data.data(),n,AMs.data(),DWs.data(),ECs.data());
+  for(int i=0;i<n;++i) cycles[i].status = ECs[i];
+  return status;
+}
+
+void VmeSimulator::systemReset() {
+  crate_.systemReset();
+}
+
+void VmeSimulator::IRQEnable(uint32_t mask) const {
+  checkCAENVMEexception(crate_.IRQEnable(mask));
+}
+
+void VmeSimulator::IRQDisable(uint32_t mask) const {
+  checkCAENVMEexception(crate_.IRQDisable(mask));
+}
+
+void VmeSimulator::IRQWait(uint32_t mask, uint32_t timeout_ms) const {
+  checkCAENVMEexception(crate_.IRQWait(mask,timeout_ms));
+}
+
+unsigned char VmeSimulator::IRQCheck() const {
+  unsigned char output;
+  checkCAENVMEexception(crate_.IRQCheck(&output));
+  return output;
+}
+
+uint16_t VmeSimulator::IACK(CVIRQLevels level) const {
+  auto [AM, DW] = useMode();
+  uint16_t vector = 0;
+  checkCAENVMEexception(crate_.IACK(level,&vector,DW));
+  return vector;
+}
+
+using namespace boost::python;
+
+template<> void exposeToPython<SimulatedLatency>() {
+  class_<SimulatedLatency>("SimulatedLatency")
+    .def_readwrite("singleCycle",&SimulatedLatency::singleCycle)
+    .def_readwrite("blockSetup",&SimulatedLatency::blockSetup)
+    .def_readwrite("perByte",&SimulatedLatency::perByte)
+    .def_readwrite("irq",&SimulatedLatency::irq)
+    .def("none",&SimulatedLatency::none).staticmethod("none")
+    .def("V1718",&SimulatedLatency::V1718).staticmethod("V1718")
+    .def("V2718",&SimulatedLatency::V2718).staticmethod("V2718")
+  ;
+}
+
+template<> void exposeToPython<SimulatedCrate>() {
+  class_<SimulatedCrate, boost::noncopyable>("SimulatedCrate",no_init)
+    .add_property("latency",&SimulatedCrate::getLatency,&SimulatedCrate::setLatency)
+    .def("systemReset",&SimulatedCrate::systemReset)
+    .def("cycles",&SimulatedCrate::cycles)
+    .def("blockTransfers",&SimulatedCrate::blockTransfers)
+    .def("bytesTransferred",&SimulatedCrate::bytesTransferred)
+  ;
+}
+
+template<> void exposeToPython<VmeSimulator>() {
+  class_<VmeSimulator, bases<VmeController>, boost::noncopyable>("VmeSimulator",init<optional<SimulatedLatency,bool> >())
+    .def("crate",&VmeSimulator::crate,return_internal_reference<>())
+    .def("systemReset",&VmeSimulator::systemReset)
+  ;
+}
@@ -0,0 +1,300 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VmeTracer.h"
+#include "PythonModule.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+  // small index for each thread, used as thread id in the records
+  std::atomic<uint32_t> nthreads(0);
+  thread_local uint32_t threadIndex = nthreads++;
+
+  // number of bytes of a single cycle
+  inline int cycleSize(CVDataWidth DW) { return DW & 0xF; }
+
+  inline int bin(uint32_t duration) { return 31-__builtin_clz(duration|1); }
+
+  // board names as JSON strings: quotes, backslashes and control characters escaped
+  std::string jsonEscape(const std::string& text) {
+    std::string output;
+    for(char c : text) {
+      if(c=='"' || c=='\\') {
+        output += '\\';
+        output += c;
+      } else if((unsigned char)c<0x20) {
+        char escaped[8];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        output += escaped;
+      } else {
+        output += c;
+      }
+    }
+    return output;
+  }
+}
+
+const char* VmeTraceRecord::typeName(uint8_t type) {
+  static const char* names[] = { "read", "write", "readWrite", "blockRead", "blockWrite", "ADO", "multiRead", "multiWrite",
+                                 "IRQEnable", "IRQDisable", "IRQWait", "IRQCheck", "IACK" };
+  return type<sizeof(names)/sizeof(names[0]) ? names[type] : "unknown";
+}
+
+std::string VmeLatencyHistogram::toString() const {
+  std::stringstream ss;
+  ss << board << ": " << count << " operations, mean " << mean()/1000. << " us";
+  if(count) ss << ", min " << min/1000. << " us, max " << max/1000. << " us";
+  for(int i=0;i<nbins;++i) {
+    if(!bins[i]) continue;
+    ss << std::endl << "  [" << (i ? (1u<<i)/1000. : 0.) << ", " << (2u<<i)/1000. << "[ us: " << bins[i];
+  }
+  return ss.str();
+}
+
+VmeTracer::VmeTracer(const VmeController* controller, size_t capacity):VmeController(),controller_(controller),
+  origin_(std::chrono::steady_clock::now()),enabled_(true),head_(0),nboards_(1) {
+  // capacity rounded up to a power of 2, to index the ring with a mask
+  size_t size = 1;
+  while(size<capacity) size <<= 1;
+  mask_ = size-1;
+  ring_.reset(new Slot[size]);
+  boards_.reset(new Board[maxBoards]);
+  boards_[0].name = "other";
+  boards_[0].first = 1;
+  boards_[0].last = 0;
+  clear();
+  setMode(controller_->getAM(), controller_->getDW());
+}
+
+void VmeTracer::registerBoard(const std::string& name, uint32_t baseAddress, uint32_t size) {
+  std::lock_guard<std::mutex> lock(boardsMutex_);
+  uint8_t n = nboards_;
+  if(n==maxBoards) throw_with_trace(CAENVMEexception(cvInvalidParam));
+  boards_[n].name = name;
+  boards_[n].first = baseAddress;
+  boards_[n].last = baseAddress+size-1;
+  // published once filled
+  nboards_.store(n+1, std::memory_order_release);
+}
+
+void VmeTracer::clear() {
+  head_ = 0;
+  for(size_t i=0;i<=mask_;++i) ring_[i].sequence = 0;
+  for(uint8_t i=0;i<maxBoards;++i) {
+    Board& board = boards_[i];
+    board.count = 0;
+    board.total = 0;
+    board.min = UINT32_MAX;
+    board.max = 0;
+    for(auto& b : board.bins) b = 0;
+  }
+}
+
+uint8_t VmeTracer::boardOf(uint32_t address) const {
+  uint8_t n = nboards_.load(std::memory_order_acquire);
+  for(uint8_t i=1;i<n;++i) {
+    if(address>=boards_[i].first && address<=boards_[i].last) return i;
+  }
+  return 0;
+}
+
+void VmeTracer::record(uint8_t type, uint32_t address, int size, CVAddressModifier AM, CVDataWidth DW, CVErrorCodes status,
+                       std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point stop, bool addressed) const {
+  uint64_t begin = std::chrono::duration_cast<std::chrono::nanoseconds>(start-origin_).count();
+  uint32_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop-start).count();
+  uint8_t board = addressed ? boardOf(address) : 0;
+
+  // histogram
+  Board& b = boards_[board];
+  ++b.count;
+  b.total += duration;
+  ++b.bins[bin(duration)];
+  uint32_t current = b.min;
+  while(duration<current && !b.min.compare_exchange_weak(current, duration));
+  current = b.max;
+  while(duration>current && !b.max.compare_exchange_weak(current, duration));
+
+  // ring buffer: the sequence is odd while the slot is written, 2*(index+1) once done
+  uint64_t index = head_++;
+  Slot& slot = ring_[index & mask_];
+  slot.sequence.store(2*index+1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.record = {begin, duration, address, (uint32_t)std::max(size,0), threadIndex, AM, DW, status, type, board};
+  slot.sequence.store(2*index+2, std::memory_order_release);
+}
+
+std::vector<VmeTraceRecord> VmeTracer::records() const {
+  std::vector<VmeTraceRecord> output;
+  uint64_t head = head_;
+  uint64_t first = head>mask_ ? head-mask_-1 : 0;
+  output.reserve(head-first);
+  for(uint64_t index=first; index<head; ++index) {
+    const Slot& slot = ring_[index & mask_];
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if(sequence!=2*index+2) continue; // being written, or already overwritten
+    VmeTraceRecord record = slot.record;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(slot.sequence.load(std::memory_order_relaxed)!=sequence) continue;
+    output.push_back(record);
+  }
+  return output;
+}
+
+void VmeTracer::writeChromeTrace(const std::string& filename) const {
+  std::ofstream out(filename);
+  if(!out) {
+    LOG_ERROR("Cannot open " + filename + " to write the VME trace");
+    throw_with_trace(CAENVMEexception(cvGenericError));
+  }
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"VME bus\"}}";
+  // one track per board
+  uint8_t n = nboards_.load(std::memory_order_acquire);
+  for(uint8_t i=0;i<n;++i) {
+    out << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << int(i)
+        << ",\"args\":{\"name\":\"" << jsonEscape(boards_[i].name) << "\"}}";
+  }
+  out << std::fixed << std::setprecision(3);
+  for(auto& r : records()) {
+    out << "," << std::endl << "{\"name\":\"" << VmeTraceRecord::typeName(r.type) << "\",\"cat\":\"" << jsonEscape(boards_[r.board].name)
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << int(r.board) << ",\"ts\":" << r.start/1000. << ",\"dur\":" << r.duration/1000.
+        << ",\"args\":{\"address\":\"" << int_to_hex(r.address) << "\",\"AM\":\"" << int_to_hex<uint16_t>(r.AM)
+        << "\",\"DW\":" << int(r.DW) << ",\"size\":" << r.size << ",\"thread\":" << r.thread << ",\"status\":" << int(r.status) << "}}";
+  }
+  out << std::endl << "]}" << std::endl;
+}
+
+VmeLatencyHistogram VmeTracer::histogram(uint8_t board) const {
+  const Board& b = boards_[board];
+  VmeLatencyHistogram h { b.name, b.count, b.total, b.count ? b.min.load() : 0, b.max, std::vector<uint64_t>(VmeLatencyHistogram::nbins) };
+  for(int i=0;i<VmeLatencyHistogram::nbins;++i) h.bins[i] = b.bins[i];
+  return h;
+}
+
+VmeLatencyHistogram VmeTracer::histogram(const std::string& board) const {
+  uint8_t n = nboards_.load(std::memory_order_acquire);
+  uint8_t i = 0;
+  while(i<n && boards_[i].name!=board) ++i;
+  if(i==n) throw_with_trace(CAENVMEexception(cvInvalidParam));
+  return histogram(i);
+}
+
+std::vector<VmeLatencyHistogram> VmeTracer::histograms() const {
+  std::vector<VmeLatencyHistogram> output;
+  uint8_t n = nboards_.load(std::memory_order_acquire);
+  for(uint8_t i=0;i<n;++i) {
+    if(boards_[i].count) output.push_back(histogram(i));
+  }
+  return output;
+}
+
+//////////////////////////////////////////
+// Forwarded operations
+//////////////////////////////////////////
+
+CVErrorCodes VmeTracer::writeDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  return trace(VmeTraceRecord::cvWrite, address, cycleSize(DW), AM, DW, true, [&]() { return controller_->writeDataImpl(address,data,AM,DW); });
+}
+
+CVErrorCodes VmeTracer::readDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  return trace(VmeTraceRecord::cvRead, address, cycleSize(DW), AM, DW, true, [&]() { return controller_->readDataImpl(address,data,AM,DW); });
+}
+
+CVErrorCodes VmeTracer::readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  return trace(VmeTraceRecord::cvReadWrite, address, cycleSize(DW), AM, DW, true, [&]() { return controller_->readWriteDataImpl(address,data,AM,DW); });
+}
+
+CVErrorCodes VmeTracer::blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  // the size recorded is the number of bytes actually read
+  return trace(VmeTraceRecord::cvBlockRead, address, *count, AM, DW, true, [&]() {
+    return controller_->blockReadDataImpl(address,buffer,size,count,AM,DW,multiplex);
+  });
+}
+
+CVErrorCodes VmeTracer::blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  return trace(VmeTraceRecord::cvBlockWrite, address, *count, AM, DW, true, [&]() {
+    return controller_->blockWriteDataImpl(address,buffer,size,count,AM,DW,multiplex);
+  });
+}
+
+CVErrorCodes VmeTracer::ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const {
+  return trace(VmeTraceRecord::cvADO, address, 0, AM, cvD32, true, [&]() { return controller_->ADOCycleImpl(address,AM); });
+}
+
+CVErrorCodes VmeTracer::multiReadImpl(VmeCycle* cycles, int n) const {
+  return trace(VmeTraceRecord::cvMultiRead, cycles[0].address, n, cycles[0].AM, cycles[0].DW, true, [&]() { return controller_->multiReadImpl(cycles,n); });
+}
+
+CVErrorCodes VmeTracer::multiWriteImpl(VmeCycle* cycles, int n) const {
+  return trace(VmeTraceRecord::cvMultiWrite, cycles[0].address, n, cycles[0].AM, cycles[0].DW, true, [&]() { return controller_->multiWriteImpl(cycles,n); });
+}
+
+void VmeTracer::IRQEnable(uint32_t mask) const {
+  trace(VmeTraceRecord::cvIRQEnable, mask, 0, getAM(), getDW(), false, [&]() { controller_->IRQEnable(mask); });
+}
+
+void VmeTracer::IRQDisable(uint32_t mask) const {
+  trace(VmeTraceRecord::cvIRQDisable, mask, 0, getAM(), getDW(), false, [&]() { controller_->IRQDisable(mask); });
+}
+
+void VmeTracer::IRQWait(uint32_t mask, uint32_t timeout_ms) const {
+  trace(VmeTraceRecord::cvIRQWait, mask, 0, getAM(), getDW(), false, [&]() { controller_->IRQWait(mask,timeout_ms); });
+}
+
+unsigned char VmeTracer::IRQCheck() const {
+  unsigned char pending = 0;
+  trace(VmeTraceRecord::cvIRQCheck, 0, 1, getAM(), getDW(), false, [&]() { pending = controller_->IRQCheck(); });
+  return pending;
+}
+
+uint16_t VmeTracer::IACK(CVIRQLevels Level) const {
+  // the temporary mode set on the tracer applies to the IACK cycle of the controller
+  CVAddressModifier AM;
+  CVDataWidth DW;
+  std::tie(AM, DW) = useMode();
+  uint16_t vector = 0;
+  trace(VmeTraceRecord::cvIACK, Level, cycleSize(DW), AM, DW, false, [&]() { vector = controller_->mode(AM, DW)->IACK(Level); });
+  return vector;
+}
+
+using namespace boost::python;
+
+template<> void exposeToPython<VmeTracer>() {
+  class_<VmeLatencyHistogram>("VmeLatencyHistogram")
+    .def_readonly("board",&VmeLatencyHistogram::board)
+    .def_readonly("count",&VmeLatencyHistogram::count)
+    .def_readonly("total",&VmeLatencyHistogram::total)
+    .def_readonly("min",&VmeLatencyHistogram::min)
+    .def_readonly("max",&VmeLatencyHistogram::max)
+    .add_property("mean",&VmeLatencyHistogram::mean)
+    .def("toString",&VmeLatencyHistogram::toString)
+    .def("__str__",&VmeLatencyHistogram::toString)
+  ;
+
+  VmeLatencyHistogram (VmeTracer::*histogram)(const std::string&) const = &VmeTracer::histogram;
+  class_<VmeTracer, bases<VmeController>, boost::noncopyable>("VmeTracer",init<const VmeController*, optional<size_t> >()[with_custodian_and_ward<1,2>()])
+    .def("registerBoard",&VmeTracer::registerBoard)
+    .add_property("enabled",&VmeTracer::isEnabled,&VmeTracer::enable)
+    .def("clear",&VmeTracer::clear)
+    .def("recorded",&VmeTracer::recorded)
+    .def("writeChromeTrace",&VmeTracer::writeChromeTrace)
+    .def("histogram",histogram)
+  ;
+}
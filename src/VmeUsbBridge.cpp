@@ -19,22 +19,39 @@
 #include "VmeUsbBridge.h"
 #include "PythonModule.h"
 #include <iostream>
+#include <map>
+
+namespace {
+  // one mutex per CAEN handle, shared by all the objects using it (bridge copies, pulsers, scaler)
+  std::mutex* handleMutex(int32_t handle) {
+    static std::mutex registryMutex;
+    static std::map<int32_t,std::mutex> mutexes;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return &mutexes[handle];
+  }
+}
 
-VmeUsbBridge::VmeUsbBridge():VmeController() {
-  this->board_ = cvV1718;
+VmeUsbBridge::VmeUsbBridge(CVBoardTypes board, short link, short boardNumber):VmeController(),
+  board_(board),link_(link),boardNumber_(boardNumber),maxBlockSize_(board==cvV1718 ? 0x10000 : 0x100000),
+  pulserA_(nullptr),pulserB_(nullptr),scaler_(nullptr) {
   char FWRel[128];
   
   LOG_DEBUG("calling CAENVME INIT");
-  checkCAENVMEexception(CAENVME_Init((CVBoardTypes)(int)board_, 0, 0, &this->BHandle_));
-  this->pulserA_ = new V1718Pulser(this->BHandle_,cvPulserA);
-  this->pulserB_ = new V1718Pulser(this->BHandle_,cvPulserB);
-  this->scaler_  = new V1718Scaler(this->BHandle_);
+  checkCAENVMEexception(CAENVME_Init(board_, link_, boardNumber_, &this->BHandle_));
+  this->handleMutex_ = handleMutex(this->BHandle_);
+  // pulsers and scaler are on the VME bridges only (not on the PCI boards)
+  if(board_==cvV1718 || board_==cvV2718) {
+    this->pulserA_ = new V1718Pulser(this->BHandle_,cvPulserA);
+    this->pulserB_ = new V1718Pulser(this->BHandle_,cvPulserB);
+    this->scaler_  = new V1718Scaler(this->BHandle_);
+  }
 
   LOG_DEBUG("Reading CAENVME BOARD RELEASE");
   checkCAENVMEexception(CAENVME_BoardFWRelease(this->BHandle_,FWRel));
   this->firmwareVersion_ = std::string(FWRel);
   
-  LOG_INFO("VME USB Init... ok!");
+  LOG_INFO("VME bridge Init... ok! (type " + std::to_string(board_) + ", link " + std::to_string(link_) + 
+           ", board " + std::to_string(boardNumber_) + ")");
   LOG_INFO("Firmware version: " + this->firmwareVersion_ )
 }
 
@@ -47,66 +64,134 @@ VmeUsbBridge::~VmeUsbBridge(){
   delete this->scaler_;
   LOG_TRACE("calling CAENVME_End");
   CAENVME_End(this->BHandle_);
-  LOG_INFO("Disconnected from USB controler.");
+  LOG_INFO("Disconnected from VME bridge (link " + std::to_string(link_) + ", board " + std::to_string(boardNumber_) + ").");
 }
 
-VmeUsbBridge::VmeUsbBridge(const VmeUsbBridge& other):VmeController(other),firmwareVersion_(other.firmwareVersion_),BHandle_(other.BHandle_) {
-  board_ = cvV1718;
-  pulserA_ = new V1718Pulser(*other.pulserA_);
-  pulserB_ = new V1718Pulser(*other.pulserB_);
-  scaler_  = new V1718Scaler(*other.scaler_);
+VmeUsbBridge::VmeUsbBridge(const VmeUsbBridge& other):VmeController(other),firmwareVersion_(other.firmwareVersion_),BHandle_(other.BHandle_),
+  board_(other.board_),link_(other.link_),boardNumber_(other.boardNumber_),handleMutex_(other.handleMutex_),maxBlockSize_(other.maxBlockSize_) {
+  pulserA_ = other.pulserA_ ? new V1718Pulser(*other.pulserA_) : nullptr;
+  pulserB_ = other.pulserB_ ? new V1718Pulser(*other.pulserB_) : nullptr;
+  scaler_  = other.scaler_ ? new V1718Scaler(*other.scaler_) : nullptr;
 }
 
 VmeUsbBridge& VmeUsbBridge::operator=(const VmeUsbBridge& other){
-  board_ = cvV1718;
+  if(this==&other) return *this;
+  board_ = other.board_;
+  link_ = other.link_;
+  boardNumber_ = other.boardNumber_;
   firmwareVersion_ = other.firmwareVersion_;
   BHandle_ = other.BHandle_;
-  pulserA_->operator=(*other.pulserA_);
-  pulserB_->operator=(*other.pulserB_);
-  scaler_->operator=(*other.scaler_);
+  handleMutex_ = other.handleMutex_;
+  maxBlockSize_ = other.maxBlockSize_;
+  delete pulserA_;
+  delete pulserB_;
+  delete scaler_;
+  pulserA_ = other.pulserA_ ? new V1718Pulser(*other.pulserA_) : nullptr;
+  pulserB_ = other.pulserB_ ? new V1718Pulser(*other.pulserB_) : nullptr;
+  scaler_  = other.scaler_ ? new V1718Scaler(*other.scaler_) : nullptr;
   VmeController::operator=(other);
   return *this;
 }
 
-void VmeUsbBridge::writeDataImpl(long unsigned int address,void* data) const{
-  auto [AM, DW] = useMode();
-  checkCAENVMEexception(CAENVME_WriteCycle(this->BHandle_,address,data,AM,DW));
+CVErrorCodes VmeUsbBridge::writeDataImpl(long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
+  return CAENVME_WriteCycle(this->BHandle_,address,data,AM,DW);
 }
 
-void VmeUsbBridge::readDataImpl(long unsigned int address,void* data) const {
-  auto [AM, DW] = useMode();
-  checkCAENVMEexception(CAENVME_ReadCycle(this->BHandle_,address,data,AM,DW));
+CVErrorCodes VmeUsbBridge::readDataImpl(long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
+  return CAENVME_ReadCycle(this->BHandle_,address,data,AM,DW);
 }
 
-void VmeUsbBridge::readWriteDataImpl(const long unsigned int address,void* data) const {
-  auto [AM, DW] = useMode();
-  checkCAENVMEexception(CAENVME_RMWCycle(this->BHandle_,address,data,AM,DW));
+CVErrorCodes VmeUsbBridge::readWriteDataImpl(const long unsigned int address,void* data, CVAddressModifier AM, CVDataWidth DW) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
+  return CAENVME_RMWCycle(this->BHandle_,address,data,AM,DW);
 }
 
-void VmeUsbBridge::blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, bool multiplex) const {
-  auto [AM, DW] = useMode();
-  if (multiplex) {
-    checkCAENVMEexception(CAENVME_MBLTReadCycle(this->BHandle_, address, buffer, size, AM, count));
-  } else {
-    checkCAENVMEexception(CAENVME_BLTReadCycle(this->BHandle_, address, buffer, size, AM, DW, count));
-  }
+CVErrorCodes VmeUsbBridge::blockReadDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  return blockTransfer(true, address, buffer, size, count, AM, DW, multiplex);
 }
 
-void VmeUsbBridge::blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, bool multiplex) const {
-  auto [AM, DW] = useMode();
-  if (multiplex) {
-    checkCAENVMEexception(CAENVME_MBLTWriteCycle(this->BHandle_, address, buffer, size, AM, count));
-  } else {
-    checkCAENVMEexception(CAENVME_BLTWriteCycle(this->BHandle_, address, buffer, size, AM, DW, count));
+CVErrorCodes VmeUsbBridge::blockWriteDataImpl(const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  return blockTransfer(false, address, buffer, size, count, AM, DW, multiplex);
+}
+
+CVErrorCodes VmeUsbBridge::blockTransfer(bool read, const long unsigned int address,unsigned char *buffer, int size, int *count, CVAddressModifier AM, CVDataWidth DW, bool multiplex) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
+  short fifo = 0;
+  *count = 0;
+  if(size>maxBlockSize_) {
+    CVErrorCodes status = CAENVME_GetFIFOMode(this->BHandle_, &fifo);
+    if(status) return status;
+  }
+  // one chunk after the other, until the end or a short transfer (end of data)
+  for(int offset=0; offset<size;) {
+    int length = std::min(maxBlockSize_, size-offset);
+    uint32_t chunkAddress = address + (fifo ? 0 : offset);
+    int n = 0;
+    CVErrorCodes status;
+    if (multiplex) {
+      status = read ? CAENVME_MBLTReadCycle(this->BHandle_, chunkAddress, buffer+offset, length, AM, &n) :
+                      CAENVME_MBLTWriteCycle(this->BHandle_, chunkAddress, buffer+offset, length, AM, &n);
+    } else {
+      status = read ? CAENVME_BLTReadCycle(this->BHandle_, chunkAddress, buffer+offset, length, AM, DW, &n) :
+                      CAENVME_BLTWriteCycle(this->BHandle_, chunkAddress, buffer+offset, length, AM, DW, &n);
+    }
+    *count += n;
+    offset += n;
+    if(status) return status;
+    if(n<length) break;
   }
+  return cvSuccess;
 }
 
-void VmeUsbBridge::ADOCycleImpl(const long unsigned int address) const {
-  auto [AM, DW] = useMode();
-  checkCAENVMEexception(CAENVME_ADOCycle(this->BHandle_, address, AM));
+CVErrorCodes VmeUsbBridge::ADOCycleImpl(const long unsigned int address, CVAddressModifier AM) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
+  return CAENVME_ADOCycle(this->BHandle_, address, AM);
+}
+
+CVErrorCodes VmeUsbBridge::multiReadImpl(VmeCycle* cycles, int n) const {
+  std::vector<uint32_t> addresses(n), data(n);
+  std::vector<CVAddressModifier> AMs(n);
+  std::vector<CVDataWidth> DWs(n);
+  std::vector<CVErrorCodes> ECs(n);
+  for(int i=0;i<n;++i) {
+    addresses[i] = cycles[i].address;
+    AMs[i] = cycles[i].AM;
+    DWs[i] = cycles[i].DW;
+  }
+  std::lock_guard<std::mutex> lock(*handleMutex_);
+  CVErrorCodes status = CAENVME_MultiRead(this->BHandle_, addresses.data(), data.data(), n, AMs.data(), DWs.data(), ECs.data());
+  for(int i=0;i<n;++i) {
+    cycles[i].data = data[i];
+    cycles[i].status = ECs[i];
+    if(!status) status = ECs[i];
+  }
+  return status;
+}
+
+CVErrorCodes VmeUsbBridge::multiWriteImpl(VmeCycle* cycles, int n) const {
+  std::vector<uint32_t> addresses(n), data(n);
+  std::vector<CVAddressModifier> AMs(n);
+  std::vector<CVDataWidth> DWs(n);
+  std::vector<CVErrorCodes> ECs(n);
+  for(int i=0;i<n;++i) {
+    addresses[i] = cycles[i].address;
+    data[i] = cycles[i].data;
+    AMs[i] = cycles[i].AM;
+    DWs[i] = cycles[i].DW;
+  }
+  std::lock_guard<std::mutex> lock(*handleMutex_);
+  CVErrorCodes status = CAENVME_MultiWrite(this->BHandle_, addresses.data(), data.data(), n, AMs.data(), DWs.data(), ECs.data());
+  for(int i=0;i<n;++i) {
+    cycles[i].status = ECs[i];
+    if(!status) status = ECs[i];
+  }
+  return status;
 }
 
 V1718Pulser& VmeUsbBridge::getPulser(CVPulserSelect pulser){
+  if(!this->pulserA_) throw_with_trace(CAENVMEexception(cvInvalidParam));
   if(pulser==cvPulserA) 
     return *this->pulserA_;
   else 
@@ -114,14 +199,17 @@ V1718Pulser& VmeUsbBridge::getPulser(CVPulserSelect pulser){
 }
 
 V1718Scaler& VmeUsbBridge::getScaler(){
+  if(!this->scaler_) throw_with_trace(CAENVMEexception(cvInvalidParam));
   return *this->scaler_;
 }
 
 void VmeUsbBridge::configureOutputLine(CVOutputSelect line, CVIOPolarity polarity, CVLEDPolarity LEDpolarity, CVIOSources source) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetOutputConf(this->BHandle_, line, polarity, LEDpolarity, source));
 }
 
 void VmeUsbBridge::configureInputLine(CVInputSelect line, CVIOPolarity polarity, CVLEDPolarity LEDpolarity) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetInputConf(this->BHandle_, line, polarity, LEDpolarity));
 }
 
@@ -129,6 +217,7 @@ std::tuple<CVIOPolarity, CVLEDPolarity, CVIOSources> VmeUsbBridge::outputLineCon
   CVIOPolarity OutPol;
   CVLEDPolarity LEDPol; 
   CVIOSources Source;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetOutputConf(this->BHandle_, line,&OutPol,&LEDPol, &Source));
   return std::make_tuple(OutPol,LEDPol,Source);
 }
@@ -136,95 +225,114 @@ std::tuple<CVIOPolarity, CVLEDPolarity, CVIOSources> VmeUsbBridge::outputLineCon
 std::tuple<CVIOPolarity, CVLEDPolarity> VmeUsbBridge::inputLineConfiguration(CVInputSelect line) const {
   CVIOPolarity InPol;
   CVLEDPolarity LEDPol;  
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetInputConf(this->BHandle_, line, &InPol, &LEDPol));
   return std::tuple(InPol,LEDPol);
 }
 
 uint32_t VmeUsbBridge::readRegister(CVRegisters reg) const {
   uint32_t data;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_ReadRegister(this->BHandle_, reg, &data));
   return data;
 }
 
 void VmeUsbBridge::setOutputRegister(unsigned short mask) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetOutputRegister(this->BHandle_, mask));
 }
 
 void VmeUsbBridge::clearOutputRegister(unsigned short mask) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_ClearOutputRegister(this->BHandle_, mask));
 }
 
 void VmeUsbBridge::pulseOutputRegister(unsigned short mask) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_PulseOutputRegister(this->BHandle_, mask));
 }
 
 CVDisplay VmeUsbBridge::readDisplay() const {
   CVDisplay value;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_ReadDisplay(this->BHandle_, &value));
   return value;
 }
 
 void VmeUsbBridge::setArbiterType(CVArbiterTypes type) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetArbiterType(this->BHandle_, type));
 }
 
 void VmeUsbBridge::setRequesterType(CVRequesterTypes type) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetRequesterType(this->BHandle_, type));
 }
 
 void VmeUsbBridge::setReleaseType(CVReleaseTypes type) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetReleaseType(this->BHandle_, type));
 }
 
 void VmeUsbBridge::setBusReqLevel(CVBusReqLevels level) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetBusReqLevel(this->BHandle_,level));
 }
 
 void VmeUsbBridge::setTimeout(CVVMETimeouts timeout) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetTimeout(this->BHandle_,timeout));
 }
 
 void VmeUsbBridge::setFIFOMode(bool mode) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetFIFOMode(this->BHandle_,(short)mode));
 }
 
 CVArbiterTypes VmeUsbBridge::getArbiterType() const {
   CVArbiterTypes value;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetArbiterType(this->BHandle_, &value));
   return value;
 }
 
 CVRequesterTypes VmeUsbBridge::getRequesterType() const {
   CVRequesterTypes value;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetRequesterType(this->BHandle_, &value));
   return value;
 }
 
 CVReleaseTypes VmeUsbBridge::getReleaseType() const {
   CVReleaseTypes value;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetReleaseType(this->BHandle_, &value));
   return value;
 }
 
 CVBusReqLevels VmeUsbBridge::getBusReqLevel() const {
   CVBusReqLevels value;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetBusReqLevel(this->BHandle_, &value));
   return value;
 }
 
 CVVMETimeouts VmeUsbBridge::getTimeout() const {
   CVVMETimeouts value;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetTimeout(this->BHandle_, &value));
   return value;
 }
 
 bool VmeUsbBridge::getFIFOMode() const {
   short value;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetFIFOMode(this->BHandle_, &value));
   return value;
 }
 
 void VmeUsbBridge::systemReset() const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SystemReset(this->BHandle_));
   /* note: we don't update the pulsers and scaler so a simple configure() on the restores the previous settings
   pulserA_.update();
@@ -234,19 +342,23 @@ void VmeUsbBridge::systemReset() const {
 }
 
 void VmeUsbBridge::IRQEnable(uint32_t mask) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_IRQEnable(this->BHandle_,mask));
 }
 
 void VmeUsbBridge::IRQDisable(uint32_t mask) const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_IRQDisable(this->BHandle_,mask));
 }
 
 void VmeUsbBridge::IRQWait(uint32_t mask, uint32_t timeout_ms) const {
+  // not serialized: other threads can use the bridge while waiting for the interrupt
   checkCAENVMEexception(CAENVME_IRQWait(this->BHandle_,mask,timeout_ms));
 }
 
 unsigned char VmeUsbBridge::IRQCheck() const {
   unsigned char output;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_IRQCheck(this->BHandle_, &output));
   return output;
 }
@@ -254,15 +366,17 @@ unsigned char VmeUsbBridge::IRQCheck() const {
 uint16_t VmeUsbBridge::IACK(CVIRQLevels level) const {
   auto [AM, DW] = useMode();
   uint16_t vector;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_IACKCycle(this->BHandle_, level, &vector, DW));
   return vector;
 }
 
-V1718Pulser::V1718Pulser(uint32_t handle, CVPulserSelect id):BHandle_(handle),pulserId_(id) {
+V1718Pulser::V1718Pulser(uint32_t handle, CVPulserSelect id):BHandle_(handle),handleMutex_(handleMutex(handle)),pulserId_(id) {
   this->update();
 }
 
 void V1718Pulser::configure() const {
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetPulserConf(this->BHandle_, this->pulserId_,
                                               this->period_,this->width_,
                                               this->units_,this->pulseNo_,
@@ -273,16 +387,19 @@ void V1718Pulser::configure() const {
 void V1718Pulser::start() const {
   if (!this->configured_ ) configure();
   if (this->start_ != cvManualSW) throw CAENVMEexception(cvInvalidParam);
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_StartPulser(this->BHandle_, this->pulserId_));
 }
 
 void V1718Pulser::stop() const {
   if (!this->configured_ ) configure();
   if (this->reset_ != cvManualSW) throw CAENVMEexception(cvInvalidParam);
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_StopPulser(this->BHandle_, this->pulserId_));
 }
 
 void V1718Pulser::update(){
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetPulserConf(this->BHandle_, this->pulserId_, 
                                               &(this->period_),&(this->width_),
                                               &(this->units_), &(this->pulseNo_),
@@ -290,11 +407,12 @@ void V1718Pulser::update(){
   this->configured_ = true;
 }
 
-V1718Scaler::V1718Scaler(uint32_t handle):BHandle_(handle) {
+V1718Scaler::V1718Scaler(uint32_t handle):BHandle_(handle),handleMutex_(handleMutex(handle)) {
   this->update();
 }
 
 void V1718Scaler::configure(){
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_SetScalerConf(this->BHandle_, 
                                               this->limit_,this->autoReset_,
                                               this->hit_,this->gate_,
@@ -303,6 +421,7 @@ void V1718Scaler::configure(){
 }
 
 void V1718Scaler::update(){
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_GetScalerConf(this->BHandle_,
                                               &(this->limit_),&(this->autoReset_),
                                               &(this->hit_),&(this->gate_),
@@ -313,23 +432,27 @@ void V1718Scaler::update(){
 void V1718Scaler::resetCount(){
   if (!this->configured_ ) configure();
   if (this->reset_ != cvManualSW) throw CAENVMEexception(cvInvalidParam);
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_ResetScalerCount(this->BHandle_));
 }
 
 void V1718Scaler::enableGate(){
   if (!this->configured_ ) configure();
   if (this->gate_ != cvManualSW) throw CAENVMEexception(cvInvalidParam);
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_EnableScalerGate(this->BHandle_));
 }
 
 void V1718Scaler::disableGate(){
   if (!this->configured_ ) configure();
   if (this->gate_ != cvManualSW) throw CAENVMEexception(cvInvalidParam);
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_DisableScalerGate(this->BHandle_));
 }
 
 unsigned short V1718Scaler::count() const {
   unsigned int data = 0;
+  std::lock_guard<std::mutex> lock(*handleMutex_);
   checkCAENVMEexception(CAENVME_ReadRegister(this->BHandle_, cvScaler1, &data));
   return (data & 1023);
 }
@@ -337,7 +460,11 @@ unsigned short V1718Scaler::count() const {
 using namespace boost::python;
 
 template<> void exposeToPython<VmeUsbBridge>() {
-  class_<VmeUsbBridge, bases<VmeController> >("VmeUsbBridge")
+  class_<VmeUsbBridge, bases<VmeController> >("VmeUsbBridge",init<optional<CVBoardTypes,short,short> >())
+    .add_property("boardType",&VmeUsbBridge::boardType)
+    .add_property("link",&VmeUsbBridge::link)
+    .add_property("boardNumber",&VmeUsbBridge::boardNumber)
+    .add_property("firmwareVersion",&VmeUsbBridge::firmwareVersion)
     .def("configureOutputLine",&VmeUsbBridge::configureOutputLine)
     .def("configureInputLine",&VmeUsbBridge::configureInputLine)
     .def("outputLineConfiguration",&VmeUsbBridge::outputLineConfiguration)
@@ -353,6 +480,7 @@ template<> void exposeToPython<VmeUsbBridge>() {
     .add_property("busReqLevel",&VmeUsbBridge::getBusReqLevel,&VmeUsbBridge::setBusReqLevel)
     .add_property("timeout",&VmeUsbBridge::getTimeout,&VmeUsbBridge::setTimeout)
     .add_property("FIFOmode",&VmeUsbBridge::getFIFOMode,&VmeUsbBridge::setFIFOMode)
+    .add_property("maxBlockSize",&VmeUsbBridge::getMaxBlockSize,&VmeUsbBridge::setMaxBlockSize)
     .def("systemReset",&VmeUsbBridge::systemReset)
     .def("getPulser",&VmeUsbBridge::getPulser,return_value_policy<copy_non_const_reference>())
     .def("getScaler",&VmeUsbBridge::getScaler,return_value_policy<copy_non_const_reference>())
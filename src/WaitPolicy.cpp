@@ -0,0 +1,106 @@
+/*
+ *  VeheMencE: a simple library for VME access
+ *  Copyright (C) 2019 Universite catholique de Louvain (UCLouvain), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "WaitPolicy.h"
+#include "VmeController.h"
+#include "PythonModule.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+WaitPolicy::WaitPolicy(uint32_t timeout_ms):timeout_ms_(timeout_ms),statistics_({0,0,0,0.,0.}) {}
+
+void WaitPolicy::wait(const std::function<bool()>& ready) {
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + std::chrono::milliseconds(timeout_ms_);
+  unsigned int polls = 0;
+  bool timeout = false;
+  while(true) {
+    ++polls;
+    if(ready()) break;
+    if(timeout_ms_ && std::chrono::steady_clock::now()>=deadline) {
+      timeout = true;
+      break;
+    }
+    pause(polls);
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++statistics_.waits;
+    statistics_.polls += polls;
+    statistics_.timeouts += timeout;
+    statistics_.totalTime += elapsed;
+    statistics_.maxTime = std::max(statistics_.maxTime, elapsed);
+  }
+  if(timeout) throw_with_trace(CAENVMEexception(cvTimeoutError));
+}
+
+WaitStatistics WaitPolicy::statistics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+void WaitPolicy::resetStatistics() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  statistics_ = {0,0,0,0.,0.};
+}
+
+BackoffWait::BackoffWait(uint32_t initial_us, uint32_t max_us, double factor, uint32_t timeout_ms):
+  WaitPolicy(timeout_ms),initial_us_(initial_us),max_us_(max_us),factor_(factor) {}
+
+void BackoffWait::pause(unsigned int attempt) {
+  double delay = initial_us_*std::pow(factor_, attempt-1);
+  std::this_thread::sleep_for(std::chrono::microseconds(uint32_t(std::min(delay, double(max_us_)))));
+}
+
+IRQAssistedWait::IRQAssistedWait(const VmeController* controller, uint32_t mask, uint32_t slice_ms, uint32_t timeout_ms):
+  WaitPolicy(timeout_ms),controller_(controller),mask_(mask),slice_ms_(slice_ms) {}
+
+void IRQAssistedWait::pause(unsigned int) {
+  try {
+    controller_->IRQWait(mask_, slice_ms_);
+  } catch(CAENVMEexception& e) {
+    // no interrupt in this slice: check again
+  }
+}
+
+using namespace boost::python;
+
+template<> void exposeToPython<WaitPolicy>() {
+  class_<WaitStatistics>("WaitStatistics")
+    .def_readonly("waits",&WaitStatistics::waits)
+    .def_readonly("polls",&WaitStatistics::polls)
+    .def_readonly("timeouts",&WaitStatistics::timeouts)
+    .def_readonly("totalTime",&WaitStatistics::totalTime)
+    .def_readonly("maxTime",&WaitStatistics::maxTime)
+    .add_property("meanPolls",&WaitStatistics::meanPolls)
+    .add_property("meanTime",&WaitStatistics::meanTime)
+  ;
+
+  class_<WaitPolicy, std::shared_ptr<WaitPolicy>, boost::noncopyable>("WaitPolicy",no_init)
+    .add_property("timeout",&WaitPolicy::getTimeout,&WaitPolicy::setTimeout)
+    .def("statistics",&WaitPolicy::statistics)
+    .def("resetStatistics",&WaitPolicy::resetStatistics)
+  ;
+
+  class_<BusyWait, bases<WaitPolicy>, std::shared_ptr<BusyWait>, boost::noncopyable>("BusyWait",init<optional<uint32_t> >());
+  class_<BackoffWait, bases<WaitPolicy>, std::shared_ptr<BackoffWait>, boost::noncopyable>("BackoffWait",init<optional<uint32_t,uint32_t,double,uint32_t> >());
+  class_<IRQAssistedWait, bases<WaitPolicy>, std::shared_ptr<IRQAssistedWait>, boost::noncopyable>("IRQAssistedWait",init<const VmeController*,uint32_t,optional<uint32_t,uint32_t> >());
+}